@@ -0,0 +1,125 @@
+#include "conversion_pool.hpp"
+#include "frame_conversion.hpp"
+#include <benchmark/benchmark.h>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <string>
+#include <thread>
+
+namespace {
+
+struct PixelFormatCase {
+  const char *name;
+  int cvType;
+  int colorCvt;
+};
+
+// The raw layouts CameraInstance::convertToMat hands to convertFrame, one
+// per supported Pylon PixelType.
+const PixelFormatCase kPixelFormats[] = {
+    {"Mono8", CV_8UC1, -1},
+    {"BGR8packed", CV_8UC3, -1},
+    {"RGB8packed", CV_8UC3, cv::COLOR_RGB2BGR},
+    {"YUV422_YUYV_Packed", CV_8UC2, cv::COLOR_YUV2BGR_YUYV},
+    {"YCbCr422_8_YY_CbCr", CV_8UC2, cv::COLOR_YUV2BGR_UYVY},
+    {"BayerRG8", CV_8UC1, cv::COLOR_BayerBG2BGR},
+    {"BayerBG8", CV_8UC1, cv::COLOR_BayerRG2BGR},
+    {"BayerGR8", CV_8UC1, cv::COLOR_BayerGB2BGR},
+    {"BayerGB8", CV_8UC1, cv::COLOR_BayerGR2BGR},
+};
+constexpr int kPixelFormatCount =
+    static_cast<int>(sizeof(kPixelFormats) / sizeof(kPixelFormats[0]));
+
+// Common Basler sensor resolutions, VGA up to 5 MP.
+const cv::Size kSensorSizes[] = {
+    {640, 480}, {1280, 1024}, {1920, 1200}, {2448, 2048}};
+constexpr int kSensorSizeCount =
+    static_cast<int>(sizeof(kSensorSizes) / sizeof(kSensorSizes[0]));
+
+// Pool size the library starts with on this machine.
+int defaultWorkers() {
+  int hw = static_cast<int>(std::thread::hardware_concurrency());
+  return std::clamp(hw - 1, 0, 4);
+}
+
+void setPoolWorkers(int workers) {
+  ConversionPool::instance().configure(workers, {}, 64);
+}
+
+void applyArgs(benchmark::internal::Benchmark *bench) {
+  bench->ArgNames({"format", "size", "workers"});
+  for (int format = 0; format < kPixelFormatCount; format++) {
+    for (int size = 0; size < kSensorSizeCount; size++) {
+      bench->Args({format, size, 0});
+      if (defaultWorkers() > 0) {
+        bench->Args({format, size, defaultWorkers()});
+      }
+    }
+  }
+}
+
+void labelRun(benchmark::State &state, const PixelFormatCase &format,
+              cv::Size size, size_t rawBytes) {
+  state.SetLabel(std::string(format.name) + " " + std::to_string(size.width) +
+                 "x" + std::to_string(size.height));
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(rawBytes));
+  state.counters["fps"] = benchmark::Counter(
+      static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+}
+
+// Everything convertToMat does per frame once the grab buffer is wrapped:
+// allocate the owned frame and convert into it across the pool.
+void BM_ConvertFrame(benchmark::State &state) {
+  const PixelFormatCase &format = kPixelFormats[state.range(0)];
+  cv::Size size = kSensorSizes[state.range(1)];
+  setPoolWorkers(static_cast<int>(state.range(2)));
+
+  cv::Mat raw(size, format.cvType);
+  cv::randu(raw, 0, 256);
+  int outType = convertedType(format.cvType, format.colorCvt);
+  ConversionStages stages;
+  cv::Mat scratch;
+
+  for (auto _ : state) {
+    auto converted = std::make_shared<cv::Mat>(size, outType);
+    convertFrame(raw, format.colorCvt, *converted, nullptr, stages, scratch);
+    benchmark::DoNotOptimize(converted->data);
+  }
+  labelRun(state, format, size, raw.total() * raw.elemSize());
+}
+BENCHMARK(BM_ConvertFrame)->Apply(applyArgs)->Unit(benchmark::kMicrosecond);
+
+// Same, with the fused HSV threshold producing a half-resolution mask.
+void BM_ConvertFrameWithThreshold(benchmark::State &state) {
+  const PixelFormatCase &format = kPixelFormats[state.range(0)];
+  cv::Size size = kSensorSizes[state.range(1)];
+  setPoolWorkers(static_cast<int>(state.range(2)));
+
+  cv::Mat raw(size, format.cvType);
+  cv::randu(raw, 0, 256);
+  int outType = convertedType(format.cvType, format.colorCvt);
+  ThresholdConfig config;
+  config.hueLow = 20;
+  config.hueHigh = 90;
+  config.downsample = 2;
+  ThresholdStage threshold(config);
+  ConversionStages stages;
+  stages.threshold = &threshold;
+  cv::Mat scratch;
+
+  for (auto _ : state) {
+    auto converted = std::make_shared<cv::Mat>(size, outType);
+    auto mask =
+        std::make_shared<cv::Mat>(threshold.maskSize(size), CV_8UC1);
+    convertFrame(raw, format.colorCvt, *converted, mask.get(), stages,
+                 scratch);
+    benchmark::DoNotOptimize(mask->data);
+  }
+  labelRun(state, format, size, raw.total() * raw.elemSize());
+}
+BENCHMARK(BM_ConvertFrameWithThreshold)
+    ->Apply(applyArgs)
+    ->Unit(benchmark::kMicrosecond);
+
+} // namespace
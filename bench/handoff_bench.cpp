@@ -0,0 +1,114 @@
+#include "frame_mailbox.hpp"
+#include "handle_registry.hpp"
+#include <benchmark/benchmark.h>
+#include <opencv2/core.hpp>
+#include <memory>
+#include <vector>
+
+namespace {
+
+const cv::Size kSensorSizes[] = {
+    {640, 480}, {1280, 1024}, {1920, 1200}, {2448, 2048}};
+
+FrameMetadata metadataFor(uint64_t sequence) {
+  FrameMetadata metadata;
+  metadata.sequence = sequence;
+  return metadata;
+}
+
+// Java_..._takeFrame: read the newest frame from the mailbox and clone it
+// into a heap Mat that Java takes ownership of.
+void BM_TakeFrameClone(benchmark::State &state) {
+  cv::Size size = kSensorSizes[state.range(0)];
+  int type = state.range(1) == 1 ? CV_8UC1 : CV_8UC3;
+  FrameMailbox mailbox;
+  auto frame = std::make_shared<cv::Mat>(size, type);
+  cv::randu(*frame, 0, 256);
+  mailbox.publish({frame, nullptr, metadataFor(1)});
+
+  for (auto _ : state) {
+    auto published = mailbox.frame();
+    auto *javaMat = new cv::Mat(published->clone());
+    benchmark::DoNotOptimize(javaMat->data);
+    delete javaMat;
+  }
+  size_t bytes = frame->total() * frame->elemSize();
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(bytes));
+}
+BENCHMARK(BM_TakeFrameClone)
+    ->ArgNames({"size", "channels"})
+    ->ArgsProduct({{0, 1, 2, 3}, {1, 3}})
+    ->Unit(benchmark::kMicrosecond);
+
+// getCameraInstance: every JNI call looks its camera up by handle, from as
+// many threads as the application has pipelines.
+constexpr int kRegisteredCameras = 4;
+
+HandleRegistry<int> &benchRegistry(std::vector<int64_t> &handles) {
+  static HandleRegistry<int> registry;
+  static std::vector<int64_t> registered = [] {
+    std::vector<int64_t> added;
+    for (int i = 0; i < kRegisteredCameras; i++) {
+      added.push_back(registry.add(std::make_shared<int>(i)));
+    }
+    return added;
+  }();
+  handles = registered;
+  return registry;
+}
+
+void BM_HandleLookup(benchmark::State &state) {
+  std::vector<int64_t> handles;
+  HandleRegistry<int> &registry = benchRegistry(handles);
+  size_t next = static_cast<size_t>(state.thread_index());
+
+  for (auto _ : state) {
+    auto instance = registry.find(handles[next++ % handles.size()]);
+    benchmark::DoNotOptimize(instance.get());
+  }
+}
+BENCHMARK(BM_HandleLookup)->ThreadRange(1, 16)->UseRealTime();
+
+// Frame mailbox hand-off: thread 0 plays the grab thread publishing frames,
+// every other thread a pipeline polling for the newest one.
+void BM_MailboxHandoff(benchmark::State &state) {
+  static FrameMailbox mailbox;
+  static std::vector<std::shared_ptr<cv::Mat>> frames;
+  if (state.thread_index() == 0) {
+    frames.clear();
+    for (int i = 0; i < 8; i++) {
+      frames.push_back(std::make_shared<cv::Mat>(480, 640, CV_8UC3));
+    }
+    mailbox.publish({frames[0], nullptr, metadataFor(mailbox.sequence() + 1)});
+  }
+
+  uint64_t seen = 0;
+  for (auto _ : state) {
+    if (state.thread_index() == 0) {
+      uint64_t sequence = mailbox.sequence() + 1;
+      mailbox.publish({frames[sequence % frames.size()], nullptr,
+                       metadataFor(sequence)});
+    } else if (mailbox.sequence() != seen) {
+      PublishedFrame published = mailbox.latest();
+      seen = published.metadata.sequence;
+      benchmark::DoNotOptimize(published.frame.get());
+    }
+  }
+}
+BENCHMARK(BM_MailboxHandoff)->ThreadRange(1, 8)->UseRealTime();
+
+// Uncontended reads, the cost a pipeline pays per takeFrame/takeMask.
+void BM_MailboxLatest(benchmark::State &state) {
+  FrameMailbox mailbox;
+  mailbox.publish({std::make_shared<cv::Mat>(480, 640, CV_8UC3),
+                   std::make_shared<cv::Mat>(240, 320, CV_8UC1),
+                   metadataFor(1)});
+  for (auto _ : state) {
+    PublishedFrame published = mailbox.latest();
+    benchmark::DoNotOptimize(published.frame.get());
+  }
+}
+BENCHMARK(BM_MailboxLatest);
+
+} // namespace
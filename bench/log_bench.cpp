@@ -0,0 +1,51 @@
+#include "native_log.hpp"
+#include <benchmark/benchmark.h>
+
+namespace {
+
+// Discards records so only the producer side is measured.
+void useNullSink() {
+  static bool installed = [] {
+    NativeLog::instance().setSink([](const LogRecord *, size_t) {});
+    return true;
+  }();
+  benchmark::DoNotOptimize(installed);
+}
+
+// A grab-loop error branch firing on every frame: almost every call is
+// rejected by the per-site rate limit.
+void BM_LogRateLimited(benchmark::State &state) {
+  useNullSink();
+  NativeLog::instance().setRateLimit(5);
+  int64_t frame = 0;
+  for (auto _ : state) {
+    BJNI_LOG_WARN("Bench::grabLoop", "Grab timed out, frame " << frame++);
+  }
+}
+BENCHMARK(BM_LogRateLimited)->ThreadRange(1, 8)->UseRealTime();
+
+// Every call formats and pushes a record. Records the ring drops when the
+// log thread falls behind are counted, which is what a producer pays too.
+void BM_LogPush(benchmark::State &state) {
+  useNullSink();
+  NativeLog::instance().setRateLimit(0);
+  int64_t frame = 0;
+  for (auto _ : state) {
+    BJNI_LOG_WARN("Bench::grabLoop", "Grab timed out, frame " << frame++);
+  }
+  if (state.thread_index() == 0) {
+    NativeLog::instance().setRateLimit(5);
+  }
+}
+BENCHMARK(BM_LogPush)->ThreadRange(1, 8)->UseRealTime();
+
+// A disabled level costs one relaxed load.
+void BM_LogDisabled(benchmark::State &state) {
+  NativeLog::instance().setLevel(kLogInfo);
+  for (auto _ : state) {
+    BJNI_LOG_DEBUG("Bench::grabLoop", "Frame retrieved");
+  }
+}
+BENCHMARK(BM_LogDisabled);
+
+} // namespace
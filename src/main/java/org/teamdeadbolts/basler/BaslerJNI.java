@@ -82,6 +82,13 @@ public class BaslerJNI {
 
     public static native boolean setBrightness(long ptr, double setBrightness);
 
+    /**
+     * {@link #setPixelFormat} code for the camera's 8-bit Bayer format. Frames are demosaiced
+     * natively and delivered as BGR, like {@code PixelFormat.kBGR}, at a third of RGB8's link
+     * bandwidth.
+     */
+    public static final int PIXEL_FORMAT_BAYER8 = 100;
+
     public static native boolean setPixelFormat(long ptr, int format);
 
     /**
@@ -124,9 +131,1034 @@ public class BaslerJNI {
     /** Get pointer to the latest captured frame. */
     public static native long takeFrame(long ptr);
 
-    public static native void awaitNewFrame(long ptr);
+    /** A new frame is available through {@link #takeFrame}. */
+    public static final int FRAME_NEW = 0;
+
+    /** No new frame arrived within the timeout (or, for {@link #pollFrame}, none was ready). */
+    public static final int FRAME_TIMEOUT = 1;
+
+    /** The camera is not grabbing, call {@link #startCamera} first. */
+    public static final int FRAME_NOT_GRABBING = 2;
+
+    /** The grab failed, see {@link #getLastGrabError} for the Pylon error code. */
+    public static final int FRAME_GRAB_FAILED = 3;
+
+    /** The camera is disconnected (or the handle is invalid). */
+    public static final int FRAME_DISCONNECTED = 4;
+
+    /** Wait up to 5 seconds for a new frame. */
+    public static int awaitNewFrame(long ptr) {
+        return awaitNewFrame(ptr, 5000);
+    }
+
+    /**
+     * Wait for a new frame.
+     *
+     * @param ptr The address of the native camera instance.
+     * @param timeoutMs Maximum time to wait, negative to wait forever.
+     * @return One of the FRAME_* status codes.
+     */
+    public static native int awaitNewFrame(long ptr, int timeoutMs);
+
+    /**
+     * Check for a new frame without blocking.
+     *
+     * @param ptr The address of the native camera instance.
+     * @param lastSequence Sequence number of the last frame the caller processed.
+     * @return {@link #FRAME_NEW} if a frame newer than lastSequence is available, {@link
+     *     #FRAME_TIMEOUT} if not, or another FRAME_* status on failure.
+     */
+    public static native int pollFrame(long ptr, long lastSequence);
+
+    /** Sequence number of the current frame, 0 before the first frame. */
+    public static native long getFrameSequence(long ptr);
+
+    /** Pylon error code of the last failed grab, -1 for a conversion failure. */
+    public static native long getLastGrabError(long ptr);
 
     public static native int getPixelFormat(long cameraPtr);
 
     public static native void cleanUp();
+
+    /**
+     * Configure the native worker pool that splits frame conversion into row stripes. The pool
+     * is shared by every camera in the process.
+     *
+     * @param threads Number of worker threads, 0 converts on the grabbing thread only.
+     * @param cpus CPUs to pin the workers to (round-robin), null or empty to leave them unpinned.
+     * @param minStripeRows Smallest number of rows handed to a worker at once.
+     * @return True if the configuration was applied.
+     */
+    public static native boolean configureConversionPool(int threads, int[] cpus, int minStripeRows);
+
+    /**
+     * Set CPU affinity and real-time priority for the camera's native threads. Affinity and
+     * SCHED_FIFO apply to the worker threads the camera owns (auto exposure, tag detection,
+     * exposure bracketing, reconnect), never to Java threads calling in; the Pylon priorities
+     * apply to its internal grab threads. Conversion workers are shared by all cameras, see {@link
+     * #configureConversionPool}.
+     *
+     * @param ptr The address of the native camera instance.
+     * @param cpus CPUs the threads may run on, null or empty for all CPUs.
+     * @param fifoPriority SCHED_FIFO priority (1-99), 0 for the default scheduler.
+     * @param grabEnginePriority Pylon InternalGrabEngineThreadPriority, -1 for Pylon's default.
+     * @param grabLoopPriority Pylon GrabLoopThreadPriority, -1 for Pylon's default.
+     * @return False if fifoPriority is out of range or the Pylon priorities could not be set, in
+     *     which case nothing changes.
+     */
+    public static native boolean setThreadScheduling(
+            long ptr, int[] cpus, int fifoPriority, int grabEnginePriority, int grabLoopPriority);
+
+    /** Reconnect thread, present for as long as the camera exists. */
+    public static final int THREAD_RECONNECT = 0;
+
+    /** Software auto exposure worker, see {@link #configureSoftwareAutoExposure}. */
+    public static final int THREAD_AUTO_EXPOSURE = 1;
+
+    /** Tag detection worker, see {@link #configureTagDetection}. */
+    public static final int THREAD_TAG_DETECTION = 2;
+
+    /** Host-mode bracketing writer, see {@link #configureExposureBracketing}. */
+    public static final int THREAD_BRACKET = 3;
+
+    /**
+     * Scheduling of one camera-owned thread, as read back from the kernel by that thread.
+     *
+     * @param thread One of the THREAD_* constants.
+     * @param policy Scheduling policy, e.g. SCHED_OTHER (0) or SCHED_FIFO (1).
+     * @param priority Scheduling priority, 0 under SCHED_OTHER.
+     * @param cpus CPUs the thread may run on.
+     */
+    public record EffectiveThreadSchedule(int thread, int policy, int priority, int[] cpus) {}
+
+    /**
+     * Requested and effective thread scheduling of a camera.
+     *
+     * @param grabEnginePriority Pylon InternalGrabEngineThreadPriority, -1 for Pylon's default.
+     * @param grabLoopPriority Pylon GrabLoopThreadPriority, -1 for Pylon's default.
+     * @param fifoPriority Requested SCHED_FIFO priority, 0 for the default scheduler, -1 if no
+     *     schedule was requested.
+     * @param cpus Requested CPUs, empty for all CPUs.
+     * @param threads Camera-owned threads running under the latest schedule.
+     */
+    public record ThreadScheduling(
+            int grabEnginePriority,
+            int grabLoopPriority,
+            int fifoPriority,
+            int[] cpus,
+            EffectiveThreadSchedule[] threads) {}
+
+    /**
+     * Get the requested thread scheduling and what each running camera-owned thread actually got.
+     * The reconnect thread applies a new schedule right after {@link #setThreadScheduling}; other
+     * workers when they next wake up or start.
+     *
+     * @return The scheduling, or null if the camera does not exist.
+     */
+    public static ThreadScheduling getThreadScheduling(long ptr) {
+        int[] raw = getThreadSchedulingRaw(ptr);
+        if (raw == null) return null;
+
+        int at = 3;
+        int[] cpus = java.util.Arrays.copyOfRange(raw, at + 1, at + 1 + raw[at]);
+        at += 1 + raw[at];
+        EffectiveThreadSchedule[] threads = new EffectiveThreadSchedule[raw[at++]];
+        for (int i = 0; i < threads.length; i++) {
+            int count = raw[at + 3];
+            threads[i] =
+                    new EffectiveThreadSchedule(
+                            raw[at],
+                            raw[at + 1],
+                            raw[at + 2],
+                            java.util.Arrays.copyOfRange(raw, at + 4, at + 4 + count));
+            at += 4 + count;
+        }
+        return new ThreadScheduling(raw[0], raw[1], raw[2], cpus, threads);
+    }
+
+    /**
+     * Raw form of {@link #getThreadScheduling}: {grabEnginePriority, grabLoopPriority,
+     * fifoPriority, cpuCount, cpus..., threadCount, then per thread {thread, policy, priority,
+     * cpuCount, cpus...}}.
+     */
+    public static native int[] getThreadSchedulingRaw(long ptr);
+
+    /** Identity and transport details of an enumerated camera. */
+    public record DeviceInfo(String serial, String model, String deviceClass, String ipAddress) {}
+
+    /**
+     * Get every enumerated camera in a single call, served from the native device cache.
+     *
+     * @return One entry per device, empty if none are connected.
+     */
+    public static DeviceInfo[] getDevices() {
+        String[] raw = getDeviceInfosRaw();
+        if (raw == null) return new DeviceInfo[0];
+
+        DeviceInfo[] devices = new DeviceInfo[raw.length / 4];
+        for (int i = 0; i < devices.length; i++) {
+            devices[i] = new DeviceInfo(raw[i * 4], raw[i * 4 + 1], raw[i * 4 + 2], raw[i * 4 + 3]);
+        }
+        return devices;
+    }
+
+    /**
+     * Flattened device cache contents, four strings per device: serial, model, device class
+     * (e.g. BaslerUsb, BaslerGigE) and IP address (empty for non-GigE devices).
+     */
+    public static native String[] getDeviceInfosRaw();
+
+    /**
+     * Re-enumerate connected devices into the native cache.
+     *
+     * @return Number of devices found, -1 on failure.
+     */
+    public static native int refreshDevices();
+
+    /**
+     * Start a background thread that refreshes the device cache periodically. While it runs,
+     * {@link #getConnectedCameras()} no longer enumerates on each call.
+     *
+     * @param intervalMs Refresh interval, 0 or less stops the watcher.
+     */
+    public static native boolean setDeviceWatcher(int intervalMs);
+
+    /**
+     * Open several cameras in parallel.
+     *
+     * @param serials Serial numbers or user-defined names of the cameras.
+     * @return Native camera pointers in the same order as serials, 0 for any that failed.
+     */
+    public static native long[] createCameras(String[] serials);
+
+    /** Index of the device create + open time in milliseconds in {@link #getCameraStats}. */
+    public static final int STAT_OPEN_TIME_MS = 0;
+
+    /** Index of the number of frames successfully grabbed in {@link #getCameraStats}. */
+    public static final int STAT_FRAMES_GRABBED = 1;
+
+    /** Index of the number of grab results that reported a failure in {@link #getCameraStats}. */
+    public static final int STAT_GRAB_FAILURES = 2;
+
+    /** Index of the number of frame waits that timed out in {@link #getCameraStats}. */
+    public static final int STAT_GRAB_TIMEOUTS = 3;
+
+    /** Index of the number of times the device was removed in {@link #getCameraStats}. */
+    public static final int STAT_DISCONNECTS = 4;
+
+    /** Index of the number of successful background reconnects in {@link #getCameraStats}. */
+    public static final int STAT_RECONNECTS = 5;
+
+    /** Index of the removal-to-grabbing time of the last reconnect in milliseconds. */
+    public static final int STAT_LAST_RECONNECT_MS = 6;
+
+    /** Index of the stream grabber's resend request count, -1 if the transport has none. */
+    public static final int STAT_RESEND_REQUESTS = 7;
+
+    /** Index of the number of packets requested for resend, -1 if the transport has none. */
+    public static final int STAT_RESEND_PACKETS = 8;
+
+    /** Index of the number of frames lost because no buffer was queued, -1 if unavailable. */
+    public static final int STAT_BUFFER_UNDERRUNS = 9;
+
+    /** Index of the stream grabber's failed buffer count, -1 if unavailable. */
+    public static final int STAT_FAILED_BUFFERS = 10;
+
+    /** Index of the stream grabber's total buffer count, -1 if unavailable. */
+    public static final int STAT_TOTAL_BUFFERS = 11;
+
+    /** Index of the stream grabber's missed frame count, -1 if unavailable. */
+    public static final int STAT_MISSED_FRAMES = 12;
+
+    /** Index of the stream grabber's resynchronization count, -1 if unavailable. */
+    public static final int STAT_RESYNCS = 13;
+
+    /**
+     * Index of the number of frames replaced by a newer one before they were taken, i.e. drops
+     * caused by the application falling behind.
+     */
+    public static final int STAT_FRAMES_SKIPPED = 14;
+
+    /** Index of the number of frames missing from the block ID sequence, i.e. transport drops. */
+    public static final int STAT_BLOCK_ID_GAPS = 15;
+
+    /** Frames dropped by change detection, see {@link #configureChangeDetection}. */
+    public static final int STAT_FRAMES_SUPPRESSED = 16;
+
+    /**
+     * Get the camera's native counters. Index with the STAT_* constants; later library versions
+     * only ever append entries.
+     */
+    public static native double[] getCameraStats(long ptr);
+
+    /**
+     * Save the camera configuration to a file.
+     *
+     * @param ptr The address of the native camera instance.
+     * @param path Destination file.
+     * @param fullNodeMap True to dump the whole node map as a Pylon .pfs file, false to save only
+     *     the settings applied through this library in a compact binary form.
+     * @return True if successful.
+     */
+    public static native boolean saveProfile(long ptr, String path, boolean fullNodeMap);
+
+    /**
+     * Restore a profile written by {@link #saveProfile}, in either format, with at most one
+     * acquisition restart.
+     */
+    public static native boolean loadProfile(long ptr, String path);
+
+    /**
+     * Store the current configuration in on-camera memory.
+     *
+     * @param ptr The address of the native camera instance.
+     * @param userSet User set 1-3.
+     * @param makeDefault True to have the camera load this set at power-up.
+     * @return True if successful.
+     */
+    public static native boolean saveUserSet(long ptr, int userSet, boolean makeDefault);
+
+    /**
+     * Load an on-camera configuration.
+     *
+     * @param ptr The address of the native camera instance.
+     * @param userSet User set 1-3, or 0 for the factory default.
+     * @return True if successful.
+     */
+    public static native boolean loadUserSet(long ptr, int userSet);
+
+    /** The camera is open and usable. */
+    public static final int CONNECTION_CONNECTED = 0;
+
+    /** The device was removed; the native side is waiting to reconnect. */
+    public static final int CONNECTION_DISCONNECTED = 1;
+
+    /** A background reconnect attempt is in progress. */
+    public static final int CONNECTION_RECONNECTING = 2;
+
+    /**
+     * Get the connection state of a camera. When a device is removed the library reconnects to it
+     * by serial in the background, restores the last applied settings and resumes grabbing under
+     * the same handle, so callers only need to observe this.
+     *
+     * @return One of the CONNECTION_* constants, -1 for an invalid handle.
+     */
+    public static native int getConnectionState(long ptr);
+
+    /**
+     * Tune the GigE stream of a camera. Settings survive reconnects.
+     *
+     * @param ptr The address of the native camera instance.
+     * @param packetSize Packet size in bytes, 0 to negotiate the largest size the network path
+     *     supports (jumbo frames where available).
+     * @param interPacketDelay Inter-packet delay in timestamp ticks, -1 to derive it from the
+     *     camera's bandwidth share.
+     * @param shareBandwidth True to split the link evenly with every other camera on the same host
+     *     interface configured with sharing enabled, re-divided as cameras are created, destroyed
+     *     and reconnected.
+     * @param maxResendRequests Maximum resend requests per frame, 0 disables resends, -1 keeps the
+     *     default.
+     * @param socketBufferKb Stream socket buffer size in KB, -1 keeps the default.
+     * @return True if applied, false for non-GigE cameras.
+     */
+    public static native boolean configureGigETransport(
+            long ptr,
+            int packetSize,
+            int interPacketDelay,
+            boolean shareBandwidth,
+            int maxResendRequests,
+            int socketBufferKb);
+
+    /**
+     * Tune the USB3 stream grabber. Applied on every {@link #startCamera}; a grabbing camera is
+     * restarted once. Pass -1 for any value to keep the default.
+     *
+     * @param ptr The address of the native camera instance.
+     * @param maxTransferSize Maximum USB transfer size in bytes.
+     * @param numMaxQueuedUrbs Maximum number of USB request blocks queued at once.
+     * @param maxBufferSize Maximum size of a grab buffer in bytes.
+     * @param maxNumBuffer Number of grab buffers.
+     * @param throughputLimitMode 0 to disable DeviceLinkThroughputLimitMode, 1 to enable it.
+     * @param throughputLimit Link throughput limit in bytes per second when enabled.
+     * @return True if applied, false for non-USB cameras.
+     */
+    public static native boolean configureUsbTransport(
+            long ptr,
+            int maxTransferSize,
+            int numMaxQueuedUrbs,
+            int maxBufferSize,
+            int maxNumBuffer,
+            int throughputLimitMode,
+            long throughputLimit);
+
+    /** Index of the exposure time in microseconds in {@link #getCameraState}. */
+    public static final int STATE_EXPOSURE = 0;
+
+    /** Index of the minimum exposure time in {@link #getCameraState}. */
+    public static final int STATE_MIN_EXPOSURE = 1;
+
+    /** Index of the maximum exposure time in {@link #getCameraState}. */
+    public static final int STATE_MAX_EXPOSURE = 2;
+
+    /** Index of the gain in {@link #getCameraState}. */
+    public static final int STATE_GAIN = 3;
+
+    /** Index of the minimum gain in {@link #getCameraState}. */
+    public static final int STATE_MIN_GAIN = 4;
+
+    /** Index of the maximum gain in {@link #getCameraState}. */
+    public static final int STATE_MAX_GAIN = 5;
+
+    /** Index of the acquisition frame rate in {@link #getCameraState}. */
+    public static final int STATE_FRAME_RATE = 6;
+
+    /** Index of the auto exposure flag (1 on, 0 off) in {@link #getCameraState}. */
+    public static final int STATE_AUTO_EXPOSURE = 7;
+
+    /** Index of the auto white balance flag (1 on, 0 off) in {@link #getCameraState}. */
+    public static final int STATE_AUTO_WHITE_BALANCE = 8;
+
+    /** Index of the red balance ratio in {@link #getCameraState}. */
+    public static final int STATE_WHITE_BALANCE_RED = 9;
+
+    /** Index of the green balance ratio in {@link #getCameraState}. */
+    public static final int STATE_WHITE_BALANCE_GREEN = 10;
+
+    /** Index of the blue balance ratio in {@link #getCameraState}. */
+    public static final int STATE_WHITE_BALANCE_BLUE = 11;
+
+    /** Index of the minimum balance ratio in {@link #getCameraState}. */
+    public static final int STATE_MIN_WHITE_BALANCE = 12;
+
+    /** Index of the maximum balance ratio in {@link #getCameraState}. */
+    public static final int STATE_MAX_WHITE_BALANCE = 13;
+
+    /** Index of the pixel format, as returned by {@link #getPixelFormat} in {@link #getCameraState}. */
+    public static final int STATE_PIXEL_FORMAT = 14;
+
+    /** Minimum length of the array passed to {@link #getCameraState}. */
+    public static final int STATE_COUNT = 15;
+
+    /**
+     * Read every current value and range shown in a settings UI in one call. Index the result with
+     * the STATE_* constants; entries the camera cannot report are -1.
+     *
+     * @param ptr The address of the native camera instance.
+     * @param out Array of at least {@link #STATE_COUNT} entries to fill.
+     * @return True if out was filled.
+     */
+    public static native boolean getCameraState(long ptr, double[] out);
+
+    /**
+     * Keep the most recent frames in a preallocated native ring so frames from just before an
+     * event can be pulled out afterwards. Storing into the ring never allocates or blocks the grab
+     * thread.
+     *
+     * @param ptr The address of the native camera instance.
+     * @param frames Number of frames to keep, 0 to disable and free the ring.
+     * @param raw True to store frames in the camera's pixel format (less memory, converted when
+     *     read), false to store the converted frames.
+     * @return True if the ring was (re)allocated.
+     */
+    public static native boolean setFrameHistory(long ptr, int frames, boolean raw);
+
+    /**
+     * Get a frame from the history ring by its sequence number (see {@link #getFrameSequence}).
+     *
+     * @return Pointer to a new Mat owned by the caller, 0 if the frame is not (or no longer) held.
+     */
+    public static native long takeFrameAt(long ptr, long sequence);
+
+    /** Get the {oldest, newest} sequence numbers held in the history ring, {0, 0} if empty. */
+    public static native long[] getFrameHistoryRange(long ptr);
+
+    /**
+     * Write the newest frames in the history ring to PNG files named {@code
+     * <serial>_<sequence>.png}.
+     *
+     * @param ptr The address of the native camera instance.
+     * @param directory Destination directory, created if missing.
+     * @param count Number of frames to write, 0 or less for the whole ring.
+     * @return Number of frames written.
+     */
+    public static native int dumpRecentFrames(long ptr, String directory, int count);
+
+    /** Ints per rectangle passed to {@link #takeFrameRegions}: x, y, width, height. */
+    public static final int REGION_RECT_INTS = 4;
+
+    /**
+     * Ints per region written to the layout of {@link #takeFrameRegions}: byte offset into the
+     * buffer, row stride in bytes, width, height and channel count.
+     */
+    public static final int REGION_LAYOUT_INTS = 5;
+
+    /**
+     * Returned by {@link #takeFrameRegions} on invalid arguments or when the packed regions would
+     * not fit an int offset. Distinct from every negated required size.
+     */
+    public static final long REGION_ERROR = Long.MIN_VALUE;
+
+    /**
+     * Copy only the given rectangles of the latest frame into a packed buffer, so the bytes
+     * crossing into Java scale with region area rather than sensor size. Rectangles are clipped to
+     * the frame; one that falls outside it comes back with zero width and height.
+     *
+     * @param ptr The address of the native camera instance.
+     * @param rects {@link #REGION_RECT_INTS} ints per region.
+     * @param buffer Direct buffer receiving the packed pixel rows.
+     * @param layout Receives {@link #REGION_LAYOUT_INTS} ints per region.
+     * @return Bytes written; if the buffer is too small, the negated required size (layout is
+     *     filled, no pixels are copied); 0 if no frame is available yet; {@link #REGION_ERROR} on
+     *     invalid arguments.
+     */
+    public static native long takeFrameRegions(
+            long ptr, int[] rects, java.nio.ByteBuffer buffer, int[] layout);
+
+    /** Auto function profile that keeps gain as low as possible. */
+    public static final int AUTO_PROFILE_MINIMIZE_GAIN = 0;
+
+    /** Auto function profile that keeps exposure time as short as possible. */
+    public static final int AUTO_PROFILE_MINIMIZE_EXPOSURE = 1;
+
+    /**
+     * Configure the camera's auto exposure/gain functions. Applies to both {@link
+     * #setAutoExposure} and {@link #triggerAutoExposureOnce}, and survives reconnects.
+     *
+     * @param ptr The address of the native camera instance.
+     * @param roi {x, y, width, height} metering region, null for the full frame.
+     * @param limits {exposureLowerUs, exposureUpperUs, gainLower, gainUpper, targetBrightness
+     *     (0-1)}, -1 for any entry to keep the camera's value, or null to keep all of them.
+     * @param capExposureToFrameRate True to keep the exposure short enough that it never lowers
+     *     the frame rate set through {@link #setFrameRate}, updated whenever it changes.
+     * @param profile One of the AUTO_PROFILE_* constants, -1 to keep the current profile.
+     * @param autoGain True to let gain follow auto exposure instead of staying fixed.
+     * @return True if applied.
+     */
+    public static native boolean configureAutoFunctions(
+            long ptr,
+            int[] roi,
+            double[] limits,
+            boolean capExposureToFrameRate,
+            int profile,
+            boolean autoGain);
+
+    /** Auto exposure is off, or a {@link #triggerAutoExposureOnce} run has settled. */
+    public static final int AUTO_EXPOSURE_OFF = 0;
+
+    /** Auto exposure adjusts continuously. */
+    public static final int AUTO_EXPOSURE_CONTINUOUS = 1;
+
+    /** A {@link #triggerAutoExposureOnce} run is still converging. */
+    public static final int AUTO_EXPOSURE_CONVERGING = 2;
+
+    /**
+     * Let auto exposure converge once and then hold the result. Poll {@link
+     * #getAutoExposureState} until it reports {@link #AUTO_EXPOSURE_OFF} to know it has settled;
+     * that is also when the settled exposure and gain are recorded for profiles and reconnects.
+     * The camera must be grabbing for it to converge.
+     */
+    public static native boolean triggerAutoExposureOnce(long ptr);
+
+    /** Get one of the AUTO_EXPOSURE_* states, -1 on failure. */
+    public static native int getAutoExposureState(long ptr);
+
+    /** Software auto exposure off, no histograms computed. */
+    public static final int SOFTWARE_AE_OFF = 0;
+
+    /** Compute the luma histogram of every frame for {@link #getLumaHistogram} only. */
+    public static final int SOFTWARE_AE_HISTOGRAM = 1;
+
+    /** Compute histograms and drive exposure and gain from them. */
+    public static final int SOFTWARE_AE_CONTROL = 2;
+
+    /**
+     * Configure the host-side auto exposure. A subsampled luma histogram of each frame (or of the
+     * ROI) feeds a rate-limited PI controller that adjusts exposure first and gain once exposure
+     * is at its limit. Controller steps run on their own thread and never delay frames. Control
+     * mode turns the camera's own auto exposure and auto gain off.
+     *
+     * @param ptr The address of the native camera instance.
+     * @param mode One of the SOFTWARE_AE_* constants.
+     * @param roi {x, y, width, height} metering region, null for the full frame.
+     * @param params {targetLuma (0-255), kp, ki, maxStepRatio, maxExposureUs, maxGainDb}, or null
+     *     for the defaults {110, 0.6, 0.1, 1.5, -1, -1}. A maxExposureUs of -1 keeps the exposure
+     *     short enough for the configured frame rate; a maxGainDb of -1 allows the full range.
+     * @param subsample Sample every Nth pixel of every Nth row.
+     * @return True if applied.
+     */
+    public static native boolean configureSoftwareAutoExposure(
+            long ptr, int mode, int[] roi, double[] params, int subsample);
+
+    /** Get the 256-bin luma histogram of the latest frame, all zero if histograms are off. */
+    public static native int[] getLumaHistogram(long ptr);
+
+    /**
+     * Settings and timestamps of a single frame. With chunk mode on, exposure, gain, line status
+     * and frame counter come from the frame itself; check {@code fields} (META_* bits) for which
+     * were present.
+     *
+     * @param sequence Frame sequence number, as returned by {@link #getFrameSequence}.
+     * @param hostTimestampNs Host steady-clock time the frame was retrieved.
+     * @param cameraTimestamp Camera timestamp in device ticks.
+     * @param exposureUs Exposure time, -1 if not reported.
+     * @param gain Gain, -1 if not reported.
+     * @param lineStatus Bitmask of I/O line levels.
+     * @param frameCounter Camera frame counter.
+     * @param fields Bitmask of META_* flags.
+     * @param changeScore Mean luma difference to the last published frame in grey levels, -1 if
+     *     change detection is off.
+     * @param bracketIndex Index into the bracketing exposure list, -1 when not bracketing.
+     */
+    public record FrameMetadata(
+            long sequence,
+            long hostTimestampNs,
+            long cameraTimestamp,
+            double exposureUs,
+            double gain,
+            long lineStatus,
+            long frameCounter,
+            int fields,
+            double changeScore,
+            int bracketIndex) {
+        /** Length of the long[] passed to the raw metadata calls. */
+        public static final int RAW_INTS = 7;
+
+        /** Length of the double[] passed to the raw metadata calls. */
+        public static final int RAW_FLOATS = 3;
+
+        public static FrameMetadata fromRaw(long[] ints, double[] floats) {
+            return new FrameMetadata(
+                    ints[0],
+                    ints[1],
+                    ints[2],
+                    floats[0],
+                    floats[1],
+                    ints[3],
+                    ints[4],
+                    (int) ints[5],
+                    floats[2],
+                    (int) ints[6]);
+        }
+    }
+
+    /** The exposure time came from the frame's chunk data. */
+    public static final int META_EXPOSURE = 1;
+
+    /** The gain came from the frame's chunk data. */
+    public static final int META_GAIN = 1 << 1;
+
+    /** The line status came from the frame's chunk data. */
+    public static final int META_LINE_STATUS = 1 << 2;
+
+    /** The frame counter came from the frame's chunk data. */
+    public static final int META_FRAME_COUNTER = 1 << 3;
+
+    /** The camera timestamp came from the frame's chunk data rather than the transport. */
+    public static final int META_CHUNK_TIMESTAMP = 1 << 4;
+
+    /** The change score was measured, see {@link #configureChangeDetection}. */
+    public static final int META_CHANGE_SCORE = 1 << 5;
+
+    /** The bracket index is known, see {@link #configureExposureBracketing}. */
+    public static final int META_BRACKET_INDEX = 1 << 6;
+
+    /**
+     * Enable chunk mode so every frame carries its timestamp, exposure, gain, line status and frame
+     * counter. Chunks a model does not support are skipped. Restarts acquisition once if grabbing.
+     */
+    public static native boolean setChunkMetadata(long ptr, boolean enable);
+
+    /**
+     * Like {@link #takeFrame}, but also fills the frame's metadata, read together with the frame.
+     *
+     * @param ints {@link FrameMetadata#RAW_INTS} entries, see {@link FrameMetadata#fromRaw}.
+     * @param floats {@link FrameMetadata#RAW_FLOATS} entries.
+     * @return Pointer to a new Mat owned by the caller, 0 if no frame is available.
+     */
+    public static native long takeFrameWithMetadata(long ptr, long[] ints, double[] floats);
+
+    /**
+     * Get the metadata of the current frame or of one still in the history ring (see {@link
+     * #setFrameHistory}).
+     *
+     * @return The metadata, or null if that frame is no longer held.
+     */
+    public static FrameMetadata getFrameMetadata(long ptr, long sequence) {
+        long[] ints = new long[FrameMetadata.RAW_INTS];
+        double[] floats = new double[FrameMetadata.RAW_FLOATS];
+        if (!getFrameMetadataRaw(ptr, sequence, ints, floats)) return null;
+        return FrameMetadata.fromRaw(ints, floats);
+    }
+
+    public static native boolean getFrameMetadataRaw(
+            long ptr, long sequence, long[] ints, double[] floats);
+
+    /**
+     * Undistort frames natively before they are delivered through {@link #takeFrame} and the
+     * other take calls. Remap tables are built once and rebuilt only when the ROI or binning
+     * changes, with the intrinsics moved to the new geometry. Delivered frames keep the camera
+     * matrix with zero distortion.
+     *
+     * @param ptr The address of the native camera instance.
+     * @param cameraMatrix Row-major 3x3 intrinsics, null to turn undistortion off.
+     * @param distCoeffs OpenCV distortion coefficients (4, 5, 8, 12 or 14 entries).
+     * @param calibWidth Width the calibration was made at; must match the current frame width.
+     * @param calibHeight Height the calibration was made at; must match the current frame height.
+     * @return True if applied.
+     */
+    public static native boolean setUndistortion(
+            long ptr, double[] cameraMatrix, double[] distCoeffs, int calibWidth, int calibHeight);
+
+    /** No morphology on the threshold mask. */
+    public static final int MORPH_NONE = 0;
+
+    /** Erode then dilate the threshold mask, removing specks. */
+    public static final int MORPH_OPEN = 1;
+
+    /** Dilate then erode the threshold mask, filling holes. */
+    public static final int MORPH_CLOSE = 2;
+
+    /**
+     * Produce a binary HSV threshold mask alongside every frame. The threshold is fused into the
+     * native conversion pass, so each frame is read once and only a 1-byte-per-pixel mask is
+     * written. Read it with {@link #takeMask} or {@link #takeMaskInto}.
+     *
+     * @param ptr The address of the native camera instance.
+     * @param config {hueLow, hueHigh, satLow, satHigh, valLow, valHigh, downsample, morphology,
+     *     kernelSize} using OpenCV HSV ranges (hue 0-180; hueLow greater than hueHigh wraps
+     *     through red). downsample is 1, 2, 4 or 8; morphology is one of the MORPH_* constants.
+     *     Mono cameras use only the value range. Null turns thresholding off.
+     * @return True if applied.
+     */
+    public static native boolean setThreshold(long ptr, int[] config);
+
+    /** Get the threshold mask of the latest frame as a new CV_8UC1 Mat, 0 if none. */
+    public static native long takeMask(long ptr);
+
+    /**
+     * Copy the threshold mask of the latest frame into a direct buffer, one byte per pixel, rows
+     * packed.
+     *
+     * @return Bytes written; the negated required size if the buffer is too small; 0 if there is
+     *     no mask; -1 on invalid arguments.
+     */
+    public static native long takeMaskInto(long ptr, java.nio.ByteBuffer buffer);
+
+    /** AprilTag 36h11, the FRC family. */
+    public static final int TAG_FAMILY_36H11 = 0;
+
+    public static final int TAG_FAMILY_25H9 = 1;
+
+    public static final int TAG_FAMILY_16H5 = 2;
+
+    /**
+     * Run AprilTag detection natively on every frame, on a worker thread owned by the camera. The
+     * grab thread only hands the frame over, so detection never delays frame delivery; when the
+     * worker falls behind it skips straight to the newest frame. Read results with {@link
+     * #getTagDetections}, no pixels need to cross into Java.
+     *
+     * @param ptr The address of the native camera instance.
+     * @param family One of the TAG_FAMILY_* constants, or -1 to turn detection off.
+     * @param decimate Detect on a frame shrunk by this factor (1-8), then refine corners at full
+     *     resolution. 2 is a good default for 1080p and up.
+     * @param minDecisionMargin Drop detections with a lower decision margin (grey levels).
+     * @return True if applied.
+     */
+    public static native boolean configureTagDetection(
+            long ptr, int family, int decimate, double minDecisionMargin);
+
+    /**
+     * A detected tag.
+     *
+     * @param id Tag ID.
+     * @param decisionMargin Grey-level distance of the weakest bit from the black/white
+     *     threshold; low values mean an unreliable decode.
+     * @param corners x, y of the four corners in AprilTag order (counter-clockwise from the
+     *     bottom left), in full-frame pixels.
+     */
+    public record TagDetection(int id, double decisionMargin, double[] corners) {
+        /** Doubles per detection in the raw array: id, margin, then the 8 corner values. */
+        public static final int RAW_DOUBLES = 10;
+    }
+
+    /**
+     * Tags found in one frame.
+     *
+     * @param sequence Sequence number of the frame, see {@link #getFrameMetadata}.
+     * @param hostTimestampNs Host steady-clock time the frame was retrieved.
+     * @param cameraTimestamp Camera timestamp in device ticks.
+     * @param latencyNs Time from hand-off to the detector until the result was published.
+     * @param tags Detections, possibly empty.
+     */
+    public record TagDetections(
+            long sequence,
+            long hostTimestampNs,
+            long cameraTimestamp,
+            long latencyNs,
+            TagDetection[] tags) {
+        /** Length of the long[] passed to {@link #getTagDetectionsRaw}. */
+        public static final int RAW_INFO_LONGS = 4;
+    }
+
+    /**
+     * Get the detections of the most recently processed frame.
+     *
+     * @return The detections, or null if detection is off or no frame has been processed yet.
+     */
+    public static TagDetections getTagDetections(long ptr) {
+        long[] info = new long[TagDetections.RAW_INFO_LONGS];
+        double[] raw = new double[TagDetection.RAW_DOUBLES * 16];
+        int count = getTagDetectionsRaw(ptr, info, raw);
+        if (count < 0) return null;
+        if (count * TagDetection.RAW_DOUBLES > raw.length) {
+            raw = new double[count * TagDetection.RAW_DOUBLES];
+            count = getTagDetectionsRaw(ptr, info, raw);
+            if (count < 0) return null;
+            // A newer frame may have more tags than the array was sized for.
+            count = Math.min(count, raw.length / TagDetection.RAW_DOUBLES);
+        }
+
+        TagDetection[] tags = new TagDetection[count];
+        for (int i = 0; i < count; i++) {
+            int base = i * TagDetection.RAW_DOUBLES;
+            tags[i] =
+                    new TagDetection(
+                            (int) raw[base],
+                            raw[base + 1],
+                            java.util.Arrays.copyOfRange(
+                                    raw, base + 2, base + TagDetection.RAW_DOUBLES));
+        }
+        return new TagDetections(info[0], info[1], info[2], info[3], tags);
+    }
+
+    /**
+     * Raw form of {@link #getTagDetections}. Fills info with {sequence, hostTimestampNs,
+     * cameraTimestamp, latencyNs} and tags with as many detections as fit.
+     *
+     * @return The total number of detections (which may exceed what was written), or -1 if there
+     *     is no result.
+     */
+    public static native int getTagDetectionsRaw(long ptr, long[] info, double[] tags);
+
+    /**
+     * Score every frame by how much it changed since the last published frame, and optionally drop
+     * frames that barely changed before any conversion is done. The score is the mean absolute
+     * luma difference over a subsampled grid, in grey levels, and is reported as {@link
+     * FrameMetadata#changeScore}. Suppressed frames are never delivered: {@link #awaitNewFrame}
+     * keeps waiting and {@link #STAT_FRAMES_SUPPRESSED} counts them.
+     *
+     * @param ptr The address of the native camera instance.
+     * @param gridStep Sample every Nth pixel of every Nth row (rounded up to even), 0 to turn
+     *     change detection off.
+     * @param suppressBelow Drop frames scoring below this, -1 to only score.
+     * @param maxSuppressed Deliver a frame anyway after this many consecutive drops, 0 for no
+     *     limit.
+     * @return True if applied.
+     */
+    public static native boolean configureChangeDetection(
+            long ptr, int gridStep, double suppressBelow, int maxSuppressed);
+
+    /** Exposure bracketing is off. */
+    public static final int BRACKET_OFF = 0;
+
+    /** The camera's sequencer cycles the exposures. */
+    public static final int BRACKET_SEQUENCER = 1;
+
+    /** The library alternates the exposure from the host as frames arrive. */
+    public static final int BRACKET_HOST = 2;
+
+    /**
+     * Cycle frames through several exposure times for scenes with both very bright and very dark
+     * regions. Each frame's {@link FrameMetadata#bracketIndex} says which exposure it used; index
+     * 0 is always the shortest. Uses the camera's sequencer where available, which switches
+     * exposures with no host involvement; otherwise the library writes the next exposure as each
+     * frame arrives. Turns chunk metadata on and ExposureAuto off. While bracketing, {@link
+     * #setExposure} has no lasting effect. Turning bracketing off restores the exposure time,
+     * ExposureAuto and chunk metadata state from before it was enabled.
+     *
+     * @param ptr The address of the native camera instance.
+     * @param exposuresUs 2-4 exposure times in microseconds, or null to turn bracketing off.
+     * @param preferSequencer Use the camera's sequencer if it has one.
+     * @param fuse Fuse each consecutive short/long pair into a frame readable with {@link
+     *     #takeFusedFrame}, scaling the short exposure by the exposure ratio and tone mapping the
+     *     highlights back into 8 bits. Requires exactly two exposures; fails otherwise.
+     * @param fusionKnee Level (0-253) in the long exposure where fusion starts blending in the
+     *     short one; 200 is a good default.
+     * @return One of the BRACKET_* modes, or -1 on failure.
+     */
+    public static native int configureExposureBracketing(
+            long ptr, double[] exposuresUs, boolean preferSequencer, boolean fuse, int fusionKnee);
+
+    /**
+     * Get the latest fused short/long pair as a new Mat, in the same format as {@link #takeFrame}.
+     *
+     * @return Pointer to a new Mat owned by the caller, 0 if fusion is off or no pair is ready.
+     */
+    public static native long takeFusedFrame(long ptr);
+
+    /**
+     * Bytes at the start of every frame overwritten in latency test mode: block ID, sequence and
+     * retrieve time (host {@link System#nanoTime} clock) as little-endian longs.
+     */
+    public static final int LATENCY_STAMP_BYTES = 24;
+
+    /** Length of the long[] passed to {@link #getLatencyTrace}. */
+    public static final int LATENCY_TRACE_LONGS = 7;
+
+    /**
+     * Latency test mode for measuring the whole capture-to-Java path, see {@link
+     * LatencyHarness}. Switches to Mono8 and the camera's test image where it has one, stamps
+     * every frame's first {@link #LATENCY_STAMP_BYTES} bytes and records per-stage timestamps.
+     * Leave undistortion, fusion and other frame-altering stages off while it is enabled. Disabling
+     * it restores the previous pixel format and test image.
+     */
+    public static native boolean setLatencyTestMode(long ptr, boolean enable);
+
+    /**
+     * Get the timestamps of a recent frame in latency test mode, all on the {@link
+     * System#nanoTime} clock: {sequence, blockId, captureNs (-1 if the camera clock could not be
+     * mapped), retrievedNs, convertedNs, publishedNs, takenNs (0 if not taken yet)}.
+     *
+     * @return False if the frame is no longer held or the mode is off.
+     */
+    public static native boolean getLatencyTrace(long ptr, long sequence, long[] out);
+
+    /** Frames will be used as BGR. */
+    public static final int OUTPUT_BGR = 0;
+
+    /** Frames will be used as grayscale. */
+    public static final int OUTPUT_GRAY = 1;
+
+    /** Frames feed the native HSV threshold, see {@link #setThreshold}. */
+    public static final int OUTPUT_HSV_MASK = 2;
+
+    /** Frames are only displayed; the lightest fast format wins. */
+    public static final int OUTPUT_PREVIEW = 3;
+
+    /**
+     * Result of {@link #negotiatePixelFormat}.
+     *
+     * @param format The chosen {@link #setPixelFormat} code, -1 if none.
+     * @param reasoning Per-format estimates and the verdict, one line each.
+     */
+    public record PixelFormatChoice(int format, String reasoning) {}
+
+    /**
+     * Pick the camera pixel format that sustains the highest frame rate for the intended output.
+     * Every format the camera offers is scored by the slowest of sensor, link bandwidth and
+     * native conversion time, which is measured on this machine. For example, on a
+     * bandwidth-bound link Bayer plus native demosaicing beats RGB8.
+     *
+     * @param ptr The address of the native camera instance.
+     * @param intent One of the OUTPUT_* constants.
+     * @param apply Switch to the chosen format, restarting acquisition once if grabbing.
+     * @return The choice and its reasoning.
+     */
+    public static PixelFormatChoice negotiatePixelFormat(long ptr, int intent, boolean apply) {
+        String[] reasoning = new String[1];
+        int format = negotiatePixelFormatRaw(ptr, intent, apply, reasoning);
+        return new PixelFormatChoice(format, reasoning[0] != null ? reasoning[0] : "");
+    }
+
+    public static native int negotiatePixelFormatRaw(
+            long ptr, int intent, boolean apply, String[] reasoning);
+
+    /** Native log levels, see {@link #configureNativeLog}. */
+    public static final int LOG_TRACE = 0;
+
+    public static final int LOG_DEBUG = 1;
+    public static final int LOG_INFO = 2;
+    public static final int LOG_WARN = 3;
+    public static final int LOG_ERROR = 4;
+
+    /** As a minimum level, disables native logging. */
+    public static final int LOG_OFF = 5;
+
+    /**
+     * One native log record.
+     *
+     * @param timeNanos Wall-clock time, ns since the Unix epoch.
+     * @param level One of the LOG_* constants.
+     * @param site Where it was logged, e.g. "CameraInstance::setGain".
+     * @param message The message, truncated to 255 bytes.
+     * @param suppressed Records from the same site the rate limit dropped before this one.
+     */
+    public record NativeLogRecord(
+            long timeNanos, int level, String site, String message, int suppressed) {}
+
+    /** Receives forwarded native log records, in order, on the native log thread. */
+    @FunctionalInterface
+    public interface NativeLogListener {
+        void onNativeLog(NativeLogRecord record);
+    }
+
+    private static final System.Logger nativeLogger =
+            System.getLogger("org.teamdeadbolts.basler.native");
+    private static volatile NativeLogListener nativeLogListener = BaslerJNI::logToSystemLogger;
+
+    /**
+     * Set the minimum native log level and the per-call-site rate limit. Records above the limit
+     * are counted and reported with the next record from that site. Defaults to {@link
+     * #LOG_INFO} and 5 per second.
+     *
+     * @param minLevel One of the LOG_* constants.
+     * @param perSiteLimit Records per call site per second, 0 for unlimited.
+     * @return False if an argument is out of range.
+     */
+    public static native boolean configureNativeLog(int minLevel, int perSiteLimit);
+
+    /**
+     * Route native log records to Java instead of stdout. Records arrive in batches from a
+     * background thread, so logging never blocks the grab or conversion threads.
+     *
+     * @param listener Receives the records, null for the default {@link System.Logger} named
+     *     "org.teamdeadbolts.basler.native".
+     * @return False if forwarding could not be enabled.
+     */
+    public static boolean setNativeLogListener(NativeLogListener listener) {
+        nativeLogListener = listener != null ? listener : BaslerJNI::logToSystemLogger;
+        return setNativeLogForwarding(true);
+    }
+
+    /** Enable or disable forwarding; when disabled, native logs go to stdout. */
+    public static native boolean setNativeLogForwarding(boolean enable);
+
+    /** Deliver every native log record queued so far before returning. */
+    public static native void flushNativeLog();
+
+    // Called from native code with one batch of records.
+    private static void dispatchNativeLogs(
+            long[] times, int[] levels, int[] suppressed, String[] sites, String[] messages) {
+        NativeLogListener listener = nativeLogListener;
+        for (int i = 0; i < times.length; i++) {
+            NativeLogRecord record =
+                    new NativeLogRecord(
+                            times[i], levels[i], sites[i], messages[i], suppressed[i]);
+            try {
+                listener.onNativeLog(record);
+            } catch (RuntimeException e) {
+                // Keep delivering the rest of the batch.
+                nativeLogger.log(System.Logger.Level.ERROR, "Native log listener failed", e);
+            }
+        }
+    }
+
+    private static void logToSystemLogger(NativeLogRecord record) {
+        System.Logger.Level level =
+                switch (record.level()) {
+                    case LOG_TRACE -> System.Logger.Level.TRACE;
+                    case LOG_DEBUG -> System.Logger.Level.DEBUG;
+                    case LOG_INFO -> System.Logger.Level.INFO;
+                    case LOG_WARN -> System.Logger.Level.WARNING;
+                    default -> System.Logger.Level.ERROR;
+                };
+        if (!nativeLogger.isLoggable(level)) {
+            return;
+        }
+        String text = "[" + record.site() + "] " + record.message();
+        if (record.suppressed() > 0) {
+            text += " (" + record.suppressed() + " similar suppressed)";
+        }
+        nativeLogger.log(level, text);
+    }
 }
@@ -0,0 +1,191 @@
+/* Team Deadbolts (C) 2025 */
+package org.teamdeadbolts.basler;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.util.Arrays;
+import org.opencv.core.Core;
+import org.opencv.core.Mat;
+
+/**
+ * Measures per-frame latency from capture to Java receipt using latency test mode (see {@link
+ * BaslerJNI#setLatencyTestMode}).
+ *
+ * <p>Every frame's pixels carry the sequence and retrieve time stamped natively, so each frame
+ * that reaches Java is matched to its own trace even when frames are skipped. Runs against any
+ * camera, including the Pylon camera emulator ({@code PYLON_CAMEMU=1}), which makes it usable as
+ * a CI regression check: {@code ./gradlew latencyBenchmark}.
+ */
+public final class LatencyHarness {
+    /** Stages reported, in pipeline order. */
+    public static final String[] STAGES = {
+        "capture->retrieve", "retrieve->convert", "convert->publish", "publish->take",
+        "take->java", "retrieve->java", "capture->java",
+    };
+
+    /** Distribution of one stage in microseconds. */
+    public record StageStats(
+            String name, int count, double p50Us, double p90Us, double p99Us, double maxUs) {
+        @Override
+        public String toString() {
+            return String.format(
+                    "%-18s n=%-5d p50=%9.1fus p90=%9.1fus p99=%9.1fus max=%9.1fus",
+                    name, count, p50Us, p90Us, p99Us, maxUs);
+        }
+    }
+
+    /**
+     * Result of a run.
+     *
+     * @param frames Frames received in Java.
+     * @param skipped Frames the camera delivered that Java never saw.
+     * @param mismatched Frames whose stamp did not match their trace; should always be 0.
+     * @param stages One entry per {@link #STAGES} name.
+     */
+    public record Report(int frames, int skipped, int mismatched, StageStats[] stages) {
+        @Override
+        public String toString() {
+            StringBuilder text =
+                    new StringBuilder(
+                            String.format(
+                                    "frames=%d skipped=%d mismatched=%d%n",
+                                    frames, skipped, mismatched));
+            for (StageStats stage : stages) {
+                text.append(stage).append(System.lineSeparator());
+            }
+            return text.toString();
+        }
+    }
+
+    private LatencyHarness() {}
+
+    /**
+     * Enable latency test mode, grab frames and report per-stage latency. Leaves the camera
+     * grabbing with latency test mode off.
+     *
+     * @param ptr The address of the native camera instance.
+     * @param frames Frames to measure.
+     * @param timeoutMs Per-frame wait before giving up.
+     * @return The report, or null if the camera could not be put into latency test mode.
+     */
+    public static Report measure(long ptr, int frames, int timeoutMs) {
+        if (!BaslerJNI.setLatencyTestMode(ptr, true) || !BaslerJNI.startCamera(ptr)) {
+            return null;
+        }
+
+        long[][] samples = new long[STAGES.length][frames];
+        int[] counts = new int[STAGES.length];
+        long[] trace = new long[BaslerJNI.LATENCY_TRACE_LONGS];
+        byte[] stamp = new byte[BaslerJNI.LATENCY_STAMP_BYTES];
+        int received = 0;
+        int skipped = 0;
+        int mismatched = 0;
+        long lastSequence = -1;
+
+        try {
+            while (received < frames) {
+                if (BaslerJNI.awaitNewFrame(ptr, timeoutMs) != BaslerJNI.FRAME_NEW) {
+                    break;
+                }
+                long matPtr = BaslerJNI.takeFrame(ptr);
+                long javaNs = System.nanoTime();
+                if (matPtr == 0) continue;
+
+                Mat frame = new Mat(matPtr);
+                frame.get(0, 0, stamp);
+                frame.release();
+
+                ByteBuffer fields = ByteBuffer.wrap(stamp).order(ByteOrder.LITTLE_ENDIAN);
+                fields.getLong(); // block ID
+                long sequence = fields.getLong();
+                long retrievedNs = fields.getLong();
+                if (!BaslerJNI.getLatencyTrace(ptr, sequence, trace)
+                        || trace[3] != retrievedNs) {
+                    mismatched++;
+                    continue;
+                }
+
+                if (lastSequence >= 0 && sequence > lastSequence + 1) {
+                    skipped += (int) (sequence - lastSequence - 1);
+                }
+                lastSequence = sequence;
+
+                long captureNs = trace[2];
+                long[] stageNs = {
+                    captureNs >= 0 ? trace[3] - captureNs : -1,
+                    trace[4] - trace[3],
+                    trace[5] - trace[4],
+                    trace[6] - trace[5],
+                    javaNs - trace[6],
+                    javaNs - trace[3],
+                    captureNs >= 0 ? javaNs - captureNs : -1,
+                };
+                for (int i = 0; i < STAGES.length; i++) {
+                    if (stageNs[i] >= 0) {
+                        samples[i][counts[i]++] = stageNs[i];
+                    }
+                }
+                received++;
+            }
+        } finally {
+            BaslerJNI.setLatencyTestMode(ptr, false);
+        }
+
+        StageStats[] stages = new StageStats[STAGES.length];
+        for (int i = 0; i < STAGES.length; i++) {
+            long[] sorted = Arrays.copyOf(samples[i], counts[i]);
+            Arrays.sort(sorted);
+            stages[i] =
+                    new StageStats(
+                            STAGES[i],
+                            sorted.length,
+                            percentileUs(sorted, 0.50),
+                            percentileUs(sorted, 0.90),
+                            percentileUs(sorted, 0.99),
+                            percentileUs(sorted, 1.0));
+        }
+        return new Report(received, skipped, mismatched, stages);
+    }
+
+    private static double percentileUs(long[] sorted, double fraction) {
+        if (sorted.length == 0) return Double.NaN;
+        int index = (int) Math.ceil(fraction * sorted.length) - 1;
+        return sorted[Math.max(index, 0)] / 1000.0;
+    }
+
+    /**
+     * Usage: {@code LatencyHarness [serial] [frames]}. Uses the first camera if no serial is
+     * given. Exits non-zero if no frames arrived or any stamp mismatched.
+     */
+    public static void main(String[] args) {
+        System.loadLibrary(Core.NATIVE_LIBRARY_NAME);
+        System.loadLibrary("baslerjni");
+
+        String[] cameras = BaslerJNI.getConnectedCameras();
+        String serial = args.length > 0 ? args[0] : (cameras.length > 0 ? cameras[0] : null);
+        int frames = args.length > 1 ? Integer.parseInt(args[1]) : 300;
+        if (serial == null) {
+            System.err.println("No cameras found; set PYLON_CAMEMU=1 to use the emulator.");
+            System.exit(2);
+        }
+
+        long handle = BaslerJNI.createCamera(serial);
+        if (handle == 0) {
+            System.err.println("Failed to open camera " + serial);
+            System.exit(2);
+        }
+        Report report;
+        try {
+            report = measure(handle, frames, 2000);
+        } finally {
+            BaslerJNI.destroyCamera(handle);
+        }
+
+        if (report == null) {
+            System.err.println("Camera " + serial + " does not support latency test mode");
+            System.exit(2);
+        }
+        System.out.print(report);
+        System.exit(report.frames() == 0 || report.mismatched() > 0 ? 1 : 0);
+    }
+}
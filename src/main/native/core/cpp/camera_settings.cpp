@@ -0,0 +1,120 @@
+#include "camera_settings.hpp"
+#include "native_log.hpp"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace {
+
+constexpr char kMagic[4] = {'B', 'J', 'C', 'S'};
+constexpr uint32_t kVersion = 1;
+
+template <typename T> void put(std::vector<uint8_t> &out, const T &value) {
+  const auto *bytes = reinterpret_cast<const uint8_t *>(&value);
+  out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+bool get(const std::vector<uint8_t> &in, size_t &offset, T &value) {
+  if (offset + sizeof(T) > in.size()) {
+    return false;
+  }
+  std::memcpy(&value, in.data() + offset, sizeof(T));
+  offset += sizeof(T);
+  return true;
+}
+
+} // namespace
+
+std::vector<uint8_t> CameraSettings::serialize() const {
+  std::vector<uint8_t> out(std::begin(kMagic), std::end(kMagic));
+  put(out, kVersion);
+  put(out, fields);
+  put(out, exposure);
+  put(out, static_cast<uint8_t>(autoExposure));
+  put(out, gain);
+  put(out, frameRate);
+  for (double ratio : whiteBalance) {
+    put(out, ratio);
+  }
+  put(out, static_cast<uint8_t>(autoWhiteBalance));
+  put(out, static_cast<int32_t>(pixelFormat));
+  put(out, brightness);
+  put(out, static_cast<int32_t>(binMode));
+  put(out, static_cast<int32_t>(horzBin));
+  put(out, static_cast<int32_t>(vertBin));
+  return out;
+}
+
+bool CameraSettings::deserialize(const std::vector<uint8_t> &data,
+                                 CameraSettings &out) {
+  if (data.size() < sizeof(kMagic) ||
+      std::memcmp(data.data(), kMagic, sizeof(kMagic)) != 0) {
+    return false;
+  }
+
+  size_t offset = sizeof(kMagic);
+  uint32_t version;
+  if (!get(data, offset, version) || version != kVersion) {
+    return false;
+  }
+
+  CameraSettings settings;
+  uint8_t autoExposure, autoWhiteBalance;
+  int32_t pixelFormat, binMode, horzBin, vertBin;
+  bool ok = get(data, offset, settings.fields) &&
+            get(data, offset, settings.exposure) &&
+            get(data, offset, autoExposure) &&
+            get(data, offset, settings.gain) &&
+            get(data, offset, settings.frameRate) &&
+            get(data, offset, settings.whiteBalance[0]) &&
+            get(data, offset, settings.whiteBalance[1]) &&
+            get(data, offset, settings.whiteBalance[2]) &&
+            get(data, offset, autoWhiteBalance) &&
+            get(data, offset, pixelFormat) &&
+            get(data, offset, settings.brightness) &&
+            get(data, offset, binMode) && get(data, offset, horzBin) &&
+            get(data, offset, vertBin);
+  if (!ok) {
+    return false;
+  }
+
+  settings.autoExposure = autoExposure != 0;
+  settings.autoWhiteBalance = autoWhiteBalance != 0;
+  settings.pixelFormat = pixelFormat;
+  settings.binMode = binMode;
+  settings.horzBin = horzBin;
+  settings.vertBin = vertBin;
+  out = settings;
+  return true;
+}
+
+bool CameraSettings::saveToFile(const std::string &path) const {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    BJNI_LOG_WARN("CameraSettings::saveToFile", "Cannot open " << path);
+    return false;
+  }
+  std::vector<uint8_t> data = serialize();
+  file.write(reinterpret_cast<const char *>(data.data()), data.size());
+  return static_cast<bool>(file);
+}
+
+bool CameraSettings::loadFromFile(const std::string &path,
+                                  CameraSettings &out) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    BJNI_LOG_WARN("CameraSettings::loadFromFile", "Cannot open " << path);
+    return false;
+  }
+  std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)),
+                            std::istreambuf_iterator<char>());
+  return deserialize(data, out);
+}
+
+bool CameraSettings::isBinaryProfile(const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  char magic[sizeof(kMagic)] = {};
+  file.read(magic, sizeof(magic));
+  return file && std::memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+}
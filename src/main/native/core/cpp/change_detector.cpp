@@ -0,0 +1,90 @@
+#include "change_detector.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+uint64_t sumAbsDiff(const uint8_t *a, const uint8_t *b, size_t n) {
+  size_t i = 0;
+  uint64_t sum = 0;
+
+#if defined(__SSE2__)
+  __m128i acc = _mm_setzero_si128();
+  for (; i + 16 <= n; i += 16) {
+    __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+    __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+    // Two 64-bit partial sums per instruction, so acc cannot overflow.
+    acc = _mm_add_epi64(acc, _mm_sad_epu8(va, vb));
+  }
+  sum = static_cast<uint64_t>(_mm_cvtsi128_si64(acc)) +
+        static_cast<uint64_t>(_mm_cvtsi128_si64(_mm_unpackhi_epi64(acc, acc)));
+#elif defined(__ARM_NEON)
+  uint32x4_t acc = vdupq_n_u32(0);
+  for (; i + 16 <= n; i += 16) {
+    uint8x16_t diff = vabdq_u8(vld1q_u8(a + i), vld1q_u8(b + i));
+    // Each 32-bit lane gains at most 4 * 255 per step, far from overflowing
+    // at any realistic grid size.
+    acc = vpadalq_u16(acc, vpaddlq_u8(diff));
+  }
+  sum = static_cast<uint64_t>(vgetq_lane_u32(acc, 0)) + vgetq_lane_u32(acc, 1) +
+        vgetq_lane_u32(acc, 2) + vgetq_lane_u32(acc, 3);
+#endif
+
+  for (; i < n; i++) {
+    sum += static_cast<uint64_t>(std::abs(int(a[i]) - int(b[i])));
+  }
+  return sum;
+}
+
+ChangeDetector::ChangeDetector(const ChangeDetectorConfig &config)
+    : cfg(config) {
+  cfg.gridStep = std::max((cfg.gridStep + 1) & ~1, 2);
+}
+
+double ChangeDetector::measure(const uint8_t *data, int width, int height,
+                               size_t stride, int pixelBytes, int lumaOffset) {
+  int step = cfg.gridStep;
+  gridCols = width / step;
+  gridRows = height / step;
+  current.resize(static_cast<size_t>(gridCols) * gridRows);
+
+  size_t columnStride = static_cast<size_t>(step) * pixelBytes;
+  uint8_t *out = current.data();
+  for (int gy = 0; gy < gridRows; gy++) {
+    const uint8_t *src =
+        data + static_cast<size_t>(gy) * step * stride + lumaOffset;
+    for (int gx = 0; gx < gridCols; gx++) {
+      *out++ = src[gx * columnStride];
+    }
+  }
+
+  if (current.empty() || gridCols != referenceCols ||
+      gridRows != referenceRows) {
+    return -1.0;
+  }
+  return static_cast<double>(
+             sumAbsDiff(current.data(), reference.data(), current.size())) /
+         current.size();
+}
+
+void ChangeDetector::accept() {
+  reference.swap(current);
+  referenceCols = gridCols;
+  referenceRows = gridRows;
+  suppressedRun = 0;
+}
+
+bool ChangeDetector::shouldSuppress(double score) {
+  if (cfg.suppressBelow < 0 || score < 0 || score >= cfg.suppressBelow) {
+    return false;
+  }
+  if (cfg.maxSuppressed > 0 && suppressedRun >= cfg.maxSuppressed) {
+    return false;
+  }
+  suppressedRun++;
+  return true;
+}
@@ -0,0 +1,199 @@
+#include "conversion_pool.hpp"
+#include "native_log.hpp"
+#include "thread_scheduling.hpp"
+#include <algorithm>
+#include <pthread.h>
+#include <string>
+
+ConversionPool &ConversionPool::instance() {
+  // Intentionally leaked so no worker join runs during static destruction
+  // while the JVM is unloading the library.
+  static ConversionPool *pool = new ConversionPool();
+  return *pool;
+}
+
+ConversionPool::ConversionPool() {
+  int hw = static_cast<int>(std::thread::hardware_concurrency());
+  configuredThreads = std::clamp(hw - 1, 0, 4);
+}
+
+void ConversionPool::configure(int threads, const std::vector<int> &cpus,
+                               int stripeRows) {
+  std::lock_guard<std::mutex> configLock(configMutex);
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    configuredThreads = std::max(threads, 0);
+    configuredCpus = cpus;
+    minStripeRows = std::max(stripeRows, 1);
+  }
+  stopWorkers();
+
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!started) {
+    startWorkersLocked();
+  }
+}
+
+void ConversionPool::shutdown() {
+  std::lock_guard<std::mutex> configLock(configMutex);
+  stopWorkers();
+}
+
+int ConversionPool::threadCount() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return started ? static_cast<int>(workers.size()) : configuredThreads;
+}
+
+void ConversionPool::startWorkersLocked() {
+  stopping = false;
+  for (int i = 0; i < configuredThreads; i++) {
+    int cpu = configuredCpus.empty()
+                  ? -1
+                  : configuredCpus[i % configuredCpus.size()];
+    workers.emplace_back(&ConversionPool::workerLoop, this, i, cpu);
+  }
+  started = true;
+}
+
+void ConversionPool::stopWorkers() {
+  std::vector<std::thread> old;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+    started = false;
+    old.swap(workers);
+  }
+  workCv.notify_all();
+  for (auto &worker : old) {
+    worker.join();
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  stopping = false;
+}
+
+void ConversionPool::workerLoop(int index, int cpu) {
+  std::string name = "bjni-cvt-" + std::to_string(index);
+  pthread_setname_np(pthread_self(), name.c_str());
+
+  if (cpu >= 0) {
+    ThreadSchedule schedule;
+    schedule.cpus.push_back(cpu);
+    if (!applyThreadSchedule(schedule)) {
+      BJNI_LOG_WARN("ConversionPool::workerLoop",
+                    "Failed to pin worker " << index << " to CPU " << cpu);
+    }
+  }
+
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    workCv.wait(lock, [this] { return stopping || head != nullptr; });
+    if (stopping) {
+      return;
+    }
+
+    int rowBegin, rowEnd;
+    StripeJob *job = claimStripe(rowBegin, rowEnd);
+    if (!job) {
+      continue;
+    }
+
+    lock.unlock();
+    job->fn(job->ctx, rowBegin, rowEnd);
+    lock.lock();
+
+    if (++job->doneStripes == job->stripeCount) {
+      doneCv.notify_all();
+    }
+  }
+}
+
+void ConversionPool::run(StripeJob &job) {
+  std::unique_lock<std::mutex> lock(mutex);
+  if (!started && !stopping) {
+    // First frame after load: bring the pool up with the default size.
+    startWorkersLocked();
+  }
+
+  int participants = static_cast<int>(workers.size()) + 1;
+  // Two stripes per participant smooths out uneven stripe cost without
+  // making the per-stripe locking noticeable.
+  int target = (job.rows + participants * 2 - 1) / (participants * 2);
+  int align = std::max(job.rowAlign, 1);
+  job.stripeRows = std::max(target, minStripeRows);
+  // Round up to the alignment (even rows by default, for 4:2:x formats).
+  job.stripeRows = (job.stripeRows + align - 1) / align * align;
+  job.stripeCount = (job.rows + job.stripeRows - 1) / job.stripeRows;
+  job.nextStripe = 0;
+  job.doneStripes = 0;
+  job.next = nullptr;
+
+  if (workers.empty() || job.stripeCount <= 1) {
+    lock.unlock();
+    job.fn(job.ctx, 0, job.rows);
+    return;
+  }
+
+  StripeJob **tail = &head;
+  while (*tail) {
+    tail = &(*tail)->next;
+  }
+  *tail = &job;
+  if (!cursor) {
+    cursor = &job;
+  }
+  workCv.notify_all();
+
+  int rowBegin, rowEnd;
+  while (claimOwnStripe(job, rowBegin, rowEnd)) {
+    lock.unlock();
+    job.fn(job.ctx, rowBegin, rowEnd);
+    lock.lock();
+    job.doneStripes++;
+  }
+
+  doneCv.wait(lock, [&job] { return job.doneStripes == job.stripeCount; });
+}
+
+StripeJob *ConversionPool::claimStripe(int &rowBegin, int &rowEnd) {
+  StripeJob *job = cursor ? cursor : head;
+  if (!job) {
+    return nullptr;
+  }
+  // Rotate before claiming so the next worker serves the next camera.
+  cursor = job->next ? job->next : head;
+  takeStripe(*job, rowBegin, rowEnd);
+  return job;
+}
+
+bool ConversionPool::claimOwnStripe(StripeJob &job, int &rowBegin,
+                                    int &rowEnd) {
+  if (job.nextStripe >= job.stripeCount) {
+    return false;
+  }
+  takeStripe(job, rowBegin, rowEnd);
+  return true;
+}
+
+void ConversionPool::takeStripe(StripeJob &job, int &rowBegin, int &rowEnd) {
+  rowBegin = job.nextStripe * job.stripeRows;
+  rowEnd = std::min(rowBegin + job.stripeRows, job.rows);
+  if (++job.nextStripe == job.stripeCount) {
+    // Fully claimed jobs leave the queue; stragglers finish via doneStripes.
+    unlinkJob(job);
+  }
+}
+
+void ConversionPool::unlinkJob(StripeJob &job) {
+  StripeJob **link = &head;
+  while (*link && *link != &job) {
+    link = &(*link)->next;
+  }
+  if (*link) {
+    *link = job.next;
+  }
+  if (cursor == &job) {
+    cursor = job.next ? job.next : head;
+  }
+  job.next = nullptr;
+}
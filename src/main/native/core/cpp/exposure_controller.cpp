@@ -0,0 +1,51 @@
+#include "exposure_controller.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Bounds the integral term to one maximum step's worth of correction per
+// unit of ki, so a long saturated stretch can't wind it up.
+constexpr double kIntegralLimit = 4.0;
+
+} // namespace
+
+ExposureController::ExposureController(const ExposureControllerConfig &config)
+    : config(config) {}
+
+void ExposureController::setConfig(const ExposureControllerConfig &newConfig) {
+  config = newConfig;
+}
+
+void ExposureController::reset() { integral = 0.0; }
+
+ExposureController::Output ExposureController::step(double meanLuma,
+                                                    double exposureUs,
+                                                    double gain) {
+  double error = std::log(config.targetLuma / std::max(meanLuma, 1.0));
+  integral = std::clamp(integral + error, -kIntegralLimit, kIntegralLimit);
+
+  double maxLogStep = std::log(std::max(config.maxStepRatio, 1.0));
+  double correction = std::clamp(config.kp * error + config.ki * integral,
+                                 -maxLogStep, maxLogStep);
+
+  // Brightness scales with exposure times linear gain.
+  double total = exposureUs * std::pow(10.0, gain / 20.0) *
+                 std::exp(correction);
+
+  Output out;
+  out.exposureUs =
+      std::clamp(total, config.minExposureUs, config.maxExposureUs);
+  double gainDb = 20.0 * std::log10(total / out.exposureUs);
+  out.gain = std::clamp(gainDb, config.minGain, config.maxGain);
+
+  bool saturated = (out.exposureUs == config.maxExposureUs &&
+                    out.gain == config.maxGain && error > 0) ||
+                   (out.exposureUs == config.minExposureUs &&
+                    out.gain == config.minGain && error < 0);
+  if (saturated) {
+    // Stop integrating while the output can't follow.
+    integral -= error;
+  }
+  return out;
+}
@@ -0,0 +1,113 @@
+#include "exposure_fusion.hpp"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+void fuseExposureSpan(const uint8_t *shortPixels, const uint8_t *longPixels,
+                      uint8_t *out, size_t n, int knee,
+                      const uint8_t *highlights) {
+  size_t i = 0;
+
+#if defined(__SSE2__) || defined(__ARM_NEON)
+#if defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i kneeV = _mm_set1_epi8(static_cast<char>(knee));
+#else
+  const uint8x16_t kneeV = vdupq_n_u8(static_cast<uint8_t>(knee));
+#endif
+  for (; i + 16 <= n; i += 16) {
+    // Most of a frame sits below the knee, where the output is the long
+    // exposure unchanged.
+#if defined(__SSE2__)
+    __m128i l8 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(longPixels + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), l8);
+    __m128i over = _mm_subs_epu8(l8, kneeV);
+    bool anyOver = _mm_movemask_epi8(_mm_cmpeq_epi8(over, zero)) != 0xFFFF;
+#else
+    uint8x16_t l8 = vld1q_u8(longPixels + i);
+    vst1q_u8(out + i, l8);
+    uint64x2_t over = vreinterpretq_u64_u8(vqsubq_u8(l8, kneeV));
+    bool anyOver = (vgetq_lane_u64(over, 0) | vgetq_lane_u64(over, 1)) != 0;
+#endif
+    if (!anyOver) {
+      continue;
+    }
+    for (size_t j = i; j < i + 16; j++) {
+      int l = longPixels[j];
+      if (l > knee) {
+        out[j] = highlights[(l - knee - 1) * 256 + shortPixels[j]];
+      }
+    }
+  }
+#endif
+
+  for (; i < n; i++) {
+    int l = longPixels[i];
+    out[i] = l <= knee
+                 ? static_cast<uint8_t>(l)
+                 : highlights[(l - knee - 1) * 256 + shortPixels[i]];
+  }
+}
+
+ExposureFusion::ExposureFusion(double exposureRatio, int knee) {
+  kneeLevel = std::clamp(knee, 0, 253);
+  this->exposureRatio = exposureRatio >= 1.0 ? exposureRatio : 1.0;
+  double r = this->exposureRatio;
+  // Reach full short weight by 255.
+  int slope = (128 + (255 - kneeLevel) - 1) / (255 - kneeLevel);
+
+  // Shoulder knee + c * log(1 + (E - knee) / c): slope 1 at the knee, and c
+  // chosen so the brightest radiance, 255r, lands on 255.
+  double headroom = 255.0 - kneeLevel;
+  double span = 255.0 * r - kneeLevel;
+  double c = 0;
+  if (span - headroom >= 0.5) {
+    auto shoulder = [&](double c) { return c * std::log1p(span / c); };
+    double lo = 0;
+    double hi = headroom;
+    while (shoulder(hi) < headroom) {
+      hi *= 2;
+    }
+    for (int step = 0; step < 60; step++) {
+      double mid = (lo + hi) / 2;
+      (shoulder(mid) < headroom ? lo : hi) = mid;
+    }
+    c = hi;
+  }
+
+  highlights.resize(static_cast<size_t>(255 - kneeLevel) * 256);
+  for (int l = kneeLevel + 1; l <= 255; l++) {
+    double a = std::min((l - kneeLevel) * slope, 128) / 128.0;
+    for (int s = 0; s < 256; s++) {
+      double radiance = l * (1 - a) + s * r * a;
+      double toned = radiance;
+      if (c > 0 && radiance > kneeLevel) {
+        toned = kneeLevel + c * std::log1p((radiance - kneeLevel) / c);
+      }
+      highlights[(l - kneeLevel - 1) * 256 + s] =
+          static_cast<uint8_t>(std::clamp(std::lround(toned), 0L, 255L));
+    }
+  }
+}
+
+void ExposureFusion::fuseSpan(const uint8_t *shortPixels,
+                              const uint8_t *longPixels, uint8_t *out,
+                              size_t n) const {
+  fuseExposureSpan(shortPixels, longPixels, out, n, kneeLevel,
+                   highlights.data());
+}
+
+void ExposureFusion::fuseRows(const cv::Mat &shortFrame,
+                              const cv::Mat &longFrame, cv::Mat &out,
+                              int rowBegin, int rowEnd) const {
+  size_t rowBytes = longFrame.cols * longFrame.elemSize();
+  for (int row = rowBegin; row < rowEnd; row++) {
+    fuseSpan(shortFrame.ptr<uint8_t>(row), longFrame.ptr<uint8_t>(row),
+             out.ptr<uint8_t>(row), rowBytes);
+  }
+}
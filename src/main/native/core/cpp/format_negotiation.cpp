@@ -0,0 +1,100 @@
+#include "format_negotiation.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+
+namespace {
+
+// Relative fps difference treated as noise between candidates.
+constexpr double kTieFraction = 0.02;
+
+bool fitsIntent(const FormatCandidate &candidate, int intent) {
+  switch (intent) {
+  case kOutputGray:
+    return !candidate.color;
+  case kOutputBgr:
+  case kOutputHsvMask:
+    return candidate.color;
+  default:
+    return true;
+  }
+}
+
+std::string formatFps(double fps) {
+  if (fps == std::numeric_limits<double>::infinity()) {
+    return "unbounded";
+  }
+  char text[32];
+  std::snprintf(text, sizeof(text), "%.1f fps", fps);
+  return text;
+}
+
+} // namespace
+
+NegotiationResult negotiateFormat(const NegotiationInput &input) {
+  NegotiationResult result;
+  const double unbounded = std::numeric_limits<double>::infinity();
+  double pixels = static_cast<double>(input.width) * input.height;
+
+  bool anyFits = std::any_of(
+      input.candidates.begin(), input.candidates.end(),
+      [&](const FormatCandidate &c) { return fitsIntent(c, input.intent); });
+  if (!anyFits && !input.candidates.empty()) {
+    result.reasoning += input.intent == kOutputGray
+                            ? "No mono format; considering colour formats.\n"
+                            : "No colour format; considering mono formats.\n";
+  }
+
+  double bestFps = -1.0;
+  for (size_t i = 0; i < input.candidates.size(); i++) {
+    const FormatCandidate &candidate = input.candidates[i];
+    if (anyFits && !fitsIntent(candidate, input.intent)) {
+      result.reasoning += candidate.name + ": skipped, wrong output type\n";
+      continue;
+    }
+
+    double sensorFps = input.sensorMaxFps > 0 ? input.sensorMaxFps : unbounded;
+    double linkFps =
+        input.linkBytesPerSecond > 0 && pixels > 0
+            ? input.linkBytesPerSecond / (pixels * candidate.bytesPerPixel)
+            : unbounded;
+    double hostFps =
+        candidate.convertNs > 0 ? 1e9 / candidate.convertNs : unbounded;
+    double fps = std::min({sensorFps, linkFps, hostFps});
+    const char *limit = fps == sensorFps ? "sensor"
+                        : fps == linkFps ? "link"
+                                         : "conversion";
+
+    char line[160];
+    std::snprintf(line, sizeof(line),
+                  ": %.0f B/px, link %s, convert %.2f ms (%s) -> %s, "
+                  "%s-bound\n",
+                  candidate.bytesPerPixel, formatFps(linkFps).c_str(),
+                  candidate.convertNs / 1e6, formatFps(hostFps).c_str(),
+                  formatFps(fps).c_str(), limit);
+    result.reasoning += candidate.name + line;
+
+    bool better = false;
+    if (result.chosen < 0 || fps > bestFps * (1.0 + kTieFraction)) {
+      better = true;
+    } else if (fps >= bestFps * (1.0 - kTieFraction)) {
+      const FormatCandidate &best = input.candidates[result.chosen];
+      better = candidate.bytesPerPixel < best.bytesPerPixel ||
+               (candidate.bytesPerPixel == best.bytesPerPixel &&
+                candidate.convertNs < best.convertNs);
+    }
+    if (better) {
+      result.chosen = static_cast<int>(i);
+      bestFps = fps;
+    }
+  }
+
+  if (result.chosen < 0) {
+    result.reasoning += "No deliverable pixel format.";
+  } else {
+    result.estimatedFps = bestFps;
+    result.reasoning += "Chose " + input.candidates[result.chosen].name +
+                        " at " + formatFps(bestFps) + ".";
+  }
+  return result;
+}
@@ -0,0 +1,182 @@
+#include "frame_conversion.hpp"
+#include "conversion_pool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <opencv2/imgproc.hpp>
+
+namespace {
+
+int64_t steadyNowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+struct ConvertStripe {
+  const cv::Mat *src;
+  cv::Mat *dst;
+  int colorCvt;
+  // Optional mask output, filled from each stripe while it is still hot.
+  const ThresholdStage *threshold = nullptr;
+  cv::Mat *mask = nullptr;
+};
+
+// Converts rows [rowBegin, rowEnd) of src into the matching rows of dst.
+// Every conversion except demosaicing is row-local, so stripes are
+// independent.
+void convertStripe(void *ctx, int rowBegin, int rowEnd) {
+  auto *stripe = static_cast<ConvertStripe *>(ctx);
+  cv::Mat dstRows = stripe->dst->rowRange(rowBegin, rowEnd);
+  if (stripe->colorCvt == -1) {
+    stripe->src->rowRange(rowBegin, rowEnd).copyTo(dstRows);
+  } else if (isBayerConversion(stripe->colorCvt)) {
+    // Demosaicing reads the neighbouring rows, so convert a margin around
+    // the stripe and keep only its own rows. Stripes start on even rows and
+    // the margin is even, so the Bayer phase is unchanged.
+    constexpr int kMargin = 2;
+    thread_local cv::Mat padded;
+    int top = std::max(rowBegin - kMargin, 0);
+    int bottom = std::min(rowEnd + kMargin, stripe->src->rows);
+    cv::cvtColor(stripe->src->rowRange(top, bottom), padded, stripe->colorCvt);
+    padded.rowRange(rowBegin - top, rowEnd - top).copyTo(dstRows);
+  } else {
+    cv::cvtColor(stripe->src->rowRange(rowBegin, rowEnd), dstRows,
+                 stripe->colorCvt);
+  }
+  if (stripe->threshold) {
+    stripe->threshold->processRows(*stripe->dst, *stripe->mask, rowBegin,
+                                   rowEnd);
+  }
+}
+
+struct UndistortStripe {
+  const UndistortStage *stage;
+  const cv::Mat *src;
+  cv::Mat *dst;
+  int colorCvt;
+  const ThresholdStage *threshold = nullptr;
+  cv::Mat *mask = nullptr;
+};
+
+// Undistorts rows [rowBegin, rowEnd) of dst. For per-pixel formats the
+// colour swap runs on the remapped rows, so each grab buffer pixel is only
+// read once.
+void undistortStripe(void *ctx, int rowBegin, int rowEnd) {
+  auto *stripe = static_cast<UndistortStripe *>(ctx);
+  stripe->stage->remapRows(*stripe->src, *stripe->dst, rowBegin, rowEnd);
+  if (stripe->colorCvt != -1) {
+    cv::Mat dstRows = stripe->dst->rowRange(rowBegin, rowEnd);
+    cv::cvtColor(dstRows, dstRows, stripe->colorCvt);
+  }
+  if (stripe->threshold) {
+    stripe->threshold->processRows(*stripe->dst, *stripe->mask, rowBegin,
+                                   rowEnd);
+  }
+}
+
+struct FuseStripe {
+  const ExposureFusion *fusion;
+  const cv::Mat *shortFrame;
+  const cv::Mat *longFrame;
+  cv::Mat *dst;
+};
+
+void fuseStripe(void *ctx, int rowBegin, int rowEnd) {
+  auto *stripe = static_cast<FuseStripe *>(ctx);
+  stripe->fusion->fuseRows(*stripe->shortFrame, *stripe->longFrame,
+                           *stripe->dst, rowBegin, rowEnd);
+}
+
+} // namespace
+
+bool isBayerConversion(int colorCvt) {
+  return colorCvt == cv::COLOR_BayerBG2BGR ||
+         colorCvt == cv::COLOR_BayerGB2BGR ||
+         colorCvt == cv::COLOR_BayerRG2BGR || colorCvt == cv::COLOR_BayerGR2BGR;
+}
+
+int convertedType(int cvType, int colorCvt) {
+  return colorCvt == -1 ? cvType : CV_8UC3;
+}
+
+void convertFrame(const cv::Mat &raw, int colorCvt, cv::Mat &dst,
+                  cv::Mat *mask, const ConversionStages &stages,
+                  cv::Mat &scratch) {
+  // The threshold runs inside the final stripe pass, on rows that were just
+  // written, so stripes must cover whole mask rows.
+  const ThresholdStage *threshold = stages.threshold;
+  int rowAlign = 2;
+  if (threshold) {
+    rowAlign = std::max(rowAlign, threshold->config().downsample);
+  }
+
+  if (stages.undistort) {
+    stages.undistort->prepare(stages.geometry);
+
+    UndistortStripe remap{stages.undistort, &raw, &dst, colorCvt, threshold,
+                          mask};
+    if (raw.type() == CV_8UC2 || isBayerConversion(colorCvt)) {
+      // Packed YUV and Bayer have to be converted before they can be
+      // resampled.
+      scratch.create(raw.rows, raw.cols, CV_8UC3);
+      ConvertStripe convert{&raw, &scratch, colorCvt};
+      StripeJob convertJob;
+      convertJob.fn = convertStripe;
+      convertJob.ctx = &convert;
+      convertJob.rows = raw.rows;
+      ConversionPool::instance().run(convertJob);
+
+      remap.src = &scratch;
+      remap.colorCvt = -1;
+    }
+
+    StripeJob job;
+    job.fn = undistortStripe;
+    job.ctx = &remap;
+    job.rows = raw.rows;
+    job.rowAlign = rowAlign;
+    ConversionPool::instance().run(job);
+  } else {
+    ConvertStripe stripe{&raw, &dst, colorCvt, threshold, mask};
+    StripeJob job;
+    job.fn = convertStripe;
+    job.ctx = &stripe;
+    job.rows = raw.rows;
+    job.rowAlign = rowAlign;
+    ConversionPool::instance().run(job);
+  }
+
+  if (threshold) {
+    threshold->finish(*mask);
+  }
+}
+
+void fuseFrames(const ExposureFusion &fusion, const cv::Mat &shortFrame,
+                const cv::Mat &longFrame, cv::Mat &dst) {
+  FuseStripe stripe{&fusion, &shortFrame, &longFrame, &dst};
+  StripeJob job;
+  job.fn = fuseStripe;
+  job.ctx = &stripe;
+  job.rows = dst.rows;
+  ConversionPool::instance().run(job);
+}
+
+double measureConversionNs(int cvType, int colorCvt, int width, int height) {
+  cv::Mat src(height, width, cvType);
+  cv::randu(src, 0, 256);
+  cv::Mat dst(height, width, convertedType(cvType, colorCvt));
+  ConvertStripe stripe{&src, &dst, colorCvt};
+
+  int64_t best = std::numeric_limits<int64_t>::max();
+  for (int i = 0; i < 3; i++) {
+    StripeJob job;
+    job.fn = convertStripe;
+    job.ctx = &stripe;
+    job.rows = height;
+    int64_t start = steadyNowNs();
+    ConversionPool::instance().run(job);
+    best = std::min(best, steadyNowNs() - start);
+  }
+  return static_cast<double>(best);
+}
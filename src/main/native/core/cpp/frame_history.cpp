@@ -0,0 +1,129 @@
+#include "frame_history.hpp"
+#include <algorithm>
+#include <cstring>
+#include <opencv2/imgproc.hpp>
+
+FrameHistory::FrameHistory(int capacity, size_t slotBytes)
+    : slotCount(std::max(capacity, 1)), slotBytes(slotBytes),
+      storage(new uint8_t[slotCount * slotBytes]),
+      slots(new Slot[slotCount]) {
+  for (int i = 0; i < slotCount; i++) {
+    slots[i].data = storage.get() + i * slotBytes;
+  }
+}
+
+bool FrameHistory::push(const FrameMetadata &metadata, const cv::Mat &frame,
+                        int colorCvt) {
+  uint64_t sequence = metadata.sequence;
+  size_t rowBytes = frame.cols * frame.elemSize();
+  if (rowBytes * frame.rows > slotBytes) {
+    return false;
+  }
+
+  Slot &slot = slots[sequence % slotCount];
+  uint64_t version = slot.version.load(std::memory_order_relaxed);
+  slot.version.store(version + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  slot.sequence.store(sequence, std::memory_order_relaxed);
+  slot.metadata = metadata;
+  slot.rows = frame.rows;
+  slot.cols = frame.cols;
+  slot.type = frame.type();
+  slot.colorCvt = colorCvt;
+  if (frame.isContinuous()) {
+    std::memcpy(slot.data, frame.data, rowBytes * frame.rows);
+  } else {
+    for (int row = 0; row < frame.rows; row++) {
+      std::memcpy(slot.data + row * rowBytes, frame.ptr(row), rowBytes);
+    }
+  }
+
+  slot.version.store(version + 2, std::memory_order_release);
+  newestSequence.store(sequence, std::memory_order_release);
+  storedCount.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+bool FrameHistory::read(uint64_t sequence, cv::Mat &out,
+                        FrameMetadata *metadata) const {
+  if (sequence == 0) {
+    return false;
+  }
+  const Slot &slot = slots[sequence % slotCount];
+
+  // A few retries cover a writer that was mid-update; beyond that the slot
+  // is being recycled and the frame is gone anyway.
+  for (int attempt = 0; attempt < 3; attempt++) {
+    uint64_t version = slot.version.load(std::memory_order_acquire);
+    if (version & 1) {
+      continue;
+    }
+    if (slot.sequence.load(std::memory_order_relaxed) != sequence) {
+      return false;
+    }
+
+    int rows = slot.rows, cols = slot.cols, type = slot.type;
+    int colorCvt = slot.colorCvt;
+    FrameMetadata slotMetadata = slot.metadata;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.version.load(std::memory_order_relaxed) != version) {
+      continue;
+    }
+
+    // The header is consistent, so the copy below stays inside the slot.
+    cv::Mat raw(rows, cols, type);
+    std::memcpy(raw.data, slot.data, raw.total() * raw.elemSize());
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.version.load(std::memory_order_relaxed) != version) {
+      continue;
+    }
+
+    if (colorCvt == -1) {
+      out = raw;
+    } else {
+      cv::cvtColor(raw, out, colorCvt);
+    }
+    if (metadata) {
+      *metadata = slotMetadata;
+    }
+    return true;
+  }
+  return false;
+}
+
+bool FrameHistory::readMetadata(uint64_t sequence,
+                                FrameMetadata &metadata) const {
+  if (sequence == 0) {
+    return false;
+  }
+  const Slot &slot = slots[sequence % slotCount];
+
+  for (int attempt = 0; attempt < 3; attempt++) {
+    uint64_t version = slot.version.load(std::memory_order_acquire);
+    if (version & 1) {
+      continue;
+    }
+    if (slot.sequence.load(std::memory_order_relaxed) != sequence) {
+      return false;
+    }
+    FrameMetadata slotMetadata = slot.metadata;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.version.load(std::memory_order_relaxed) == version) {
+      metadata = slotMetadata;
+      return true;
+    }
+  }
+  return false;
+}
+
+uint64_t FrameHistory::newest() const {
+  return newestSequence.load(std::memory_order_acquire);
+}
+
+uint64_t FrameHistory::oldest() const {
+  uint64_t newestSeq = newest();
+  uint64_t held = std::min<uint64_t>(
+      storedCount.load(std::memory_order_relaxed), slotCount);
+  return held == 0 ? 0 : newestSeq - held + 1;
+}
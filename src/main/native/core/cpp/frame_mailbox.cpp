@@ -0,0 +1,38 @@
+#include "frame_mailbox.hpp"
+#include <utility>
+
+void FrameMailbox::publish(PublishedFrame published) {
+  uint64_t sequence = published.metadata.sequence;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    // Swap so the previous frame is released outside the lock.
+    std::swap(current, published);
+  }
+  // Readers that see the new sequence also see the frame behind it.
+  newestSequence.store(sequence, std::memory_order_release);
+}
+
+PublishedFrame FrameMailbox::latest() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return current;
+}
+
+std::shared_ptr<cv::Mat> FrameMailbox::frame() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return current.frame;
+}
+
+std::shared_ptr<cv::Mat> FrameMailbox::mask() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return current.mask;
+}
+
+bool FrameMailbox::metadataFor(uint64_t sequence,
+                               FrameMetadata &metadata) const {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!current.frame || current.metadata.sequence != sequence) {
+    return false;
+  }
+  metadata = current.metadata;
+  return true;
+}
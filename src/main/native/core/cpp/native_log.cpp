@@ -0,0 +1,273 @@
+#include "native_log.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <pthread.h>
+#include <string>
+
+namespace {
+
+constexpr int64_t kRateWindowNs = 1000000000;
+// How long the log thread sleeps when the ring is empty. Producers never
+// wake it, so this bounds how late a record can appear.
+constexpr auto kDrainInterval = std::chrono::milliseconds(20);
+
+int64_t steadyNowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+int64_t wallNowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+void copyTruncated(char *dst, size_t capacity, const char *src) {
+  size_t length = src ? std::min(std::strlen(src), capacity - 1) : 0;
+  std::memcpy(dst, src, length);
+  dst[length] = '\0';
+}
+
+const char *levelName(LogLevel level) {
+  switch (level) {
+  case kLogTrace:
+    return "TRACE";
+  case kLogDebug:
+    return "DEBUG";
+  case kLogInfo:
+    return "INFO";
+  case kLogWarn:
+    return "WARN";
+  default:
+    return "ERROR";
+  }
+}
+
+// The sink used until Java takes over: the same "[site] message" lines as
+// before, but one write and one flush per batch instead of per line.
+void writeToStdout(const LogRecord *records, size_t count) {
+  std::string text;
+  for (size_t i = 0; i < count; i++) {
+    const LogRecord &record = records[i];
+    text += '[';
+    text += record.site;
+    text += "] ";
+    if (record.level != kLogInfo) {
+      text += levelName(record.level);
+      text += ": ";
+    }
+    text += record.message;
+    if (record.suppressed > 0) {
+      text += " (" + std::to_string(record.suppressed) +
+              " similar suppressed)";
+    }
+    text += '\n';
+  }
+  std::fwrite(text.data(), 1, text.size(), stdout);
+  std::fflush(stdout);
+}
+
+} // namespace
+
+bool LogSite::admit(uint32_t &suppressed) {
+  int limit = NativeLog::instance().rateLimit();
+  if (limit <= 0) {
+    suppressed = suppressedCount.exchange(0, std::memory_order_relaxed);
+    return true;
+  }
+
+  int64_t now = steadyNowNs();
+  int64_t start = windowStartNs.load(std::memory_order_relaxed);
+  if (now - start >= kRateWindowNs &&
+      windowStartNs.compare_exchange_strong(start, now,
+                                            std::memory_order_relaxed)) {
+    // Only the thread that moved the window resets it; a record racing
+    // with the reset may land in either window, which is close enough.
+    windowCount.store(0, std::memory_order_relaxed);
+  }
+
+  if (windowCount.fetch_add(1, std::memory_order_relaxed) >=
+      static_cast<uint32_t>(limit)) {
+    suppressedCount.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  suppressed = suppressedCount.exchange(0, std::memory_order_relaxed);
+  return true;
+}
+
+LogMessage::LogMessage() : out(this) {
+  setp(buffer, buffer + sizeof(buffer) - 1);
+}
+
+LogMessage &LogMessage::begin() {
+  thread_local LogMessage message;
+  message.setp(message.buffer, message.buffer + sizeof(message.buffer) - 1);
+  // Undo anything a previous message left behind, e.g. std::hex.
+  message.out.clear();
+  message.out.flags(std::ios_base::dec | std::ios_base::skipws);
+  message.out.precision(6);
+  message.out.width(0);
+  message.out.fill(' ');
+  return message;
+}
+
+const char *LogMessage::text() {
+  *pptr() = '\0';
+  return buffer;
+}
+
+LogMessage::int_type LogMessage::overflow(int_type ch) {
+  // Full: drop the rest of the message but keep the stream usable.
+  return traits_type::not_eof(ch);
+}
+
+NativeLog &NativeLog::instance() {
+  // Intentionally leaked, like ConversionPool: logging may still happen
+  // while the library is being unloaded.
+  static NativeLog *log = new NativeLog();
+  return *log;
+}
+
+NativeLog::NativeLog() : cells(new Cell[kCapacity]) {
+  for (size_t i = 0; i < kCapacity; i++) {
+    cells[i].sequence.store(i, std::memory_order_relaxed);
+  }
+  batch.reserve(kBatchSize + 1);
+}
+
+void NativeLog::setLevel(LogLevel level) {
+  minLevel.store(std::clamp<int>(level, kLogTrace, kLogOff));
+}
+
+void NativeLog::setRateLimit(int perSecond) {
+  maxPerSecond.store(std::max(perSecond, 0));
+}
+
+bool NativeLog::push(LogLevel level, const char *site, const char *message,
+                     uint32_t suppressed) {
+  if (!running.load(std::memory_order_acquire)) {
+    startThread();
+  }
+
+  // Bounded MPMC queue after Dmitry Vyukov: a cell is free for position pos
+  // when its sequence equals pos, and holds a record once it is pos + 1.
+  size_t pos = enqueuePos.load(std::memory_order_relaxed);
+  Cell *cell;
+  while (true) {
+    cell = &cells[pos % kCapacity];
+    size_t sequence = cell->sequence.load(std::memory_order_acquire);
+    intptr_t diff =
+        static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+    if (diff == 0) {
+      if (enqueuePos.compare_exchange_weak(pos, pos + 1,
+                                           std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      droppedTotal.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    } else {
+      pos = enqueuePos.load(std::memory_order_relaxed);
+    }
+  }
+
+  LogRecord &record = cell->record;
+  record.timeNs = wallNowNs();
+  record.level = level;
+  record.suppressed = suppressed;
+  copyTruncated(record.site, sizeof(record.site), site);
+  copyTruncated(record.message, sizeof(record.message), message);
+  cell->sequence.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+size_t NativeLog::drainBatch() {
+  batch.clear();
+  while (batch.size() < kBatchSize) {
+    Cell &cell = cells[dequeuePos % kCapacity];
+    if (cell.sequence.load(std::memory_order_acquire) != dequeuePos + 1) {
+      break;
+    }
+    batch.push_back(cell.record);
+    cell.sequence.store(dequeuePos + kCapacity, std::memory_order_release);
+    dequeuePos++;
+  }
+
+  uint64_t droppedNow = droppedTotal.load(std::memory_order_relaxed);
+  if (droppedNow != droppedReported) {
+    LogRecord notice;
+    notice.timeNs = wallNowNs();
+    notice.level = kLogWarn;
+    copyTruncated(notice.site, sizeof(notice.site), "NativeLog");
+    auto count = static_cast<unsigned long long>(droppedNow - droppedReported);
+    std::snprintf(notice.message, sizeof(notice.message),
+                  "Log ring full, records dropped: %llu", count);
+    batch.push_back(notice);
+    droppedReported = droppedNow;
+  }
+
+  if (!batch.empty()) {
+    if (sink) {
+      sink(batch.data(), batch.size());
+    } else {
+      writeToStdout(batch.data(), batch.size());
+    }
+  }
+  return batch.size();
+}
+
+void NativeLog::setSink(LogSink newSink) {
+  std::lock_guard<std::mutex> lock(drainMutex);
+  // Whatever is queued was logged under the old sink.
+  while (drainBatch() > 0) {
+  }
+  sink = std::move(newSink);
+}
+
+void NativeLog::flush() {
+  std::lock_guard<std::mutex> lock(drainMutex);
+  while (drainBatch() > 0) {
+  }
+}
+
+void NativeLog::startThread() {
+  std::lock_guard<std::mutex> lock(threadMutex);
+  if (running.load()) {
+    return;
+  }
+  if (thread.joinable()) {
+    thread.join();
+  }
+  stopping = false;
+  thread = std::thread(&NativeLog::drainLoop, this);
+  running = true;
+}
+
+void NativeLog::shutdown() {
+  {
+    std::lock_guard<std::mutex> lock(threadMutex);
+    stopping = true;
+    if (thread.joinable()) {
+      thread.join();
+    }
+    running = false;
+  }
+  flush();
+}
+
+void NativeLog::drainLoop() {
+  pthread_setname_np(pthread_self(), "bjni-log");
+  while (!stopping.load(std::memory_order_relaxed)) {
+    size_t moved;
+    {
+      std::lock_guard<std::mutex> lock(drainMutex);
+      moved = drainBatch();
+    }
+    if (moved < kBatchSize) {
+      std::this_thread::sleep_for(kDrainInterval);
+    }
+  }
+}
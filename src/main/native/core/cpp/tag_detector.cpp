@@ -0,0 +1,133 @@
+#include "tag_detector.hpp"
+#include <algorithm>
+#include <cmath>
+#include <opencv2/imgproc.hpp>
+
+namespace {
+
+// Pixels per bit cell when sampling a tag for its decision margin.
+constexpr int kCellPixels = 4;
+
+// aruco reports corners clockwise from the top left; AprilTag starts at the
+// bottom left and goes counter-clockwise.
+constexpr int kAprilTagCornerOrder[4] = {3, 2, 1, 0};
+
+cv::aruco::Dictionary dictionaryFor(int family) {
+  switch (family) {
+  case kTag25h9:
+    return cv::aruco::getPredefinedDictionary(cv::aruco::DICT_APRILTAG_25h9);
+  case kTag16h5:
+    return cv::aruco::getPredefinedDictionary(cv::aruco::DICT_APRILTAG_16h5);
+  default:
+    return cv::aruco::getPredefinedDictionary(cv::aruco::DICT_APRILTAG_36h11);
+  }
+}
+
+cv::aruco::DetectorParameters detectorParameters(bool refineHere) {
+  cv::aruco::DetectorParameters params;
+  // When decimating, corners are refined on the full-resolution frame below
+  // instead, where sub-pixel refinement actually gains precision.
+  params.cornerRefinementMethod = refineHere
+                                      ? cv::aruco::CORNER_REFINE_APRILTAG
+                                      : cv::aruco::CORNER_REFINE_NONE;
+  return params;
+}
+
+} // namespace
+
+TagDetector::TagDetector(const TagDetectorConfig &config)
+    : cfg(config), detector(dictionaryFor(config.family),
+                            detectorParameters(config.decimate <= 1)) {
+  cfg.decimate = std::clamp(cfg.decimate, 1, 8);
+  markerBits = detector.getDictionary().markerSize;
+}
+
+void TagDetector::detect(const cv::Mat &frame, std::vector<TagDetection> &out) {
+  out.clear();
+  if (frame.empty()) {
+    return;
+  }
+
+  if (frame.channels() == 1) {
+    gray = frame;
+  } else {
+    cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
+  }
+
+  corners.clear();
+  ids.clear();
+  if (cfg.decimate > 1) {
+    cv::resize(gray, decimated, cv::Size(), 1.0 / cfg.decimate,
+               1.0 / cfg.decimate, cv::INTER_AREA);
+    detector.detectMarkers(decimated, corners, ids);
+
+    float scale = static_cast<float>(cfg.decimate);
+    for (auto &quad : corners) {
+      for (auto &corner : quad) {
+        corner *= scale;
+      }
+      cv::cornerSubPix(
+          gray, quad, cv::Size(cfg.decimate + 1, cfg.decimate + 1),
+          cv::Size(-1, -1),
+          cv::TermCriteria(cv::TermCriteria::EPS + cv::TermCriteria::COUNT,
+                           20, 0.05));
+    }
+  } else {
+    detector.detectMarkers(gray, corners, ids);
+  }
+
+  out.reserve(ids.size());
+  for (size_t i = 0; i < ids.size(); i++) {
+    float margin = decisionMargin(gray, corners[i]);
+    if (margin < cfg.minDecisionMargin) {
+      continue;
+    }
+
+    TagDetection detection;
+    detection.id = ids[i];
+    detection.decisionMargin = margin;
+    for (int c = 0; c < 4; c++) {
+      detection.corners[c * 2] = corners[i][kAprilTagCornerOrder[c]].x;
+      detection.corners[c * 2 + 1] = corners[i][kAprilTagCornerOrder[c]].y;
+    }
+    out.push_back(detection);
+  }
+}
+
+float TagDetector::decisionMargin(const cv::Mat &image,
+                                  const std::vector<cv::Point2f> &quad) {
+  // Bit grid plus the one-cell black border.
+  int cells = markerBits + 2;
+  float side = static_cast<float>(cells * kCellPixels);
+  cv::Point2f square[4] = {{0, 0}, {side, 0}, {side, side}, {0, side}};
+  cv::Point2f source[4] = {quad[0], quad[1], quad[2], quad[3]};
+  cv::warpPerspective(image, warped, cv::getPerspectiveTransform(source, square),
+                      cv::Size(cells * kCellPixels, cells * kCellPixels),
+                      cv::INTER_LINEAR);
+
+  // Average the centre of each cell, away from blurred cell edges.
+  std::vector<float> means(cells * cells);
+  float black = 255.0f;
+  float white = 0.0f;
+  int inset = kCellPixels / 4;
+  int span = kCellPixels - inset * 2;
+  for (int cy = 0; cy < cells; cy++) {
+    for (int cx = 0; cx < cells; cx++) {
+      cv::Rect cell(cx * kCellPixels + inset, cy * kCellPixels + inset, span,
+                    span);
+      float mean = static_cast<float>(cv::mean(warped(cell))[0]);
+      means[cy * cells + cx] = mean;
+      black = std::min(black, mean);
+      white = std::max(white, mean);
+    }
+  }
+
+  float threshold = (black + white) * 0.5f;
+  float margin = white - black;
+  for (int cy = 1; cy < cells - 1; cy++) {
+    for (int cx = 1; cx < cells - 1; cx++) {
+      margin = std::min(margin, std::abs(means[cy * cells + cx] - threshold));
+    }
+  }
+  return margin;
+}
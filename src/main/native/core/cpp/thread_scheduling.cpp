@@ -0,0 +1,73 @@
+#include "thread_scheduling.hpp"
+#include "native_log.hpp"
+#include <cstring>
+#include <sched.h>
+#include <unistd.h>
+
+bool applyThreadSchedule(const ThreadSchedule &schedule) {
+  bool ok = true;
+  pthread_t self = pthread_self();
+
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (schedule.cpus.empty()) {
+    long cpuCount = sysconf(_SC_NPROCESSORS_CONF);
+    for (long cpu = 0; cpu < cpuCount && cpu < CPU_SETSIZE; cpu++) {
+      CPU_SET(cpu, &set);
+    }
+  } else {
+    for (int cpu : schedule.cpus) {
+      if (cpu >= 0 && cpu < CPU_SETSIZE) {
+        CPU_SET(cpu, &set);
+      }
+    }
+  }
+
+  int err = pthread_setaffinity_np(self, sizeof(set), &set);
+  if (err != 0) {
+    BJNI_LOG_WARN("applyThreadSchedule",
+                  "Failed to set CPU affinity: " << std::strerror(err));
+    ok = false;
+  }
+
+  sched_param param{};
+  int policy = SCHED_OTHER;
+  if (schedule.fifoPriority > 0) {
+    policy = SCHED_FIFO;
+    param.sched_priority = schedule.fifoPriority;
+  }
+
+  err = pthread_setschedparam(self, policy, &param);
+  if (err != 0) {
+    BJNI_LOG_WARN("applyThreadSchedule",
+                  "Failed to set scheduling policy (priority "
+                      << schedule.fifoPriority << "): " << std::strerror(err));
+    ok = false;
+  }
+
+  return ok;
+}
+
+EffectiveThreadSchedule currentThreadSchedule() {
+  EffectiveThreadSchedule effective;
+  pthread_t self = pthread_self();
+
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (pthread_getaffinity_np(self, sizeof(set), &set) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+      if (CPU_ISSET(cpu, &set)) {
+        effective.cpus.push_back(cpu);
+      }
+    }
+  }
+
+  sched_param param{};
+  int policy;
+  if (pthread_getschedparam(self, &policy, &param) == 0) {
+    effective.policy = policy;
+    effective.priority = param.sched_priority;
+  }
+
+  return effective;
+}
@@ -0,0 +1,78 @@
+#include "threshold_stage.hpp"
+#include <algorithm>
+#include <opencv2/imgproc.hpp>
+
+namespace {
+
+// Rows per block at full resolution. Eight BGR rows of a 1920 px frame plus
+// their HSV copy come to ~90 KB, which stays in L2.
+constexpr int kBlockRows = 8;
+
+} // namespace
+
+ThresholdStage::ThresholdStage(const ThresholdConfig &config) : cfg(config) {
+  int factor = cfg.downsample;
+  cfg.downsample = factor >= 8 ? 8 : factor >= 4 ? 4 : factor >= 2 ? 2 : 1;
+  if (cfg.morphology != 0) {
+    int size = std::max(cfg.morphKernel | 1, 1);
+    morphKernel =
+        cv::getStructuringElement(cv::MORPH_RECT, cv::Size(size, size));
+  }
+}
+
+cv::Size ThresholdStage::maskSize(cv::Size frameSize) const {
+  return cv::Size(frameSize.width / cfg.downsample,
+                  frameSize.height / cfg.downsample);
+}
+
+void ThresholdStage::processRows(const cv::Mat &frame, cv::Mat &mask,
+                                 int rowBegin, int rowEnd) const {
+  thread_local cv::Mat small;
+  thread_local cv::Mat hsv;
+  thread_local cv::Mat wrapped;
+
+  int factor = cfg.downsample;
+  // Keep blocks aligned to whole mask rows.
+  int blockRows = std::max(kBlockRows / factor, 1) * factor;
+  int maskCols = frame.cols / factor;
+  int lastRow = std::min(rowEnd, mask.rows * factor);
+
+  for (int row = rowBegin; row < lastRow; row += blockRows) {
+    int rows = std::min(blockRows, lastRow - row);
+    cv::Mat block = frame(cv::Rect(0, row, maskCols * factor, rows));
+    cv::Mat maskRows = mask.rowRange(row / factor, (row + rows) / factor);
+
+    const cv::Mat *input = &block;
+    if (factor > 1) {
+      cv::resize(block, small, maskRows.size(), 0, 0, cv::INTER_AREA);
+      input = &small;
+    }
+
+    if (input->channels() == 1) {
+      cv::inRange(*input, cv::Scalar(cfg.valLow), cv::Scalar(cfg.valHigh),
+                  maskRows);
+      continue;
+    }
+
+    cv::cvtColor(*input, hsv, cv::COLOR_BGR2HSV);
+    if (cfg.hueLow <= cfg.hueHigh) {
+      cv::inRange(hsv, cv::Scalar(cfg.hueLow, cfg.satLow, cfg.valLow),
+                  cv::Scalar(cfg.hueHigh, cfg.satHigh, cfg.valHigh), maskRows);
+    } else {
+      // Wrapping hue: [hueLow, 180] or [0, hueHigh].
+      cv::inRange(hsv, cv::Scalar(cfg.hueLow, cfg.satLow, cfg.valLow),
+                  cv::Scalar(180, cfg.satHigh, cfg.valHigh), maskRows);
+      cv::inRange(hsv, cv::Scalar(0, cfg.satLow, cfg.valLow),
+                  cv::Scalar(cfg.hueHigh, cfg.satHigh, cfg.valHigh), wrapped);
+      cv::bitwise_or(maskRows, wrapped, maskRows);
+    }
+  }
+}
+
+void ThresholdStage::finish(cv::Mat &mask) const {
+  if (cfg.morphology == 1) {
+    cv::morphologyEx(mask, mask, cv::MORPH_OPEN, morphKernel);
+  } else if (cfg.morphology == 2) {
+    cv::morphologyEx(mask, mask, cv::MORPH_CLOSE, morphKernel);
+  }
+}
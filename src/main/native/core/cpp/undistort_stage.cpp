@@ -0,0 +1,53 @@
+#include "undistort_stage.hpp"
+#include <opencv2/calib3d.hpp>
+#include <opencv2/imgproc.hpp>
+
+UndistortStage::UndistortStage(const cv::Mat &cameraMatrix,
+                               const cv::Mat &distCoeffs,
+                               const FrameGeometry &calibration)
+    : calibration(calibration) {
+  cameraMatrix.convertTo(this->cameraMatrix, CV_64F);
+  distCoeffs.convertTo(this->distCoeffs, CV_64F);
+}
+
+cv::Mat UndistortStage::cameraMatrixFor(const FrameGeometry &geometry) const {
+  // Calibration pixel -> unbinned sensor pixel -> frame pixel.
+  double scaleX = static_cast<double>(calibration.binH) / geometry.binH;
+  double scaleY = static_cast<double>(calibration.binV) / geometry.binV;
+  double shiftX = static_cast<double>(calibration.offsetX) * calibration.binH /
+                      geometry.binH -
+                  geometry.offsetX;
+  double shiftY = static_cast<double>(calibration.offsetY) * calibration.binV /
+                      geometry.binV -
+                  geometry.offsetY;
+
+  cv::Mat adjusted = cameraMatrix.clone();
+  adjusted.at<double>(0, 0) *= scaleX;
+  adjusted.at<double>(0, 1) *= scaleX;
+  adjusted.at<double>(0, 2) = adjusted.at<double>(0, 2) * scaleX + shiftX;
+  adjusted.at<double>(1, 1) *= scaleY;
+  adjusted.at<double>(1, 2) = adjusted.at<double>(1, 2) * scaleY + shiftY;
+  return adjusted;
+}
+
+void UndistortStage::prepare(const FrameGeometry &geometry) {
+  if (geometry == prepared && !map1.empty()) {
+    return;
+  }
+
+  cv::Mat adjusted = cameraMatrixFor(geometry);
+  cv::initUndistortRectifyMap(adjusted, distCoeffs, cv::Mat(), adjusted,
+                              cv::Size(geometry.width, geometry.height),
+                              CV_16SC2, map1, map2);
+  prepared = geometry;
+}
+
+void UndistortStage::remapRows(const cv::Mat &src, cv::Mat &dst, int rowBegin,
+                               int rowEnd) const {
+  cv::Mat dstRows = dst.rowRange(rowBegin, rowEnd);
+  // The maps hold absolute source coordinates, so a row slice of the maps
+  // produces exactly those output rows.
+  cv::remap(src, dstRows, map1.rowRange(rowBegin, rowEnd),
+            map2.rowRange(rowBegin, rowEnd), cv::INTER_LINEAR,
+            cv::BORDER_CONSTANT);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * The subset of camera settings this library writes, recorded as they are
+ * applied so they can be saved in a compact binary profile and restored in
+ * one call.
+ */
+struct CameraSettings {
+    enum Field : uint32_t {
+        kExposure = 1u << 0,
+        kAutoExposure = 1u << 1,
+        kGain = 1u << 2,
+        kFrameRate = 1u << 3,
+        kWhiteBalance = 1u << 4,
+        kAutoWhiteBalance = 1u << 5,
+        kPixelFormat = 1u << 6,
+        kBrightness = 1u << 7,
+        kBinning = 1u << 8,
+    };
+
+    // Bitmask of Field values that hold a recorded setting.
+    uint32_t fields = 0;
+
+    double exposure = 0.0;
+    bool autoExposure = false;
+    double gain = 0.0;
+    double frameRate = 0.0;
+    std::array<double, 3> whiteBalance{};
+    bool autoWhiteBalance = false;
+    int pixelFormat = 0;
+    double brightness = 0.0;
+    int binMode = 0;
+    int horzBin = 1;
+    int vertBin = 1;
+
+    bool has(Field field) const { return (fields & field) != 0; }
+
+    std::vector<uint8_t> serialize() const;
+    static bool deserialize(const std::vector<uint8_t>& data, CameraSettings& out);
+
+    bool saveToFile(const std::string& path) const;
+    static bool loadFromFile(const std::string& path, CameraSettings& out);
+
+    /** True if the file starts with the binary profile magic. */
+    static bool isBinaryProfile(const std::string& path);
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Indices into the array returned by BaslerJNI.getCameraStats. These are part
+ * of the Java API, so only ever append new entries before kStatCount.
+ */
+enum CameraStat : int {
+    kStatOpenTimeMs = 0,
+    kStatFramesGrabbed,
+    kStatGrabFailures,
+    kStatGrabTimeouts,
+    kStatDisconnects,
+    kStatReconnects,
+    kStatLastReconnectMs,
+    // Stream grabber counters, -1 where the transport does not provide them.
+    kStatResendRequests,
+    kStatResendPackets,
+    kStatBufferUnderruns,
+    kStatFailedBuffers,
+    kStatTotalBuffers,
+    kStatMissedFrames,
+    kStatResyncs,
+    // Host-side drops: frames replaced by a newer one before the app took
+    // them, and block IDs that never arrived at all.
+    kStatFramesSkipped,
+    kStatBlockIdGaps,
+    // Frames dropped by change detection because nothing moved.
+    kStatFramesSuppressed,
+    kStatCount
+};
+
+/** Per-camera counters, updated lock-free from the grab path. */
+struct CameraStats {
+    std::atomic<double> openTimeMs{0.0};
+    std::atomic<uint64_t> framesGrabbed{0};
+    std::atomic<uint64_t> grabFailures{0};
+    std::atomic<uint64_t> grabTimeouts{0};
+    std::atomic<uint64_t> disconnects{0};
+    std::atomic<uint64_t> reconnects{0};
+    std::atomic<double> lastReconnectMs{0.0};
+    std::atomic<uint64_t> framesSkipped{0};
+    std::atomic<uint64_t> blockIdGaps{0};
+    std::atomic<uint64_t> framesSuppressed{0};
+
+    std::array<double, kStatCount> snapshot() const {
+        std::array<double, kStatCount> values{};
+        values[kStatOpenTimeMs] = openTimeMs.load(std::memory_order_relaxed);
+        values[kStatFramesGrabbed] = static_cast<double>(framesGrabbed.load(std::memory_order_relaxed));
+        values[kStatGrabFailures] = static_cast<double>(grabFailures.load(std::memory_order_relaxed));
+        values[kStatGrabTimeouts] = static_cast<double>(grabTimeouts.load(std::memory_order_relaxed));
+        values[kStatDisconnects] = static_cast<double>(disconnects.load(std::memory_order_relaxed));
+        values[kStatReconnects] = static_cast<double>(reconnects.load(std::memory_order_relaxed));
+        values[kStatLastReconnectMs] = lastReconnectMs.load(std::memory_order_relaxed);
+        for (int i = kStatResendRequests; i <= kStatResyncs; i++) {
+            values[i] = -1.0;
+        }
+        values[kStatFramesSkipped] = static_cast<double>(framesSkipped.load(std::memory_order_relaxed));
+        values[kStatBlockIdGaps] = static_cast<double>(blockIdGaps.load(std::memory_order_relaxed));
+        values[kStatFramesSuppressed] = static_cast<double>(framesSuppressed.load(std::memory_order_relaxed));
+        return values;
+    }
+};
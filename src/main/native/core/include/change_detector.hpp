@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/** Settings for ChangeDetector, see CameraInstance::configureChangeDetection. */
+struct ChangeDetectorConfig {
+    // Sample every Nth pixel of every Nth row. Rounded up to even so Bayer
+    // and 4:2:2 frames always sample the same component.
+    int gridStep = 8;
+    // Frames scoring below this are not published, -1 never suppresses.
+    double suppressBelow = -1.0;
+    // Publish anyway after this many consecutive suppressed frames, so
+    // consumers still see a heartbeat. 0 suppresses indefinitely.
+    int maxSuppressed = 30;
+};
+
+/**
+ * Cheap frame-to-frame change measure: the mean absolute difference of a
+ * subsampled luma grid, in grey levels (0-255).
+ *
+ * The grid is gathered straight from the raw grab buffer, so a frame can be
+ * judged before any conversion work is spent on it. Scores are measured
+ * against the last accepted frame rather than simply the previous one, so a
+ * slow drift still adds up to a change while frames are being suppressed.
+ */
+class ChangeDetector {
+  public:
+    explicit ChangeDetector(const ChangeDetectorConfig& config);
+
+    const ChangeDetectorConfig& config() const { return cfg; }
+
+    /**
+     * Sample a frame and score it against the reference.
+     *
+     * @param pixelBytes Bytes per pixel in the buffer.
+     * @param lumaOffset Offset of the luma (or green) byte within a pixel.
+     * @return The score, or -1 if there is no comparable reference yet.
+     */
+    double measure(const uint8_t* data, int width, int height, size_t stride, int pixelBytes,
+                   int lumaOffset);
+
+    /** Make the last measured frame the reference for the next ones. */
+    void accept();
+
+    /** Whether a frame with this score should be dropped; counts suppressions. */
+    bool shouldSuppress(double score);
+
+  private:
+    ChangeDetectorConfig cfg;
+    std::vector<uint8_t> reference;
+    std::vector<uint8_t> current;
+    int gridCols = 0;
+    int gridRows = 0;
+    int referenceCols = 0;
+    int referenceRows = 0;
+    int suppressedRun = 0;
+};
+
+/** Sum of |a[i] - b[i]| over n bytes, using SSE2 or NEON where available. */
+uint64_t sumAbsDiff(const uint8_t* a, const uint8_t* b, size_t n);
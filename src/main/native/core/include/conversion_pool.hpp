@@ -0,0 +1,88 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * A unit of striped work submitted to the ConversionPool.
+ *
+ * Jobs live on the submitting thread's stack and are linked into the pool's
+ * queue intrusively, so running a job never allocates. Everything except
+ * fn/ctx/rows/rowAlign is bookkeeping owned by the pool and guarded by its
+ * mutex.
+ */
+struct StripeJob {
+    void (*fn)(void* ctx, int rowBegin, int rowEnd) = nullptr;
+    void* ctx = nullptr;
+    int rows = 0;
+    // Every stripe except the last starts and ends on a multiple of this.
+    int rowAlign = 2;
+
+    int stripeRows = 0;
+    int stripeCount = 0;
+    int nextStripe = 0;
+    int doneStripes = 0;
+    StripeJob* next = nullptr;
+};
+
+/**
+ * Process-wide pool of persistent worker threads used to split per-frame
+ * conversion work into row stripes.
+ *
+ * All CameraInstances share one pool. Workers hand out stripes round-robin
+ * across every queued job, so a large sensor cannot starve another camera's
+ * frame. The submitting thread always works on its own job as well, which
+ * keeps a job progressing even when the pool has no workers.
+ */
+class ConversionPool {
+  public:
+    static ConversionPool& instance();
+
+    /**
+     * Resize the pool. Safe to call while cameras are grabbing.
+     *
+     * @param threads Worker count, 0 runs every job on the calling thread.
+     * @param cpus CPUs to pin workers to (assigned round-robin), empty leaves
+     * them unpinned.
+     * @param minStripeRows Smallest stripe height worth handing to a worker.
+     */
+    void configure(int threads, const std::vector<int>& cpus, int minStripeRows);
+
+    /** Stop all workers. The next run() restarts them with the last config. */
+    void shutdown();
+
+    /** Run job.fn over [0, job.rows) and return once every stripe is done. */
+    void run(StripeJob& job);
+
+    int threadCount();
+
+  private:
+    ConversionPool();
+
+    void startWorkersLocked();
+    void stopWorkers();
+    void workerLoop(int index, int cpu);
+
+    StripeJob* claimStripe(int& rowBegin, int& rowEnd);
+    bool claimOwnStripe(StripeJob& job, int& rowBegin, int& rowEnd);
+    void takeStripe(StripeJob& job, int& rowBegin, int& rowEnd);
+    void unlinkJob(StripeJob& job);
+
+    std::mutex configMutex;
+    std::mutex mutex;
+    std::condition_variable workCv;
+    std::condition_variable doneCv;
+
+    StripeJob* head = nullptr;
+    StripeJob* cursor = nullptr;
+
+    std::vector<std::thread> workers;
+    bool stopping = false;
+    bool started = false;
+
+    int configuredThreads;
+    std::vector<int> configuredCpus;
+    int minStripeRows = 64;
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+/** Limits and gains for ExposureController. */
+struct ExposureControllerConfig {
+    // Desired mean luma, 0-255.
+    double targetLuma = 110.0;
+    double kp = 0.6;
+    double ki = 0.1;
+    // Largest brightness change per step, as a ratio (1.5 = +/-50%).
+    double maxStepRatio = 1.5;
+    double minExposureUs = 10.0;
+    double maxExposureUs = 10000.0;
+    // Gain in dB.
+    double minGain = 0.0;
+    double maxGain = 0.0;
+};
+
+/**
+ * PI controller that drives mean luma towards a target by adjusting exposure
+ * first and gain only once exposure is at its limit.
+ *
+ * It works on log brightness, so the same error produces the same relative
+ * correction in dark and bright scenes.
+ */
+class ExposureController {
+  public:
+    struct Output {
+        double exposureUs;
+        double gain;
+    };
+
+    explicit ExposureController(const ExposureControllerConfig& config = {});
+
+    void setConfig(const ExposureControllerConfig& config);
+    /** Compute the next exposure and gain from a measurement taken with the current ones. */
+    Output step(double meanLuma, double exposureUs, double gain);
+    void reset();
+
+  private:
+    ExposureControllerConfig config;
+    double integral = 0.0;
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Single-scale exposure fusion of a short and a long exposure of the same
+ * scene, for mixed lighting where no single exposure holds both the bright
+ * and the dark regions.
+ *
+ * The short value is first scaled by the exposure ratio r (long / short) so
+ * both frames measure radiance in long-exposure units. Until the long value
+ * nears saturation it is used as is, then the estimate blends linearly into
+ * the scaled short value by 255:
+ *
+ *   a = clamp((long - knee) * slope, 0, 128) / 128
+ *   E = long * (1 - a) + short * r * a
+ *
+ * E spans 0..255r, so a tone curve maps it back to 8 bits: identity up to
+ * the knee, then a logarithmic shoulder with slope 1 at the knee that reaches
+ * 255 at 255r. Output is therefore monotonic in scene radiance.
+ *
+ * Output below the knee is the long value itself, the common case handled
+ * 16 bytes at a time with SSE2/NEON. Pixels above the knee come from a table
+ * over (long, short) built once per configuration.
+ */
+class ExposureFusion {
+  public:
+    /**
+     * exposureRatio: long exposure time over short, at least 1.
+     * knee: long-exposure level (0-253) where blending towards short starts.
+     */
+    explicit ExposureFusion(double exposureRatio, int knee = 200);
+
+    int knee() const { return kneeLevel; }
+    double ratio() const { return exposureRatio; }
+
+    /** Fuse n bytes of a short and a long exposure into out. */
+    void fuseSpan(const uint8_t* shortPixels, const uint8_t* longPixels, uint8_t* out,
+                  size_t n) const;
+
+    /** Fuse rows [rowBegin, rowEnd) of two equally sized 8-bit frames into out. */
+    void fuseRows(const cv::Mat& shortFrame, const cv::Mat& longFrame, cv::Mat& out, int rowBegin,
+                  int rowEnd) const;
+
+  private:
+    int kneeLevel;
+    double exposureRatio;
+    // Fused output for long in (knee, 255], indexed (long - knee - 1) * 256 + short.
+    std::vector<uint8_t> highlights;
+};
+
+/**
+ * The fusion kernel over n bytes; see ExposureFusion. highlights is the
+ * (255 - knee) x 256 table of outputs for long values above the knee.
+ */
+void fuseExposureSpan(const uint8_t* shortPixels, const uint8_t* longPixels, uint8_t* out, size_t n,
+                      int knee, const uint8_t* highlights);
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+/** What the caller will do with frames. Mirrored in BaslerJNI.OUTPUT_*. */
+enum OutputIntent : int {
+    kOutputBgr = 0,
+    kOutputGray = 1,
+    // BGR frames feeding the fused HSV threshold.
+    kOutputHsvMask = 2,
+    // Anything viewable; favours the lightest format on ties.
+    kOutputPreview = 3,
+};
+
+/** A camera pixel format the library can deliver, with its measured cost. */
+struct FormatCandidate {
+    std::string name;
+    // Code accepted by CameraInstance::setPixelFormat.
+    int libraryFormat = -1;
+    double bytesPerPixel = 1.0;
+    // Delivered as BGR rather than mono.
+    bool color = false;
+    // Host time to turn one frame into the delivered format, in ns.
+    double convertNs = 0.0;
+};
+
+struct NegotiationInput {
+    int width = 0;
+    int height = 0;
+    // Usable link bandwidth in bytes/s, <= 0 if unknown.
+    double linkBytesPerSecond = 0.0;
+    // Fastest the sensor can run at the current settings, <= 0 if unknown.
+    double sensorMaxFps = 0.0;
+    int intent = kOutputBgr;
+    std::vector<FormatCandidate> candidates;
+};
+
+struct NegotiationResult {
+    // Index into candidates, -1 if none fits.
+    int chosen = -1;
+    double estimatedFps = 0.0;
+    // One line per candidate plus the verdict, for logs and the Java caller.
+    std::string reasoning;
+};
+
+/**
+ * Pick the candidate with the highest sustainable frame rate, the minimum
+ * of what the sensor, the link and host conversion allow. Candidates within
+ * 2% of the best count as a tie, broken by fewer bytes on the wire and then
+ * cheaper conversion. Intents that need colour (or mono) only fall back to
+ * the other kind when the camera has nothing else.
+ */
+NegotiationResult negotiateFormat(const NegotiationInput& input);
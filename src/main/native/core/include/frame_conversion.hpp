@@ -0,0 +1,42 @@
+#pragma once
+
+#include "exposure_fusion.hpp"
+#include "threshold_stage.hpp"
+#include "undistort_stage.hpp"
+#include <opencv2/core.hpp>
+
+/** True if colorCvt is one of the Bayer demosaicing codes. */
+bool isBayerConversion(int colorCvt);
+
+/** OpenCV type of the delivered frame for a raw type and cvtColor code. */
+int convertedType(int cvType, int colorCvt);
+
+/** Optional per-frame stages applied while converting; null skips a stage. */
+struct ConversionStages {
+    const ThresholdStage* threshold = nullptr;
+    UndistortStage* undistort = nullptr;
+    // Geometry of the raw frame, only used by undistort.
+    FrameGeometry geometry;
+};
+
+/**
+ * Convert a raw frame into dst, split into row stripes across the shared
+ * ConversionPool.
+ *
+ * @param raw The raw frame, typically wrapping a grab buffer.
+ * @param colorCvt cv::cvtColor code applied to raw, -1 for a plain copy.
+ * @param dst Output, already allocated with convertedType() and raw's size.
+ * @param mask Threshold mask output sized by ThresholdStage::maskSize, or
+ * null when stages.threshold is null.
+ * @param scratch Reused between frames for formats that must be converted
+ * before they can be undistorted.
+ */
+void convertFrame(const cv::Mat& raw, int colorCvt, cv::Mat& dst, cv::Mat* mask,
+                  const ConversionStages& stages, cv::Mat& scratch);
+
+/** Fuse a short/long exposure pair into dst across the ConversionPool. */
+void fuseFrames(const ExposureFusion& fusion, const cv::Mat& shortFrame,
+                const cv::Mat& longFrame, cv::Mat& dst);
+
+/** Times one full-frame conversion of random data, best of three, in ns. */
+double measureConversionNs(int cvType, int colorCvt, int width, int height);
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "frame_metadata.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <opencv2/core.hpp>
+
+/**
+ * Fixed-size ring of the most recent frames, for pulling out what the camera
+ * saw just before an event.
+ *
+ * All slot memory is allocated up front, so push() never allocates. Each slot
+ * is guarded by a seqlock: the single writer (the grabbing thread) never waits
+ * for readers, and a reader that races with an overwrite simply reports the
+ * frame as gone.
+ */
+class FrameHistory {
+  public:
+    /**
+     * @param capacity Number of frames kept.
+     * @param slotBytes Largest frame, in bytes, a slot can hold.
+     */
+    FrameHistory(int capacity, size_t slotBytes);
+
+    /**
+     * Store a frame under metadata.sequence. colorCvt is the cv::cvtColor
+     * code readers apply when the frame is stored unconverted, -1 if it is
+     * ready to use. Returns false if the frame does not fit in a slot. Only
+     * call from one thread.
+     */
+    bool push(const FrameMetadata& metadata, const cv::Mat& frame, int colorCvt);
+
+    /**
+     * Copy out the frame with the given sequence number. Returns false if it
+     * was never stored or has already been overwritten. Safe from any thread.
+     */
+    bool read(uint64_t sequence, cv::Mat& out, FrameMetadata* metadata = nullptr) const;
+
+    /** Like read, but only the metadata, without copying pixels. */
+    bool readMetadata(uint64_t sequence, FrameMetadata& metadata) const;
+
+    /** Sequence of the newest stored frame, 0 if none. */
+    uint64_t newest() const;
+    /** Sequence of the oldest frame still held, 0 if none. */
+    uint64_t oldest() const;
+
+    int capacity() const { return slotCount; }
+
+  private:
+    struct Slot {
+        // Odd while the writer is mid-update.
+        std::atomic<uint64_t> version{0};
+        std::atomic<uint64_t> sequence{0};
+        FrameMetadata metadata;
+        int rows = 0;
+        int cols = 0;
+        int type = 0;
+        int colorCvt = -1;
+        uint8_t* data = nullptr;
+    };
+
+    int slotCount;
+    size_t slotBytes;
+    std::unique_ptr<uint8_t[]> storage;
+    std::unique_ptr<Slot[]> slots;
+    std::atomic<uint64_t> newestSequence{0};
+    std::atomic<uint64_t> storedCount{0};
+};
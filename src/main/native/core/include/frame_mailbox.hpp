@@ -0,0 +1,51 @@
+#pragma once
+
+#include "frame_metadata.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace cv {
+class Mat;
+}
+
+/** Everything published for one frame. */
+struct PublishedFrame {
+    std::shared_ptr<cv::Mat> frame;
+    // Threshold mask, null unless a ThresholdStage is set.
+    std::shared_ptr<cv::Mat> mask;
+    FrameMetadata metadata;
+};
+
+/**
+ * Single-slot hand-off of the newest frame from the grab thread to readers.
+ *
+ * Published frames are never modified again, so readers just take a
+ * reference and the writer only ever waits for a pointer swap. A reader that
+ * holds on to a frame keeps it alive after newer ones are published.
+ */
+class FrameMailbox {
+  public:
+    /**
+     * Replace the newest frame. metadata.sequence must be greater than the
+     * previous one; only call from one thread.
+     */
+    void publish(PublishedFrame published);
+
+    /** The newest frame, all empty before the first publish. */
+    PublishedFrame latest() const;
+    std::shared_ptr<cv::Mat> frame() const;
+    std::shared_ptr<cv::Mat> mask() const;
+
+    /** Copy the newest frame's metadata if it has the given sequence. */
+    bool metadataFor(uint64_t sequence, FrameMetadata& metadata) const;
+
+    /** Sequence of the newest frame, 0 before the first publish. Lock-free. */
+    uint64_t sequence() const { return newestSequence.load(std::memory_order_acquire); }
+
+  private:
+    mutable std::mutex mutex;
+    PublishedFrame current;
+    std::atomic<uint64_t> newestSequence{0};
+};
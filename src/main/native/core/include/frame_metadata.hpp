@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Per-frame settings and timestamps, taken from the frame's chunk data when
+ * chunk mode is on so they match the frame exactly.
+ */
+struct FrameMetadata {
+    /** Bits of `fields` marking which chunk values were present. */
+    enum Field : uint32_t {
+        kExposure = 1 << 0,
+        kGain = 1 << 1,
+        kLineStatus = 1 << 2,
+        kFrameCounter = 1 << 3,
+        kChunkTimestamp = 1 << 4,
+        // changeScore was measured; not a chunk, set by ChangeDetector.
+        kChangeScore = 1 << 5,
+        // bracketIndex is known, see CameraInstance::configureExposureBracketing.
+        kBracketIndex = 1 << 6,
+    };
+
+    uint64_t sequence = 0;
+    // steady_clock time the frame was retrieved on the host.
+    int64_t hostTimestampNs = 0;
+    // Camera timestamp in device ticks; from the chunk if available,
+    // otherwise from the transport.
+    uint64_t cameraTimestamp = 0;
+    double exposureUs = -1.0;
+    double gain = -1.0;
+    int64_t lineStatus = 0;
+    int64_t frameCounter = 0;
+    uint32_t fields = 0;
+    // Mean luma difference to the last published frame, -1 if not measured.
+    double changeScore = -1.0;
+    // Index into the bracket's exposure list, -1 when not bracketing.
+    int bracketIndex = -1;
+};
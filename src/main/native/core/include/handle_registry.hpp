@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+
+/**
+ * Maps the opaque handles handed to Java onto the objects they name.
+ *
+ * Lookups return a shared_ptr, so an object stays alive for the rest of a
+ * native call even if Java destroys it concurrently. Objects are released
+ * outside the registry lock, so a slow destructor never blocks lookups of
+ * other handles.
+ */
+template <typename T> class HandleRegistry {
+  public:
+    /** Register object under its address and return that handle. */
+    int64_t add(const std::shared_ptr<T>& object) {
+        int64_t handle = reinterpret_cast<int64_t>(object.get());
+        std::lock_guard<std::mutex> lock(mutex);
+        objects[handle] = object;
+        return handle;
+    }
+
+    /** The object registered under handle, null if there is none. */
+    std::shared_ptr<T> find(int64_t handle) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = objects.find(handle);
+        return it != objects.end() ? it->second : nullptr;
+    }
+
+    void remove(int64_t handle) {
+        std::shared_ptr<T> removed;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = objects.find(handle);
+            if (it == objects.end()) {
+                return;
+            }
+            removed = std::move(it->second);
+            objects.erase(it);
+        }
+        // removed is released here, after unlocking.
+    }
+
+    void clear() {
+        std::map<int64_t, std::shared_ptr<T>> removed;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            removed.swap(objects);
+        }
+        // As in remove, the objects are released after unlocking.
+    }
+
+  private:
+    mutable std::mutex mutex;
+    std::map<int64_t, std::shared_ptr<T>> objects;
+};
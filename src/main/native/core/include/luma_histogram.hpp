@@ -0,0 +1,22 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <opencv2/core.hpp>
+
+/** 256-bin histogram of frame brightness. */
+struct LumaHistogram {
+    std::array<uint32_t, 256> bins{};
+    uint32_t samples = 0;
+
+    double mean() const;
+    /** Luma value below which `fraction` (0-1) of the samples lie. */
+    int percentile(double fraction) const;
+};
+
+/**
+ * Histogram the luma of roi (clipped to the frame), sampling every `step`-th
+ * pixel on every `step`-th row. Accepts CV_8UC1 and BGR CV_8UC3 frames; an
+ * empty roi covers the whole frame.
+ */
+void computeLumaHistogram(const cv::Mat& frame, cv::Rect roi, int step, LumaHistogram& out);
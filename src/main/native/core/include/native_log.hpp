@@ -0,0 +1,183 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <thread>
+#include <vector>
+
+/** Log severities. Mirrored in BaslerJNI.LOG_*. */
+enum LogLevel : int {
+    kLogTrace = 0,
+    kLogDebug,
+    kLogInfo,
+    kLogWarn,
+    kLogError,
+    // Disables logging when used as the minimum level.
+    kLogOff,
+};
+
+/** One log line as it travels through the ring. Fixed size, never allocates. */
+struct LogRecord {
+    static constexpr size_t kSiteBytes = 64;
+    static constexpr size_t kMessageBytes = 256;
+
+    // Wall-clock time, ns since the Unix epoch.
+    int64_t timeNs = 0;
+    LogLevel level = kLogInfo;
+    // Records the rate limit dropped at this call site since its last one.
+    uint32_t suppressed = 0;
+    char site[kSiteBytes] = {};
+    char message[kMessageBytes] = {};
+};
+
+/** Receives drained records in batches, on the log thread. */
+using LogSink = std::function<void(const LogRecord* records, size_t count)>;
+
+/**
+ * Per-call-site rate limiter, one static instance per BJNI_LOG statement.
+ *
+ * Each site may emit NativeLog::rateLimit() records per second; the rest are
+ * counted and the count is attached to the next record that gets through.
+ * Lock-free, and only reads the vDSO clock, so a call site firing on every
+ * frame costs a few atomics.
+ */
+class LogSite {
+  public:
+    /** Whether to emit now; suppressed receives the count dropped since the last one. */
+    bool admit(uint32_t& suppressed);
+
+  private:
+    std::atomic<int64_t> windowStartNs{0};
+    std::atomic<uint32_t> windowCount{0};
+    std::atomic<uint32_t> suppressedCount{0};
+};
+
+/**
+ * Formats a message into a fixed per-thread buffer, truncating instead of
+ * allocating.
+ */
+class LogMessage : private std::streambuf {
+  public:
+    /** The calling thread's message, emptied. */
+    static LogMessage& begin();
+
+    std::ostream& stream() { return out; }
+    const char* text();
+
+  private:
+    LogMessage();
+    int_type overflow(int_type ch) override;
+
+    char buffer[LogRecord::kMessageBytes];
+    std::ostream out;
+};
+
+/**
+ * Process-wide native log.
+ *
+ * Records go into a bounded lock-free ring (multi-producer, single
+ * consumer) and a background thread drains them in batches to the sink: by
+ * default one stdout write per batch, or the Java logger once forwarding is
+ * enabled over JNI. Producers never block, take no lock and make no
+ * syscalls; when the ring is full the record is dropped and the drop is
+ * reported once the ring has room again.
+ */
+class NativeLog {
+  public:
+    static NativeLog& instance();
+
+    bool enabled(LogLevel level) const {
+        return level >= minLevel.load(std::memory_order_relaxed);
+    }
+    void setLevel(LogLevel level);
+
+    /** Records per call site per second, 0 for unlimited. */
+    int rateLimit() const { return maxPerSecond.load(std::memory_order_relaxed); }
+    void setRateLimit(int perSecond);
+
+    /**
+     * Queue a record. Returns false, and counts it as dropped, if the ring is
+     * full. Safe from any thread.
+     */
+    bool push(LogLevel level, const char* site, const char* message, uint32_t suppressed = 0);
+
+    /** Replace the sink; null restores the stdout sink. Waits for a batch in flight. */
+    void setSink(LogSink sink);
+
+    /** Deliver everything queued so far before returning. */
+    void flush();
+
+    /** Flush and stop the log thread. The next push() restarts it. */
+    void shutdown();
+
+    /** Records lost to a full ring since startup. */
+    uint64_t dropped() const { return droppedTotal.load(std::memory_order_relaxed); }
+
+  private:
+    NativeLog();
+
+    struct Cell {
+        std::atomic<size_t> sequence{0};
+        LogRecord record;
+    };
+
+    void startThread();
+    void drainLoop();
+    // Moves up to one batch from the ring to the sink; returns records moved.
+    size_t drainBatch();
+
+    static constexpr size_t kCapacity = 1024;
+    static constexpr size_t kBatchSize = 64;
+
+    std::atomic<int> minLevel{kLogInfo};
+    std::atomic<int> maxPerSecond{5};
+
+    std::unique_ptr<Cell[]> cells;
+    std::atomic<size_t> enqueuePos{0};
+    // Consumer side, guarded by drainMutex.
+    size_t dequeuePos = 0;
+    std::vector<LogRecord> batch;
+    std::atomic<uint64_t> droppedTotal{0};
+    uint64_t droppedReported = 0;
+
+    std::mutex drainMutex;
+    LogSink sink;
+
+    std::mutex threadMutex;
+    std::thread thread;
+    std::atomic<bool> running{false};
+    std::atomic<bool> stopping{false};
+};
+
+/**
+ * Log a message built with stream syntax, rate limited per call site.
+ *
+ *   BJNI_LOG_WARN("CameraInstance::setGain", "Gain not writable: " << gain);
+ *
+ * The message is only formatted if the level is enabled and the call site
+ * is within its rate limit.
+ */
+#define BJNI_LOG(level, site, message)                                                    \
+    do {                                                                                  \
+        if (NativeLog::instance().enabled(level)) {                                       \
+            static LogSite bjniLogSite;                                                   \
+            uint32_t bjniSuppressed = 0;                                                  \
+            if (bjniLogSite.admit(bjniSuppressed)) {                                      \
+                LogMessage& bjniMessage = LogMessage::begin();                            \
+                bjniMessage.stream() << message;                                          \
+                NativeLog::instance().push(level, site, bjniMessage.text(), bjniSuppressed); \
+            }                                                                             \
+        }                                                                                 \
+    } while (0)
+
+#define BJNI_LOG_TRACE(site, message) BJNI_LOG(kLogTrace, site, message)
+#define BJNI_LOG_DEBUG(site, message) BJNI_LOG(kLogDebug, site, message)
+#define BJNI_LOG_INFO(site, message) BJNI_LOG(kLogInfo, site, message)
+#define BJNI_LOG_WARN(site, message) BJNI_LOG(kLogWarn, site, message)
+#define BJNI_LOG_ERROR(site, message) BJNI_LOG(kLogError, site, message)
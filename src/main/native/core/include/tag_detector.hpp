@@ -0,0 +1,71 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <opencv2/objdetect/aruco_detector.hpp>
+#include <cstdint>
+#include <vector>
+
+/** Tag family for TagDetector. Mirrored in BaslerJNI.TAG_FAMILY_*. */
+enum TagFamily : int {
+    kTag36h11 = 0,
+    kTag25h9 = 1,
+    kTag16h5 = 2,
+};
+
+struct TagDetectorConfig {
+    int family = kTag36h11;
+    // Detect on a frame shrunk by this factor, then refine the corners at full
+    // resolution. 1 disables decimation.
+    int decimate = 2;
+    // Drop detections whose decision margin is below this.
+    double minDecisionMargin = 0.0;
+};
+
+struct TagDetection {
+    int id = 0;
+    // Grey-level distance between the weakest data bit and the black/white
+    // threshold, comparable to AprilTag's decision margin.
+    float decisionMargin = 0.0f;
+    // x, y of each corner, counter-clockwise from the bottom left as seen in
+    // the image, matching the AprilTag library's ordering.
+    float corners[8] = {};
+};
+
+/** Detections of one frame, tagged with the frame they came from. */
+struct TagDetectionResult {
+    uint64_t sequence = 0;
+    int64_t hostTimestampNs = 0;
+    // Camera tick count, 0 without chunk metadata.
+    uint64_t cameraTimestamp = 0;
+    // Time spent detecting, from hand-off to publish.
+    int64_t latencyNs = 0;
+    std::vector<TagDetection> detections;
+};
+
+/**
+ * AprilTag detector built on OpenCV's aruco module, so it needs no library
+ * beyond the OpenCV we already link. Not thread-safe; each camera owns one.
+ */
+class TagDetector {
+  public:
+    explicit TagDetector(const TagDetectorConfig& config);
+
+    const TagDetectorConfig& config() const { return cfg; }
+
+    /** Detect tags in an 8-bit mono or BGR frame. */
+    void detect(const cv::Mat& frame, std::vector<TagDetection>& out);
+
+  private:
+    // Samples the bit grid of a detected tag and returns its decision margin.
+    float decisionMargin(const cv::Mat& gray, const std::vector<cv::Point2f>& corners);
+
+    TagDetectorConfig cfg;
+    cv::aruco::ArucoDetector detector;
+    int markerBits;
+
+    cv::Mat gray;
+    cv::Mat decimated;
+    cv::Mat warped;
+    std::vector<std::vector<cv::Point2f>> corners;
+    std::vector<int> ids;
+};
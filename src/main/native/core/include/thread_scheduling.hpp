@@ -0,0 +1,30 @@
+#pragma once
+
+#include <pthread.h>
+#include <vector>
+
+/** Requested CPU placement and scheduling class for a native thread. */
+struct ThreadSchedule {
+    // CPUs the thread may run on, empty allows every CPU.
+    std::vector<int> cpus;
+    // SCHED_FIFO priority (1-99), 0 selects the default SCHED_OTHER policy.
+    int fifoPriority = 0;
+};
+
+/** What the kernel actually granted after applying a ThreadSchedule. */
+struct EffectiveThreadSchedule {
+    std::vector<int> cpus;
+    int policy = -1;
+    int priority = 0;
+};
+
+/**
+ * Apply a schedule to the calling thread. Affinity and policy are applied
+ * independently, so a missing CAP_SYS_NICE still leaves the thread pinned.
+ *
+ * @return True if both affinity and policy were applied.
+ */
+bool applyThreadSchedule(const ThreadSchedule& schedule);
+
+/** Read back the calling thread's affinity and scheduling policy. */
+EffectiveThreadSchedule currentThreadSchedule();
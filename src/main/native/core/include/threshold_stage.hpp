@@ -0,0 +1,52 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+/** HSV range and post-processing for ThresholdStage. */
+struct ThresholdConfig {
+    // OpenCV HSV ranges (hue 0-180). hueLow > hueHigh selects the range that
+    // wraps through red, e.g. 170..10.
+    int hueLow = 0;
+    int hueHigh = 180;
+    int satLow = 0;
+    int satHigh = 255;
+    int valLow = 0;
+    int valHigh = 255;
+    // Mask resolution divisor: 1, 2, 4 or 8.
+    int downsample = 1;
+    // 0 = none, 1 = open (erode then dilate), 2 = close (dilate then erode).
+    int morphology = 0;
+    int morphKernel = 3;
+};
+
+/**
+ * Color threshold producing a 1-byte mask, run in row stripes right after a
+ * stripe of the frame has been converted so the pixels are still in cache.
+ *
+ * Each stripe is processed in small row blocks: averaged down (if
+ * downsampling), converted to HSV and range-tested, with the HSV block kept
+ * in a per-thread scratch buffer that never leaves L1/L2. Mono frames are
+ * tested against the value range only.
+ */
+class ThresholdStage {
+  public:
+    explicit ThresholdStage(const ThresholdConfig& config);
+
+    const ThresholdConfig& config() const { return cfg; }
+
+    /** Mask size for a frame of the given size. */
+    cv::Size maskSize(cv::Size frameSize) const;
+
+    /**
+     * Threshold frame rows [rowBegin, rowEnd) into the matching mask rows.
+     * rowBegin must be a multiple of the downsample factor.
+     */
+    void processRows(const cv::Mat& frame, cv::Mat& mask, int rowBegin, int rowEnd) const;
+
+    /** Whole-mask morphology pass; a no-op unless configured. */
+    void finish(cv::Mat& mask) const;
+
+  private:
+    ThresholdConfig cfg;
+    cv::Mat morphKernel;
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+/** Size, position and binning of a frame on the sensor. */
+struct FrameGeometry {
+    int width = 0;
+    int height = 0;
+    // ROI offset, in binned pixels.
+    int offsetX = 0;
+    int offsetY = 0;
+    int binH = 1;
+    int binV = 1;
+
+    bool operator==(const FrameGeometry& other) const {
+        return width == other.width && height == other.height && offsetX == other.offsetX &&
+               offsetY == other.offsetY && binH == other.binH && binV == other.binV;
+    }
+    bool operator!=(const FrameGeometry& other) const { return !(*this == other); }
+};
+
+/**
+ * Lens undistortion with precomputed fixed-point remap tables.
+ *
+ * The calibration is given once, together with the geometry it was taken
+ * at. When frames arrive with a different ROI or binning the intrinsics are
+ * moved to the new geometry and the tables rebuilt; otherwise every frame
+ * reuses them. Output frames keep the (adjusted) input intrinsics with zero
+ * distortion.
+ */
+class UndistortStage {
+  public:
+    UndistortStage(const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs,
+                   const FrameGeometry& calibration);
+
+    /** Rebuild the tables if geometry differs from the last call. */
+    void prepare(const FrameGeometry& geometry);
+
+    /**
+     * Fill rows [rowBegin, rowEnd) of dst from src. Rows are independent, so
+     * stripes can run in parallel once prepare() has returned.
+     */
+    void remapRows(const cv::Mat& src, cv::Mat& dst, int rowBegin, int rowEnd) const;
+
+    /** Intrinsics of the calibration moved to the given frame geometry. */
+    cv::Mat cameraMatrixFor(const FrameGeometry& geometry) const;
+
+  private:
+    cv::Mat cameraMatrix;
+    cv::Mat distCoeffs;
+    FrameGeometry calibration;
+
+    FrameGeometry prepared;
+    // CV_16SC2 integer coordinates + CV_16UC1 interpolation weights, the
+    // layout cv::remap has vectorized fast paths for.
+    cv::Mat map1;
+    cv::Mat map2;
+};
@@ -0,0 +1,50 @@
+#include "bandwidth_balancer.hpp"
+#include "camera_instance.hpp"
+#include <algorithm>
+
+BandwidthBalancer &BandwidthBalancer::instance() {
+  static BandwidthBalancer balancer;
+  return balancer;
+}
+
+void BandwidthBalancer::join(CameraInstance *camera, const std::string &link) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = std::find_if(members.begin(), members.end(),
+                         [&](const Member &m) { return m.camera == camera; });
+  if (it == members.end()) {
+    members.push_back({camera, link});
+  } else if (it->link != link) {
+    // Came back through another interface; its old link gets the room back.
+    std::string previous = it->link;
+    it->link = link;
+    rebalance(previous);
+  }
+  rebalance(link);
+}
+
+void BandwidthBalancer::leave(CameraInstance *camera) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = std::find_if(members.begin(), members.end(),
+                         [&](const Member &m) { return m.camera == camera; });
+  if (it == members.end()) {
+    return;
+  }
+  std::string link = it->link;
+  members.erase(it);
+  rebalance(link);
+}
+
+void BandwidthBalancer::rebalance(const std::string &link) {
+  size_t sharing = std::count_if(
+      members.begin(), members.end(),
+      [&](const Member &m) { return m.link == link; });
+  if (sharing == 0) {
+    return;
+  }
+  double share = 1.0 / sharing;
+  for (const Member &member : members) {
+    if (member.link == link) {
+      member.camera->applyBandwidthShare(share);
+    }
+  }
+}
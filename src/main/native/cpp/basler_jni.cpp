@@ -1,19 +1,32 @@
 #include "camera_instance.hpp"
+#include "conversion_pool.hpp"
+#include "device_cache.hpp"
+#include "handle_registry.hpp"
+#include "native_log.hpp"
 #include "org_teamdeadbolts_basler_BaslerJNI.h"
+#include <algorithm>
 #include <atomic>
-#include <map>
+#include <chrono>
+#include <cstring>
 #include <mutex>
 #include <pylon/BaslerUniversalInstantCamera.h>
 #include <pylon/PylonIncludes.h>
+#include <sched.h>
 #include <thread>
 
 using namespace Pylon;
 using namespace Basler_UniversalCameraParams;
 
-static std::map<jlong, std::shared_ptr<CameraInstance>> cMap;
-static std::mutex mapMutex;
+static HandleRegistry<CameraInstance> cameras;
 static bool pylonInit = false;
 
+// Java side of native log forwarding, set by setNativeLogForwarding. Only
+// changed with forwarding disabled, so the log sink never sees them change.
+static JavaVM *logJvm = nullptr;
+static jclass logClass = nullptr;
+static jclass logStringClass = nullptr;
+static jmethodID logDispatch = nullptr;
+
 std::string jstringToString(JNIEnv *env, jstring jStr) {
   if (!jStr)
     return "";
@@ -23,13 +36,64 @@ std::string jstringToString(JNIEnv *env, jstring jStr) {
   return str;
 }
 
-std::shared_ptr<CameraInstance> getCameraInstance(jlong handle) {
-  std::lock_guard<std::mutex> lock(mapMutex);
-  auto it = cMap.find(handle);
-  if (it != cMap.end()) {
-    return it->second;
+// Creates and opens a camera, reusing the cached CDeviceInfo when the device
+// has been enumerated so CreateDevice does not run another discovery.
+// Throws GenericException if the device cannot be created.
+std::shared_ptr<CameraInstance> openCamera(const std::string &serial) {
+  auto begin = std::chrono::steady_clock::now();
+
+  DeviceCache &cache = DeviceCache::instance();
+  cache.ensurePopulated();
+
+  CDeviceInfo devInfo;
+  if (!cache.find(serial, devInfo)) {
+    // Not in the cache (yet), let Pylon discover it by serial.
+    devInfo = CDeviceInfo();
+    devInfo.SetSerialNumber(serial.c_str());
   }
-  return nullptr;
+
+  IPylonDevice *device = CTlFactory::GetInstance().CreateDevice(devInfo);
+  auto instance = std::make_shared<CameraInstance>(device);
+
+  std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - begin;
+  instance->setOpenTime(elapsed.count());
+  return instance;
+}
+
+jlong registerCamera(const std::shared_ptr<CameraInstance> &instance) {
+  return static_cast<jlong>(cameras.add(instance));
+}
+
+// Copies metadata into the Java layout: ints = {sequence, hostTimestampNs,
+// cameraTimestamp, lineStatus, frameCounter, fields, bracketIndex}, floats =
+// {exposureUs, gain, changeScore}.
+constexpr jsize kMetadataInts = 7;
+constexpr jsize kMetadataFloats = 3;
+
+bool metadataArraysValid(JNIEnv *env, jlongArray ints, jdoubleArray floats) {
+  return ints && floats && env->GetArrayLength(ints) >= kMetadataInts &&
+         env->GetArrayLength(floats) >= kMetadataFloats;
+}
+
+void copyMetadata(JNIEnv *env, const FrameMetadata &metadata, jlongArray ints,
+                  jdoubleArray floats) {
+  jlong intValues[kMetadataInts] = {
+      static_cast<jlong>(metadata.sequence),
+      metadata.hostTimestampNs,
+      static_cast<jlong>(metadata.cameraTimestamp),
+      metadata.lineStatus,
+      metadata.frameCounter,
+      static_cast<jlong>(metadata.fields),
+      metadata.bracketIndex};
+  jdouble floatValues[kMetadataFloats] = {metadata.exposureUs, metadata.gain,
+                                          metadata.changeScore};
+  env->SetLongArrayRegion(ints, 0, kMetadataInts, intValues);
+  env->SetDoubleArrayRegion(floats, 0, kMetadataFloats, floatValues);
+}
+
+std::shared_ptr<CameraInstance> getCameraInstance(jlong handle) {
+  return cameras.find(handle);
 }
 
 /*
@@ -65,16 +129,20 @@ Java_org_teamdeadbolts_basler_BaslerJNI_getCameraModelRaw(
     }
 
     std::string serial = jstringToString(env, serialNumber);
-    CTlFactory &tlFactory = CTlFactory::GetInstance();
-    DeviceInfoList_t devices;
-
-    if (tlFactory.EnumerateDevices(devices) > 0) {
-      for (const auto &devInfo : devices) {
-        if (std::string(devInfo.GetSerialNumber()) == serial) {
-          std::string modelName(devInfo.GetModelName());
-          return env->NewStringUTF(modelName.c_str());
-        }
-      }
+    DeviceCache &cache = DeviceCache::instance();
+    bool refreshed = cache.ensurePopulated();
+
+    CDeviceInfo devInfo;
+    bool found = cache.find(serial, devInfo);
+    if (!found && !refreshed && !cache.isWatching()) {
+      // Nothing is keeping the cache fresh, so the camera may simply be new.
+      cache.refresh();
+      found = cache.find(serial, devInfo);
+    }
+
+    if (found) {
+      std::string modelName(devInfo.GetModelName());
+      return env->NewStringUTF(modelName.c_str());
     }
 
     // Return null if not found
@@ -99,9 +167,14 @@ Java_org_teamdeadbolts_basler_BaslerJNI_getConnectedCameras(JNIEnv *env,
       pylonInit = true;
     }
 
-    CTlFactory &tlFactory = CTlFactory::GetInstance();
-    DeviceInfoList_t devices;
-    size_t numDevices = tlFactory.EnumerateDevices(devices);
+    // With the watcher running the cache is already current; otherwise this
+    // is the one enumeration later model lookups and opens are served from.
+    DeviceCache &cache = DeviceCache::instance();
+    if (!cache.isWatching()) {
+      cache.refresh();
+    }
+    std::vector<CDeviceInfo> devices = cache.snapshot();
+    size_t numDevices = devices.size();
 
     jclass stringClass = env->FindClass("java/lang/String");
     if (stringClass == nullptr) {
@@ -132,10 +205,12 @@ Java_org_teamdeadbolts_basler_BaslerJNI_getConnectedCameras(JNIEnv *env,
 
     return result;
   } catch (const GenericException &e) {
-    std::cout << "Pylon exception: " << e.GetDescription() << std::endl;
+    BJNI_LOG_ERROR("BaslerJNI::getConnectedCameras",
+                   "Pylon exception: " << e.GetDescription());
     return nullptr;
   } catch (...) {
-    std::cout << "Unknown exception in getConnectedCameras" << std::endl;
+    BJNI_LOG_ERROR("BaslerJNI::getConnectedCameras",
+                   "Unknown exception in getConnectedCameras");
     return nullptr;
   }
 }
@@ -154,26 +229,77 @@ JNIEXPORT jlong JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_createCamera(
     }
 
     std::string serial = jstringToString(env, serialNumber);
-    CTlFactory &tlFactory = CTlFactory::GetInstance();
+    return registerCamera(openCamera(serial));
+  } catch (const GenericException &) {
+    return 0;
+  }
+}
 
-    CDeviceInfo devInfo;
-    devInfo.SetSerialNumber(serial.c_str());
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    createCameras
+ * Signature: ([Ljava/lang/String;)[J
+ */
+JNIEXPORT jlongArray JNICALL
+Java_org_teamdeadbolts_basler_BaslerJNI_createCameras(JNIEnv *env, jclass,
+                                                      jobjectArray serials) {
+  if (!serials)
+    return nullptr;
 
-    IPylonDevice *device = tlFactory.CreateDevice(devInfo);
-    auto instance = std::make_shared<CameraInstance>(device);
-    // instance->camera->Open();
+  try {
+    if (!pylonInit) {
+      PylonInitialize();
+      pylonInit = true;
+    }
+    // One enumeration up front, shared by every worker below.
+    DeviceCache::instance().ensurePopulated();
+  } catch (const GenericException &e) {
+    BJNI_LOG_ERROR("BaslerJNI::createCameras",
+                   "Pylon exception: " << e.GetDescription());
+    return nullptr;
+  }
 
-    jlong handle = reinterpret_cast<jlong>(instance.get());
+  jsize count = env->GetArrayLength(serials);
+  std::vector<std::string> serialList(count);
+  for (jsize i = 0; i < count; i++) {
+    auto jSerial =
+        static_cast<jstring>(env->GetObjectArrayElement(serials, i));
+    serialList[i] = jstringToString(env, jSerial);
+    env->DeleteLocalRef(jSerial);
+  }
 
-    {
-      std::lock_guard<std::mutex> lock(mapMutex);
-      cMap[handle] = instance;
-    }
+  // Device open is dominated by blocking I/O, so open all cameras at once.
+  std::vector<std::shared_ptr<CameraInstance>> instances(count);
+  std::vector<std::thread> workers;
+  workers.reserve(count);
+  for (jsize i = 0; i < count; i++) {
+    workers.emplace_back([&serialList, &instances, i] {
+      try {
+        instances[i] = openCamera(serialList[i]);
+      } catch (const GenericException &e) {
+        BJNI_LOG_WARN("BaslerJNI::createCameras",
+                      "Failed to open camera " << serialList[i] << ": "
+                      << e.GetDescription());
+      }
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
 
-    return handle;
-  } catch (const GenericException &) {
-    return 0;
+  std::vector<jlong> handles(count, 0);
+  for (jsize i = 0; i < count; i++) {
+    if (instances[i]) {
+      handles[i] = registerCamera(instances[i]);
+    }
   }
+
+  jlongArray result = env->NewLongArray(count);
+  if (!result)
+    return nullptr;
+
+  env->SetLongArrayRegion(result, 0, count, handles.data());
+  return result;
 }
 
 /*
@@ -214,11 +340,7 @@ JNIEXPORT jboolean JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_stopCamera(
 JNIEXPORT jboolean JNICALL
 Java_org_teamdeadbolts_basler_BaslerJNI_destroyCamera(JNIEnv *env, jclass,
                                                       jlong handle) {
-  {
-    std::lock_guard<std::mutex> lock(mapMutex);
-    cMap.erase(handle);
-  }
-
+  cameras.remove(handle);
   return JNI_TRUE;
 }
 
@@ -298,8 +420,8 @@ Java_org_teamdeadbolts_basler_BaslerJNI_setWhiteBalance(JNIEnv *env, jclass,
 
   jsize length = env->GetArrayLength(rgb);
   if (length != 3) {
-    std::cout << "Expected array of length 3 for RGB balance, got " << length
-              << std::endl;
+    BJNI_LOG_WARN("BaslerJNI::setWhiteBalance",
+                  "Expected array of length 3 for RGB balance, got " << length);
     return JNI_FALSE; // Expecting an array of length 3
   }
 
@@ -603,9 +725,8 @@ JNIEXPORT jlong JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_takeFrame(
   if (!instance)
     return 0;
 
-  // takeFrame() returns a std::shared_ptr<cv::Mat> copy (your
-  // CameraInstance::takeFrame already locks the mutex when copying
-  // currentFramePtr).
+  // takeFrame() returns a std::shared_ptr<cv::Mat> copy taken from the
+  // instance's FrameMailbox.
   auto matPtr = instance->takeFrame();
   if (!matPtr)
     return 0;
@@ -623,26 +744,1182 @@ JNIEXPORT jlong JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_takeFrame(
 
 /*
  * Class:     org_teamdeadbolts_basler_BaslerJNI
- * Method:    awaitaNewFrame
+ * Method:    awaitNewFrame
+ * Signature: (JI)I
+ */
+JNIEXPORT jint JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_awaitNewFrame(
+    JNIEnv *env, jclass, jlong handle, jint timeoutMs) {
+  auto instance = getCameraInstance(handle);
+  if (!instance)
+    return kFrameDisconnected;
+
+  return instance->awaitNewFrame(timeoutMs);
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    pollFrame
+ * Signature: (JJ)I
+ */
+JNIEXPORT jint JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_pollFrame(
+    JNIEnv *, jclass, jlong handle, jlong lastSequence) {
+  auto instance = getCameraInstance(handle);
+  if (!instance)
+    return kFrameDisconnected;
+
+  return instance->pollFrame(lastSequence < 0 ? 0 : lastSequence);
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    getFrameSequence
  * Signature: (J)J
  */
-JNIEXPORT void JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_awaitNewFrame(
-    JNIEnv *env, jclass, jlong handle) {
+JNIEXPORT jlong JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_getFrameSequence(
+    JNIEnv *, jclass, jlong handle) {
   auto instance = getCameraInstance(handle);
   if (!instance)
-    return;
+    return -1;
+
+  return static_cast<jlong>(instance->getFrameSequence());
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    getLastGrabError
+ * Signature: (J)J
+ */
+JNIEXPORT jlong JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_getLastGrabError(
+    JNIEnv *, jclass, jlong handle) {
+  auto instance = getCameraInstance(handle);
+  if (!instance)
+    return -1;
+
+  return instance->getLastGrabError();
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    configureConversionPool
+ * Signature: (I[II)Z
+ */
+JNIEXPORT jboolean JNICALL
+Java_org_teamdeadbolts_basler_BaslerJNI_configureConversionPool(
+    JNIEnv *env, jclass, jint threads, jintArray cpus, jint minStripeRows) {
+  if (threads < 0 || minStripeRows <= 0) {
+    BJNI_LOG_WARN("BaslerJNI::configureConversionPool",
+                  "Invalid conversion pool config: threads=" << threads
+                  << " minStripeRows=" << minStripeRows);
+    return JNI_FALSE;
+  }
+
+  std::vector<int> cpuList;
+  if (cpus) {
+    jsize length = env->GetArrayLength(cpus);
+    cpuList.resize(length);
+    env->GetIntArrayRegion(cpus, 0, length, cpuList.data());
+  }
+
+  ConversionPool::instance().configure(threads, cpuList, minStripeRows);
+  return JNI_TRUE;
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    setThreadScheduling
+ * Signature: (J[IIII)Z
+ */
+JNIEXPORT jboolean JNICALL
+Java_org_teamdeadbolts_basler_BaslerJNI_setThreadScheduling(
+    JNIEnv *env, jclass, jlong handle, jintArray cpus, jint fifoPriority,
+    jint grabEnginePriority, jint grabLoopPriority) {
+  auto instance = getCameraInstance(handle);
+  if (!instance)
+    return JNI_FALSE;
+
+  if (fifoPriority != 0 &&
+      (fifoPriority < sched_get_priority_min(SCHED_FIFO) ||
+       fifoPriority > sched_get_priority_max(SCHED_FIFO))) {
+    BJNI_LOG_WARN("BaslerJNI::setThreadScheduling",
+                  "SCHED_FIFO priority out of range: " << fifoPriority);
+    return JNI_FALSE;
+  }
+
+  ThreadSchedule schedule;
+  schedule.fifoPriority = fifoPriority;
+  if (cpus) {
+    jsize length = env->GetArrayLength(cpus);
+    schedule.cpus.resize(length);
+    env->GetIntArrayRegion(cpus, 0, length, schedule.cpus.data());
+  }
+
+  return instance->setThreadScheduling(schedule, grabEnginePriority,
+                                       grabLoopPriority)
+             ? JNI_TRUE
+             : JNI_FALSE;
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    getThreadSchedulingRaw
+ * Signature: (J)[I
+ */
+JNIEXPORT jintArray JNICALL
+Java_org_teamdeadbolts_basler_BaslerJNI_getThreadSchedulingRaw(JNIEnv *env,
+                                                               jclass,
+                                                               jlong handle) {
+  auto instance = getCameraInstance(handle);
+  if (!instance)
+    return nullptr;
+
+  std::vector<int> scheduling = instance->getThreadScheduling();
+  jintArray result = env->NewIntArray(scheduling.size());
+  if (!result)
+    return nullptr;
+
+  env->SetIntArrayRegion(result, 0, scheduling.size(), scheduling.data());
+  return result;
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    refreshDevices
+ * Signature: ()I
+ */
+JNIEXPORT jint JNICALL
+Java_org_teamdeadbolts_basler_BaslerJNI_refreshDevices(JNIEnv *, jclass) {
+  try {
+    if (!pylonInit) {
+      PylonInitialize();
+      pylonInit = true;
+    }
+    return static_cast<jint>(DeviceCache::instance().refresh());
+  } catch (const GenericException &e) {
+    BJNI_LOG_ERROR("BaslerJNI::refreshDevices",
+                   "Pylon exception: " << e.GetDescription());
+    return -1;
+  }
+}
 
-  instance->awaitNewFrame();
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    setDeviceWatcher
+ * Signature: (I)Z
+ */
+JNIEXPORT jboolean JNICALL
+Java_org_teamdeadbolts_basler_BaslerJNI_setDeviceWatcher(JNIEnv *, jclass,
+                                                         jint intervalMs) {
+  try {
+    if (!pylonInit) {
+      PylonInitialize();
+      pylonInit = true;
+    }
+    DeviceCache::instance().setWatcherInterval(intervalMs);
+    return JNI_TRUE;
+  } catch (const GenericException &e) {
+    BJNI_LOG_ERROR("BaslerJNI::setDeviceWatcher",
+                   "Pylon exception: " << e.GetDescription());
+    return JNI_FALSE;
+  }
 }
 
-JNIEXPORT void JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_cleanUp(JNIEnv *,
-                                                                       jclass) {
-  {
-    std::lock_guard<std::mutex> lock(mapMutex);
-    cMap.clear();
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    getDeviceInfosRaw
+ * Signature: ()[Ljava/lang/String;
+ */
+JNIEXPORT jobjectArray JNICALL
+Java_org_teamdeadbolts_basler_BaslerJNI_getDeviceInfosRaw(JNIEnv *env,
+                                                          jclass) {
+  try {
+    if (!pylonInit) {
+      PylonInitialize();
+      pylonInit = true;
+    }
+
+    DeviceCache &cache = DeviceCache::instance();
+    cache.ensurePopulated();
+    std::vector<CDeviceInfo> devices = cache.snapshot();
+
+    jclass stringClass = env->FindClass("java/lang/String");
+    if (stringClass == nullptr) {
+      env->ExceptionClear();
+      return nullptr;
+    }
+
+    constexpr size_t kFieldsPerDevice = 4;
+    jobjectArray result = env->NewObjectArray(
+        devices.size() * kFieldsPerDevice, stringClass, nullptr);
+    if (result == nullptr) {
+      env->ExceptionClear();
+      return nullptr;
+    }
+
+    for (size_t i = 0; i < devices.size(); i++) {
+      const CDeviceInfo &devInfo = devices[i];
+      std::string fields[kFieldsPerDevice] = {
+          std::string(devInfo.GetSerialNumber()),
+          std::string(devInfo.GetModelName()),
+          std::string(devInfo.GetDeviceClass()),
+          devInfo.IsIpAddressAvailable() ? std::string(devInfo.GetIpAddress())
+                                         : std::string(),
+      };
+
+      for (size_t f = 0; f < kFieldsPerDevice; f++) {
+        jstring jField = env->NewStringUTF(fields[f].c_str());
+        if (!jField) {
+          env->ExceptionClear();
+          continue;
+        }
+        env->SetObjectArrayElement(result, i * kFieldsPerDevice + f, jField);
+        env->DeleteLocalRef(jField);
+      }
+    }
+
+    return result;
+  } catch (const GenericException &e) {
+    BJNI_LOG_ERROR("BaslerJNI::getDeviceInfosRaw",
+                   "Pylon exception: " << e.GetDescription());
+    return nullptr;
   }
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    getCameraStats
+ * Signature: (J)[D
+ */
+JNIEXPORT jdoubleArray JNICALL
+Java_org_teamdeadbolts_basler_BaslerJNI_getCameraStats(JNIEnv *env, jclass,
+                                                       jlong handle) {
+  auto instance = getCameraInstance(handle);
+  if (!instance)
+    return nullptr;
+
+  auto stats = instance->getStats();
+  jdoubleArray result = env->NewDoubleArray(stats.size());
+  if (!result)
+    return nullptr;
+
+  env->SetDoubleArrayRegion(result, 0, stats.size(), stats.data());
+  return result;
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    saveProfile
+ * Signature: (JLjava/lang/String;Z)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_saveProfile(
+    JNIEnv *env, jclass, jlong handle, jstring path, jboolean fullNodeMap) {
+  auto instance = getCameraInstance(handle);
+  if (!instance || !path)
+    return JNI_FALSE;
+
+  return instance->saveProfile(jstringToString(env, path), fullNodeMap)
+             ? JNI_TRUE
+             : JNI_FALSE;
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    loadProfile
+ * Signature: (JLjava/lang/String;)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_loadProfile(
+    JNIEnv *env, jclass, jlong handle, jstring path) {
+  auto instance = getCameraInstance(handle);
+  if (!instance || !path)
+    return JNI_FALSE;
+
+  return instance->loadProfile(jstringToString(env, path)) ? JNI_TRUE
+                                                            : JNI_FALSE;
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    saveUserSet
+ * Signature: (JIZ)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_saveUserSet(
+    JNIEnv *, jclass, jlong handle, jint userSet, jboolean makeDefault) {
+  auto instance = getCameraInstance(handle);
+  if (!instance)
+    return JNI_FALSE;
+
+  return instance->saveUserSet(userSet, makeDefault) ? JNI_TRUE : JNI_FALSE;
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    loadUserSet
+ * Signature: (JI)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_loadUserSet(
+    JNIEnv *, jclass, jlong handle, jint userSet) {
+  auto instance = getCameraInstance(handle);
+  if (!instance)
+    return JNI_FALSE;
+
+  return instance->loadUserSet(userSet) ? JNI_TRUE : JNI_FALSE;
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    getConnectionState
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL
+Java_org_teamdeadbolts_basler_BaslerJNI_getConnectionState(JNIEnv *, jclass,
+                                                           jlong handle) {
+  auto instance = getCameraInstance(handle);
+  if (!instance)
+    return -1;
+
+  return instance->getConnectionState();
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    configureGigETransport
+ * Signature: (JIIZII)Z
+ */
+JNIEXPORT jboolean JNICALL
+Java_org_teamdeadbolts_basler_BaslerJNI_configureGigETransport(
+    JNIEnv *, jclass, jlong handle, jint packetSize, jint interPacketDelay,
+    jboolean shareBandwidth, jint maxResendRequests, jint socketBufferKb) {
+  auto instance = getCameraInstance(handle);
+  if (!instance)
+    return JNI_FALSE;
+
+  GigETransportConfig config;
+  config.packetSize = packetSize;
+  config.interPacketDelay = interPacketDelay;
+  config.shareBandwidth = shareBandwidth == JNI_TRUE;
+  config.maxResendRequests = maxResendRequests;
+  config.socketBufferKb = socketBufferKb;
+  return instance->configureGigETransport(config) ? JNI_TRUE : JNI_FALSE;
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    configureUsbTransport
+ * Signature: (JIIIIIJ)Z
+ */
+JNIEXPORT jboolean JNICALL
+Java_org_teamdeadbolts_basler_BaslerJNI_configureUsbTransport(
+    JNIEnv *, jclass, jlong handle, jint maxTransferSize, jint numMaxQueuedUrbs,
+    jint maxBufferSize, jint maxNumBuffer, jint throughputLimitMode,
+    jlong throughputLimit) {
+  auto instance = getCameraInstance(handle);
+  if (!instance)
+    return JNI_FALSE;
+
+  UsbTransportConfig config;
+  config.maxTransferSize = maxTransferSize;
+  config.numMaxQueuedUrbs = numMaxQueuedUrbs;
+  config.maxBufferSize = maxBufferSize;
+  config.maxNumBuffer = maxNumBuffer;
+  config.throughputLimitMode = throughputLimitMode;
+  config.throughputLimit = throughputLimit;
+  return instance->configureUsbTransport(config) ? JNI_TRUE : JNI_FALSE;
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    getCameraState
+ * Signature: (J[D)Z
+ */
+JNIEXPORT jboolean JNICALL
+Java_org_teamdeadbolts_basler_BaslerJNI_getCameraState(JNIEnv *env, jclass,
+                                                       jlong handle,
+                                                       jdoubleArray out) {
+  auto instance = getCameraInstance(handle);
+  if (!instance || !out || env->GetArrayLength(out) < kStateCount)
+    return JNI_FALSE;
+
+  auto state = instance->getCameraState();
+  env->SetDoubleArrayRegion(out, 0, kStateCount, state.data());
+  return JNI_TRUE;
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    setFrameHistory
+ * Signature: (JIZ)Z
+ */
+JNIEXPORT jboolean JNICALL
+Java_org_teamdeadbolts_basler_BaslerJNI_setFrameHistory(JNIEnv *, jclass,
+                                                        jlong handle,
+                                                        jint frames,
+                                                        jboolean raw) {
+  auto instance = getCameraInstance(handle);
+  if (!instance)
+    return JNI_FALSE;
+
+  return instance->setFrameHistory(frames, raw == JNI_TRUE) ? JNI_TRUE
+                                                            : JNI_FALSE;
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    takeFrameAt
+ * Signature: (JJ)J
+ */
+JNIEXPORT jlong JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_takeFrameAt(
+    JNIEnv *, jclass, jlong handle, jlong sequence) {
+  auto instance = getCameraInstance(handle);
+  if (!instance || sequence <= 0)
+    return 0;
+
+  cv::Mat frame;
+  if (!instance->takeFrameAt(static_cast<uint64_t>(sequence), frame)) {
+    return 0;
+  }
+  // The ring copy is already independent of native buffers; Java owns it.
+  return reinterpret_cast<jlong>(new cv::Mat(std::move(frame)));
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    getFrameHistoryRange
+ * Signature: (J)[J
+ */
+JNIEXPORT jlongArray JNICALL
+Java_org_teamdeadbolts_basler_BaslerJNI_getFrameHistoryRange(JNIEnv *env,
+                                                             jclass,
+                                                             jlong handle) {
+  auto instance = getCameraInstance(handle);
+  if (!instance)
+    return nullptr;
+
+  auto range = instance->getFrameHistoryRange();
+  jlong values[2] = {static_cast<jlong>(range[0]),
+                     static_cast<jlong>(range[1])};
+  jlongArray result = env->NewLongArray(2);
+  if (!result)
+    return nullptr;
+
+  env->SetLongArrayRegion(result, 0, 2, values);
+  return result;
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    dumpRecentFrames
+ * Signature: (JLjava/lang/String;I)I
+ */
+JNIEXPORT jint JNICALL
+Java_org_teamdeadbolts_basler_BaslerJNI_dumpRecentFrames(JNIEnv *env, jclass,
+                                                         jlong handle,
+                                                         jstring directory,
+                                                         jint count) {
+  auto instance = getCameraInstance(handle);
+  if (!instance || !directory)
+    return 0;
+
+  return instance->dumpRecentFrames(jstringToString(env, directory), count);
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    takeFrameRegions
+ * Signature: (J[ILjava/nio/ByteBuffer;[I)J
+ */
+JNIEXPORT jlong JNICALL
+Java_org_teamdeadbolts_basler_BaslerJNI_takeFrameRegions(JNIEnv *env, jclass,
+                                                         jlong handle,
+                                                         jintArray rects,
+                                                         jobject buffer,
+                                                         jintArray layout) {
+  auto instance = getCameraInstance(handle);
+  if (!instance || !rects || !buffer || !layout)
+    return CameraInstance::kRegionError;
+
+  jsize rectInts = env->GetArrayLength(rects);
+  int count = rectInts / CameraInstance::kRegionRectInts;
+  if (rectInts % CameraInstance::kRegionRectInts != 0 ||
+      env->GetArrayLength(layout) <
+          static_cast<int64_t>(count) * CameraInstance::kRegionLayoutInts)
+    return CameraInstance::kRegionError;
+
+  auto *out = static_cast<uint8_t *>(env->GetDirectBufferAddress(buffer));
+  jlong capacity = env->GetDirectBufferCapacity(buffer);
+  if (!out || capacity < 0)
+    return CameraInstance::kRegionError;
+
+  std::vector<jint> rectValues(rectInts);
+  std::vector<jint> layoutValues(count * CameraInstance::kRegionLayoutInts);
+  env->GetIntArrayRegion(rects, 0, rectInts, rectValues.data());
+
+  int64_t used = instance->copyFrameRegions(
+      rectValues.data(), count, out, static_cast<size_t>(capacity),
+      layoutValues.data());
+  if (used != 0) {
+    env->SetIntArrayRegion(layout, 0, layoutValues.size(),
+                           layoutValues.data());
+  }
+  return used;
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    configureAutoFunctions
+ * Signature: (J[I[DZIZ)Z
+ */
+JNIEXPORT jboolean JNICALL
+Java_org_teamdeadbolts_basler_BaslerJNI_configureAutoFunctions(
+    JNIEnv *env, jclass, jlong handle, jintArray roi, jdoubleArray limits,
+    jboolean capExposureToFrameRate, jint profile, jboolean autoGain) {
+  auto instance = getCameraInstance(handle);
+  if (!instance)
+    return JNI_FALSE;
+
+  AutoFunctionConfig config;
+  if (roi) {
+    if (env->GetArrayLength(roi) != 4)
+      return JNI_FALSE;
+    jint values[4];
+    env->GetIntArrayRegion(roi, 0, 4, values);
+    config.roiX = values[0];
+    config.roiY = values[1];
+    config.roiWidth = values[2];
+    config.roiHeight = values[3];
+  }
+  if (limits) {
+    if (env->GetArrayLength(limits) != 5)
+      return JNI_FALSE;
+    jdouble values[5];
+    env->GetDoubleArrayRegion(limits, 0, 5, values);
+    config.exposureLowerUs = values[0];
+    config.exposureUpperUs = values[1];
+    config.gainLower = values[2];
+    config.gainUpper = values[3];
+    config.targetBrightness = values[4];
+  }
+  config.capExposureToFrameRate = capExposureToFrameRate == JNI_TRUE;
+  config.profile = profile;
+  config.autoGain = autoGain == JNI_TRUE;
+  return instance->configureAutoFunctions(config) ? JNI_TRUE : JNI_FALSE;
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    triggerAutoExposureOnce
+ * Signature: (J)Z
+ */
+JNIEXPORT jboolean JNICALL
+Java_org_teamdeadbolts_basler_BaslerJNI_triggerAutoExposureOnce(JNIEnv *,
+                                                                jclass,
+                                                                jlong handle) {
+  auto instance = getCameraInstance(handle);
+  if (!instance)
+    return JNI_FALSE;
+
+  return instance->triggerAutoExposureOnce() ? JNI_TRUE : JNI_FALSE;
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    getAutoExposureState
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL
+Java_org_teamdeadbolts_basler_BaslerJNI_getAutoExposureState(JNIEnv *, jclass,
+                                                             jlong handle) {
+  auto instance = getCameraInstance(handle);
+  if (!instance)
+    return -1;
+
+  return instance->getAutoExposureState();
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    configureSoftwareAutoExposure
+ * Signature: (JI[I[DI)Z
+ */
+JNIEXPORT jboolean JNICALL
+Java_org_teamdeadbolts_basler_BaslerJNI_configureSoftwareAutoExposure(
+    JNIEnv *env, jclass, jlong handle, jint mode, jintArray roi,
+    jdoubleArray params, jint subsample) {
+  auto instance = getCameraInstance(handle);
+  if (!instance)
+    return JNI_FALSE;
+
+  SoftwareAutoExposureConfig config;
+  config.histogram = mode >= 1;
+  config.control = mode >= 2;
+  config.subsample = subsample;
+  if (roi) {
+    if (env->GetArrayLength(roi) != 4)
+      return JNI_FALSE;
+    jint values[4];
+    env->GetIntArrayRegion(roi, 0, 4, values);
+    config.roiX = values[0];
+    config.roiY = values[1];
+    config.roiWidth = values[2];
+    config.roiHeight = values[3];
+  }
+  if (params) {
+    if (env->GetArrayLength(params) != 6)
+      return JNI_FALSE;
+    jdouble values[6];
+    env->GetDoubleArrayRegion(params, 0, 6, values);
+    config.targetLuma = values[0];
+    config.kp = values[1];
+    config.ki = values[2];
+    config.maxStepRatio = values[3];
+    config.maxExposureUs = values[4];
+    config.maxGain = values[5];
+  }
+  return instance->configureSoftwareAutoExposure(config) ? JNI_TRUE
+                                                         : JNI_FALSE;
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    getLumaHistogram
+ * Signature: (J)[I
+ */
+JNIEXPORT jintArray JNICALL
+Java_org_teamdeadbolts_basler_BaslerJNI_getLumaHistogram(JNIEnv *env, jclass,
+                                                         jlong handle) {
+  auto instance = getCameraInstance(handle);
+  if (!instance)
+    return nullptr;
+
+  LumaHistogram histogram = instance->getLumaHistogram();
+  jintArray result = env->NewIntArray(histogram.bins.size());
+  if (!result)
+    return nullptr;
+
+  env->SetIntArrayRegion(result, 0, histogram.bins.size(),
+                         reinterpret_cast<const jint *>(histogram.bins.data()));
+  return result;
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    setChunkMetadata
+ * Signature: (JZ)Z
+ */
+JNIEXPORT jboolean JNICALL
+Java_org_teamdeadbolts_basler_BaslerJNI_setChunkMetadata(JNIEnv *, jclass,
+                                                         jlong handle,
+                                                         jboolean enable) {
+  auto instance = getCameraInstance(handle);
+  if (!instance)
+    return JNI_FALSE;
+
+  return instance->setChunkMetadata(enable == JNI_TRUE) ? JNI_TRUE : JNI_FALSE;
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    takeFrameWithMetadata
+ * Signature: (J[J[D)J
+ */
+JNIEXPORT jlong JNICALL
+Java_org_teamdeadbolts_basler_BaslerJNI_takeFrameWithMetadata(
+    JNIEnv *env, jclass, jlong handle, jlongArray ints, jdoubleArray floats) {
+  auto instance = getCameraInstance(handle);
+  if (!instance || !metadataArraysValid(env, ints, floats))
+    return 0;
+
+  FrameMetadata metadata;
+  auto matPtr = instance->takeFrameWithMetadata(metadata);
+  if (!matPtr || matPtr->empty())
+    return 0;
+
+  copyMetadata(env, metadata, ints, floats);
+  return reinterpret_cast<jlong>(new cv::Mat(matPtr->clone()));
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    getFrameMetadataRaw
+ * Signature: (JJ[J[D)Z
+ */
+JNIEXPORT jboolean JNICALL
+Java_org_teamdeadbolts_basler_BaslerJNI_getFrameMetadataRaw(
+    JNIEnv *env, jclass, jlong handle, jlong sequence, jlongArray ints,
+    jdoubleArray floats) {
+  auto instance = getCameraInstance(handle);
+  if (!instance || !metadataArraysValid(env, ints, floats))
+    return JNI_FALSE;
+
+  FrameMetadata metadata;
+  if (!instance->getFrameMetadata(static_cast<uint64_t>(sequence), metadata))
+    return JNI_FALSE;
+
+  copyMetadata(env, metadata, ints, floats);
+  return JNI_TRUE;
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    setUndistortion
+ * Signature: (J[D[DII)Z
+ */
+JNIEXPORT jboolean JNICALL
+Java_org_teamdeadbolts_basler_BaslerJNI_setUndistortion(
+    JNIEnv *env, jclass, jlong handle, jdoubleArray cameraMatrix,
+    jdoubleArray distCoeffs, jint calibWidth, jint calibHeight) {
+  auto instance = getCameraInstance(handle);
+  if (!instance)
+    return JNI_FALSE;
+
+  if (!cameraMatrix) {
+    return instance->setUndistortion(cv::Mat(), cv::Mat(), 0, 0) ? JNI_TRUE
+                                                                 : JNI_FALSE;
+  }
+  if (env->GetArrayLength(cameraMatrix) != 9 || !distCoeffs)
+    return JNI_FALSE;
+
+  cv::Mat matrix(3, 3, CV_64F);
+  env->GetDoubleArrayRegion(cameraMatrix, 0, 9, matrix.ptr<jdouble>());
+  jsize distCount = env->GetArrayLength(distCoeffs);
+  cv::Mat dist(1, distCount, CV_64F);
+  env->GetDoubleArrayRegion(distCoeffs, 0, distCount, dist.ptr<jdouble>());
+
+  return instance->setUndistortion(matrix, dist, calibWidth, calibHeight)
+             ? JNI_TRUE
+             : JNI_FALSE;
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    setThreshold
+ * Signature: (J[I)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_setThreshold(
+    JNIEnv *env, jclass, jlong handle, jintArray config) {
+  auto instance = getCameraInstance(handle);
+  if (!instance)
+    return JNI_FALSE;
+
+  if (!config) {
+    return instance->setThreshold(nullptr) ? JNI_TRUE : JNI_FALSE;
+  }
+  if (env->GetArrayLength(config) != 9)
+    return JNI_FALSE;
+
+  jint values[9];
+  env->GetIntArrayRegion(config, 0, 9, values);
+  ThresholdConfig threshold;
+  threshold.hueLow = values[0];
+  threshold.hueHigh = values[1];
+  threshold.satLow = values[2];
+  threshold.satHigh = values[3];
+  threshold.valLow = values[4];
+  threshold.valHigh = values[5];
+  threshold.downsample = values[6];
+  threshold.morphology = values[7];
+  threshold.morphKernel = values[8];
+  return instance->setThreshold(&threshold) ? JNI_TRUE : JNI_FALSE;
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    takeMask
+ * Signature: (J)J
+ */
+JNIEXPORT jlong JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_takeMask(
+    JNIEnv *, jclass, jlong handle) {
+  auto instance = getCameraInstance(handle);
+  if (!instance)
+    return 0;
+
+  auto mask = instance->takeMask();
+  if (!mask || mask->empty())
+    return 0;
+
+  return reinterpret_cast<jlong>(new cv::Mat(mask->clone()));
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    takeMaskInto
+ * Signature: (JLjava/nio/ByteBuffer;)J
+ */
+JNIEXPORT jlong JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_takeMaskInto(
+    JNIEnv *env, jclass, jlong handle, jobject buffer) {
+  auto instance = getCameraInstance(handle);
+  if (!instance || !buffer)
+    return -1;
+
+  auto *out = static_cast<uint8_t *>(env->GetDirectBufferAddress(buffer));
+  jlong capacity = env->GetDirectBufferCapacity(buffer);
+  if (!out || capacity < 0)
+    return -1;
+
+  auto mask = instance->takeMask();
+  if (!mask || mask->empty())
+    return 0;
+
+  // Masks are allocated per frame, so they are always continuous.
+  jlong size = static_cast<jlong>(mask->total());
+  if (size > capacity)
+    return -size;
+
+  std::memcpy(out, mask->data, size);
+  return size;
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    configureTagDetection
+ * Signature: (JIID)Z
+ */
+JNIEXPORT jboolean JNICALL
+Java_org_teamdeadbolts_basler_BaslerJNI_configureTagDetection(
+    JNIEnv *, jclass, jlong handle, jint family, jint decimate,
+    jdouble minDecisionMargin) {
+  auto instance = getCameraInstance(handle);
+  if (!instance)
+    return JNI_FALSE;
+
+  if (family < 0) {
+    return instance->configureTagDetection(nullptr) ? JNI_TRUE : JNI_FALSE;
+  }
+  if (family > kTag16h5)
+    return JNI_FALSE;
+
+  TagDetectorConfig config;
+  config.family = family;
+  config.decimate = decimate;
+  config.minDecisionMargin = minDecisionMargin;
+  return instance->configureTagDetection(&config) ? JNI_TRUE : JNI_FALSE;
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    getTagDetectionsRaw
+ * Signature: (J[J[D)I
+ */
+JNIEXPORT jint JNICALL
+Java_org_teamdeadbolts_basler_BaslerJNI_getTagDetectionsRaw(
+    JNIEnv *env, jclass, jlong handle, jlongArray info, jdoubleArray tags) {
+  constexpr int kInfoLongs = 4;
+  constexpr int kTagDoubles = 10;
+
+  auto instance = getCameraInstance(handle);
+  if (!instance || !info || !tags || env->GetArrayLength(info) < kInfoLongs)
+    return -1;
+
+  TagDetectionResult result;
+  if (!instance->getTagDetections(result))
+    return -1;
+
+  jlong infoValues[kInfoLongs] = {static_cast<jlong>(result.sequence),
+                                  result.hostTimestampNs,
+                                  static_cast<jlong>(result.cameraTimestamp),
+                                  result.latencyNs};
+  env->SetLongArrayRegion(info, 0, kInfoLongs, infoValues);
+
+  int count = static_cast<int>(result.detections.size());
+  int fit = std::min(count, env->GetArrayLength(tags) / kTagDoubles);
+  if (fit > 0) {
+    std::vector<jdouble> values(static_cast<size_t>(fit) * kTagDoubles);
+    for (int i = 0; i < fit; i++) {
+      const TagDetection &detection = result.detections[i];
+      jdouble *out = values.data() + i * kTagDoubles;
+      out[0] = detection.id;
+      out[1] = detection.decisionMargin;
+      std::copy(detection.corners, detection.corners + 8, out + 2);
+    }
+    env->SetDoubleArrayRegion(tags, 0, fit * kTagDoubles, values.data());
+  }
+  return count;
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    configureChangeDetection
+ * Signature: (JIDI)Z
+ */
+JNIEXPORT jboolean JNICALL
+Java_org_teamdeadbolts_basler_BaslerJNI_configureChangeDetection(
+    JNIEnv *, jclass, jlong handle, jint gridStep, jdouble suppressBelow,
+    jint maxSuppressed) {
+  auto instance = getCameraInstance(handle);
+  if (!instance)
+    return JNI_FALSE;
+
+  if (gridStep <= 0) {
+    return instance->configureChangeDetection(nullptr) ? JNI_TRUE : JNI_FALSE;
+  }
+
+  ChangeDetectorConfig config;
+  config.gridStep = gridStep;
+  config.suppressBelow = suppressBelow;
+  config.maxSuppressed = std::max(maxSuppressed, 0);
+  return instance->configureChangeDetection(&config) ? JNI_TRUE : JNI_FALSE;
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    configureExposureBracketing
+ * Signature: (J[DZZI)I
+ */
+JNIEXPORT jint JNICALL
+Java_org_teamdeadbolts_basler_BaslerJNI_configureExposureBracketing(
+    JNIEnv *env, jclass, jlong handle, jdoubleArray exposuresUs,
+    jboolean preferSequencer, jboolean fuse, jint fusionKnee) {
+  auto instance = getCameraInstance(handle);
+  if (!instance)
+    return -1;
+
+  if (!exposuresUs) {
+    return instance->configureExposureBracketing(nullptr);
+  }
+
+  BracketConfig config;
+  config.exposuresUs.resize(env->GetArrayLength(exposuresUs));
+  env->GetDoubleArrayRegion(exposuresUs, 0,
+                            static_cast<jsize>(config.exposuresUs.size()),
+                            config.exposuresUs.data());
+  config.preferSequencer = preferSequencer;
+  config.fuse = fuse;
+  config.fusionKnee = fusionKnee;
+  return instance->configureExposureBracketing(&config);
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    takeFusedFrame
+ * Signature: (J)J
+ */
+JNIEXPORT jlong JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_takeFusedFrame(
+    JNIEnv *, jclass, jlong handle) {
+  auto instance = getCameraInstance(handle);
+  if (!instance)
+    return 0;
+
+  auto fused = instance->takeFusedFrame();
+  if (!fused || fused->empty())
+    return 0;
+
+  return reinterpret_cast<jlong>(new cv::Mat(fused->clone()));
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    setLatencyTestMode
+ * Signature: (JZ)Z
+ */
+JNIEXPORT jboolean JNICALL
+Java_org_teamdeadbolts_basler_BaslerJNI_setLatencyTestMode(JNIEnv *, jclass,
+                                                            jlong handle,
+                                                            jboolean enable) {
+  auto instance = getCameraInstance(handle);
+  if (!instance)
+    return JNI_FALSE;
+
+  return instance->setLatencyTestMode(enable) ? JNI_TRUE : JNI_FALSE;
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    getLatencyTrace
+ * Signature: (JJ[J)Z
+ */
+JNIEXPORT jboolean JNICALL
+Java_org_teamdeadbolts_basler_BaslerJNI_getLatencyTrace(JNIEnv *env, jclass,
+                                                         jlong handle,
+                                                         jlong sequence,
+                                                         jlongArray out) {
+  constexpr jsize kTraceLongs = 7;
+
+  auto instance = getCameraInstance(handle);
+  if (!instance || !out || env->GetArrayLength(out) < kTraceLongs)
+    return JNI_FALSE;
+
+  LatencyTrace trace;
+  if (!instance->getLatencyTrace(static_cast<uint64_t>(sequence), trace))
+    return JNI_FALSE;
+
+  jlong values[kTraceLongs] = {static_cast<jlong>(trace.sequence),
+                               static_cast<jlong>(trace.blockId),
+                               trace.captureNs,
+                               trace.retrievedNs,
+                               trace.convertedNs,
+                               trace.publishedNs,
+                               trace.takenNs};
+  env->SetLongArrayRegion(out, 0, kTraceLongs, values);
+  return JNI_TRUE;
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    negotiatePixelFormatRaw
+ * Signature: (JIZ[Ljava/lang/String;)I
+ */
+JNIEXPORT jint JNICALL
+Java_org_teamdeadbolts_basler_BaslerJNI_negotiatePixelFormatRaw(
+    JNIEnv *env, jclass, jlong handle, jint intent, jboolean apply,
+    jobjectArray reasoning) {
+  auto instance = getCameraInstance(handle);
+  if (!instance)
+    return -1;
+
+  std::string text;
+  int format = instance->negotiatePixelFormat(intent, apply, text);
+  if (reasoning && env->GetArrayLength(reasoning) > 0) {
+    jstring jText = env->NewStringUTF(text.c_str());
+    env->SetObjectArrayElement(reasoning, 0, jText);
+    env->DeleteLocalRef(jText);
+  }
+  return format;
+}
+
+// Returns the calling thread's JNIEnv, attaching it as a daemon the first
+// time. Threads attached here detach when they exit.
+static JNIEnv *attachLogThread() {
+  struct Detacher {
+    bool attached = false;
+    ~Detacher() {
+      if (attached)
+        logJvm->DetachCurrentThread();
+    }
+  };
+  thread_local Detacher detacher;
+
+  JNIEnv *env = nullptr;
+  if (logJvm->GetEnv(reinterpret_cast<void **>(&env), JNI_VERSION_1_8) ==
+      JNI_OK)
+    return env;
+  if (logJvm->AttachCurrentThreadAsDaemon(reinterpret_cast<void **>(&env),
+                                          nullptr) != JNI_OK)
+    return nullptr;
+  detacher.attached = true;
+  return env;
+}
+
+// Log sink that hands a whole batch to BaslerJNI.dispatchNativeLogs in one
+// call, so the JNI transition is paid per batch rather than per record.
+static void forwardLogsToJava(const LogRecord *records, size_t count) {
+  JNIEnv *env = attachLogThread();
+  if (!env)
+    return;
+
+  jsize length = static_cast<jsize>(count);
+  if (env->PushLocalFrame(6 + 2 * length) != JNI_OK) {
+    env->ExceptionClear();
+    return;
+  }
+
+  std::vector<jlong> times(count);
+  std::vector<jint> levels(count);
+  std::vector<jint> suppressed(count);
+  jobjectArray sites = env->NewObjectArray(length, logStringClass, nullptr);
+  jobjectArray messages = env->NewObjectArray(length, logStringClass, nullptr);
+  jlongArray jTimes = env->NewLongArray(length);
+  jintArray jLevels = env->NewIntArray(length);
+  jintArray jSuppressed = env->NewIntArray(length);
+  if (sites && messages && jTimes && jLevels && jSuppressed) {
+    for (jsize i = 0; i < length; i++) {
+      times[i] = records[i].timeNs;
+      levels[i] = records[i].level;
+      suppressed[i] = static_cast<jint>(records[i].suppressed);
+      env->SetObjectArrayElement(sites, i,
+                                 env->NewStringUTF(records[i].site));
+      env->SetObjectArrayElement(messages, i,
+                                 env->NewStringUTF(records[i].message));
+    }
+    env->SetLongArrayRegion(jTimes, 0, length, times.data());
+    env->SetIntArrayRegion(jLevels, 0, length, levels.data());
+    env->SetIntArrayRegion(jSuppressed, 0, length, suppressed.data());
+    env->CallStaticVoidMethod(logClass, logDispatch, jTimes, jLevels,
+                              jSuppressed, sites, messages);
+  }
+  // Neither a failed allocation nor a throwing listener may escape into the
+  // log thread.
+  if (env->ExceptionCheck())
+    env->ExceptionClear();
+  env->PopLocalFrame(nullptr);
+}
+
+static void disableLogForwarding(JNIEnv *env) {
+  // Waits for a batch in flight, after which nothing reads the globals.
+  NativeLog::instance().setSink(nullptr);
+  if (logClass) {
+    env->DeleteGlobalRef(logClass);
+    env->DeleteGlobalRef(logStringClass);
+    logClass = nullptr;
+    logStringClass = nullptr;
+    logDispatch = nullptr;
+  }
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    configureNativeLog
+ * Signature: (II)Z
+ */
+JNIEXPORT jboolean JNICALL
+Java_org_teamdeadbolts_basler_BaslerJNI_configureNativeLog(
+    JNIEnv *, jclass, jint minLevel, jint perSiteLimit) {
+  if (minLevel < kLogTrace || minLevel > kLogOff || perSiteLimit < 0)
+    return JNI_FALSE;
+
+  NativeLog &log = NativeLog::instance();
+  log.setLevel(static_cast<LogLevel>(minLevel));
+  log.setRateLimit(perSiteLimit);
+  return JNI_TRUE;
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    setNativeLogForwarding
+ * Signature: (Z)Z
+ */
+JNIEXPORT jboolean JNICALL
+Java_org_teamdeadbolts_basler_BaslerJNI_setNativeLogForwarding(
+    JNIEnv *env, jclass clazz, jboolean enable) {
+  disableLogForwarding(env);
+  if (!enable)
+    return JNI_TRUE;
+
+  jmethodID dispatch = env->GetStaticMethodID(
+      clazz, "dispatchNativeLogs",
+      "([J[I[I[Ljava/lang/String;[Ljava/lang/String;)V");
+  jclass stringClass = env->FindClass("java/lang/String");
+  if (!dispatch || !stringClass) {
+    env->ExceptionClear();
+    return JNI_FALSE;
+  }
+  if (env->GetJavaVM(&logJvm) != JNI_OK)
+    return JNI_FALSE;
+
+  logClass = static_cast<jclass>(env->NewGlobalRef(clazz));
+  logStringClass = static_cast<jclass>(env->NewGlobalRef(stringClass));
+  logDispatch = dispatch;
+  NativeLog::instance().setSink(forwardLogsToJava);
+  return JNI_TRUE;
+}
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    flushNativeLog
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL
+Java_org_teamdeadbolts_basler_BaslerJNI_flushNativeLog(JNIEnv *, jclass) {
+  NativeLog::instance().flush();
+}
+
+JNIEXPORT void JNICALL
+Java_org_teamdeadbolts_basler_BaslerJNI_cleanUp(JNIEnv *env, jclass) {
+  cameras.clear();
+  ConversionPool::instance().shutdown();
+  DeviceCache::instance().clear();
   if (pylonInit) {
     PylonTerminate();
     pylonInit = false;
   }
+  // Last, so messages from the teardown above still reach the listener.
+  disableLogForwarding(env);
+  NativeLog::instance().shutdown();
 }
@@ -1,54 +1,241 @@
 #include "camera_instance.hpp"
+#include "bandwidth_balancer.hpp"
+#include "device_cache.hpp"
+#include "frame_conversion.hpp"
+#include "native_log.hpp"
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <limits>
 #include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
 #include <opencv2/imgproc.hpp>
+#include <pthread.h>
 #include <pylon/BaslerUniversalInstantCamera.h>
 #include <pylon/PylonIncludes.h>
 
 using namespace Pylon;
 using namespace Basler_UniversalCameraParams;
 
+namespace {
+
+// Returned by retrieveFrame for a frame dropped by change detection. Never
+// leaves this file; callers turn it into a wait for the next frame.
+constexpr int kFrameSuppressed = -1;
+
+int64_t steadyNowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// OpenCV type of a grab buffer and the cvtColor code that turns it into the
+// delivered frame (-1 for none).
+void grabLayout(EPixelType pixelType, int &cvType, int &colorCvt) {
+  colorCvt = -1;
+  switch (pixelType) {
+  case PixelType_Mono8:
+    cvType = CV_8UC1;
+    // colorCvt = cv::COLOR_GRAY2BGR;
+    break;
+  case PixelType_BGR8packed:
+    cvType = CV_8UC3;
+    break;
+  case PixelType_RGB8packed:
+    cvType = CV_8UC3;
+    colorCvt = cv::COLOR_RGB2BGR;
+    break;
+  case PixelType_YUV422_YUYV_Packed:
+  case PixelType_YUV422packed:
+    cvType = CV_8UC2;
+    colorCvt = cv::COLOR_YUV2BGR_YUYV;
+    break;
+  case PixelType_YCbCr422_8_YY_CbCr_Semiplanar:
+    cvType = CV_8UC2;
+    colorCvt = cv::COLOR_YUV2BGR_UYVY;
+    break;
+  // OpenCV names Bayer patterns by the second row's first two pixels, so
+  // GenICam's RG is OpenCV's BG and so on.
+  case PixelType_BayerRG8:
+    cvType = CV_8UC1;
+    colorCvt = cv::COLOR_BayerBG2BGR;
+    break;
+  case PixelType_BayerBG8:
+    cvType = CV_8UC1;
+    colorCvt = cv::COLOR_BayerRG2BGR;
+    break;
+  case PixelType_BayerGR8:
+    cvType = CV_8UC1;
+    colorCvt = cv::COLOR_BayerGB2BGR;
+    break;
+  case PixelType_BayerGB8:
+    cvType = CV_8UC1;
+    colorCvt = cv::COLOR_BayerGR2BGR;
+    break;
+  default:
+    throw std::runtime_error("Unsupported pixel format");
+  }
+}
+
+// Where ChangeDetector finds a luma-like byte in a raw pixel. Any byte works
+// as long as it is the same one every frame; green stands in for RGB.
+bool lumaLayout(EPixelType pixelType, int &pixelBytes, int &lumaOffset) {
+  switch (pixelType) {
+  case PixelType_Mono8:
+  // Even grid steps always land on the same Bayer colour.
+  case PixelType_BayerRG8:
+  case PixelType_BayerBG8:
+  case PixelType_BayerGR8:
+  case PixelType_BayerGB8:
+    pixelBytes = 1;
+    lumaOffset = 0;
+    return true;
+  case PixelType_BGR8packed:
+  case PixelType_RGB8packed:
+    pixelBytes = 3;
+    lumaOffset = 1;
+    return true;
+  case PixelType_YUV422_YUYV_Packed:
+  case PixelType_YUV422packed:
+    pixelBytes = 2;
+    lumaOffset = 0;
+    return true;
+  case PixelType_YCbCr422_8_YY_CbCr_Semiplanar:
+    pixelBytes = 2;
+    lumaOffset = 1;
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool isBayer8Name(const std::string &name) {
+  return name == "BayerRG8" || name == "BayerBG8" || name == "BayerGR8" ||
+         name == "BayerGB8";
+}
+
+// Maps a camera pixel format onto the PixelFormat ordinal used on the Java
+// side, -1 for formats the library cannot deliver.
+int toJavaPixelFormat(PixelFormatEnums format) {
+  switch (format) {
+  case PixelFormat_RGB8:
+    return 4; // kBGR;
+  case PixelFormat_YCbCr422_8:
+    return 7; // kUYVY
+  case PixelFormat_Mono8:
+    return 5; // kGray
+  case PixelFormat_BayerRG8:
+  case PixelFormat_BayerBG8:
+  case PixelFormat_BayerGR8:
+  case PixelFormat_BayerGB8:
+    return kPixelFormatBayer8;
+  default:
+    return -1;
+  }
+}
+
+} // namespace
+
+template <typename Fn> void CameraInstance::recordSettings(Fn &&update) {
+  std::lock_guard<std::mutex> lock(settingsMutex);
+  update(settings);
+}
+
+template <typename Fn> bool CameraInstance::withAcquisitionStopped(Fn &&fn) {
+  AutoLock deviceLock(camera->GetLock());
+  bool wasGrabbing = camera->IsGrabbing();
+  if (wasGrabbing) {
+    stop();
+  }
+  bool ok = false;
+  try {
+    ok = fn();
+  } catch (const GenericException &e) {
+    // Still restart below so a failed bulk write does not leave the camera
+    // stopped.
+    BJNI_LOG_ERROR("CameraInstance::withAcquisitionStopped",
+                   "Exception: " << e.GetDescription());
+  }
+  if (wasGrabbing) {
+    ok = start() && ok;
+  }
+  return ok;
+}
+
 CameraInstance::CameraInstance(IPylonDevice *device)
-    : camera(std::make_unique<CBaslerUniversalInstantCamera>(device)) {
+    : camera(std::make_unique<CBaslerUniversalInstantCamera>(device)),
+      serial(device->GetDeviceInfo().GetSerialNumber()) {
+  camera->RegisterConfiguration(&removalHandler, RegistrationMode_Append,
+                                Cleanup_None);
   try {
     camera->Open();
   } catch (const GenericException &e) {
-    std::cout
-        << "[CameraInstance::CameraInstance] Exception during camera open: "
-        << e.GetDescription() << std::endl;
+    BJNI_LOG_ERROR("CameraInstance::CameraInstance",
+                   "Exception during camera open: " << e.GetDescription());
+    // Let the reconnect thread keep trying, e.g. while another process
+    // still holds the device.
+    connectionState.store(kDisconnected);
   }
+  reconnectThread = std::thread(&CameraInstance::reconnectLoop, this);
 }
 
 CameraInstance::~CameraInstance() {
+  if (inBandwidthBalancer.exchange(false)) {
+    BandwidthBalancer::instance().leave(this);
+  }
+  stopSoftwareAutoExposure();
+  stopTagDetection();
+  stopBracketWriter();
+
+  {
+    std::lock_guard<std::mutex> lock(reconnectMutex);
+    shuttingDown = true;
+  }
+  reconnectCv.notify_all();
+  reconnectThread.join();
+
   try {
+    camera->DeregisterConfiguration(&removalHandler);
     CameraInstance::stop();
 
     camera->Close();
   } catch (const GenericException &e) {
-    std::cout
-        << "[CameraInstance::~CameraInstance] Exception during camera close: "
-        << e.GetDescription() << std::endl;
+    BJNI_LOG_ERROR("CameraInstance::~CameraInstance",
+                   "Exception during camera close: " << e.GetDescription());
   }
 }
 
 bool CameraInstance::start() {
+  AutoLock deviceLock(camera->GetLock());
+  wantGrabbing.store(true);
+  if (connectionState.load() != kConnected) {
+    // Grabbing resumes once the reconnect thread has the device back.
+    return false;
+  }
+
   try {
     if (!camera->IsOpen()) {
       camera->Open();
     }
     camera->AcquisitionMode.SetValue(AcquisitionMode_Continuous);
+    applyUsbTransport();
     camera->AcquisitionStart.Execute();
+    lastBlockId = 0;
     camera->StartGrabbing(GrabStrategy_LatestImages);
 
     return true;
   } catch (const GenericException &e) {
-    std::cout << "[CameraInstance::start] Exception during camera start: "
-              << e.GetDescription() << std::endl;
+    BJNI_LOG_ERROR("CameraInstance::start",
+                   "Exception during camera start: " << e.GetDescription());
     return false;
   }
 }
 
 bool CameraInstance::stop() {
+  AutoLock deviceLock(camera->GetLock());
+  wantGrabbing.store(false);
   try {
     if (camera->IsGrabbing()) {
       camera->StopGrabbing();
@@ -57,175 +244,680 @@ bool CameraInstance::stop() {
     camera->AcquisitionStop.Execute();
     return true;
   } catch (const GenericException &e) {
-    std::cout << "[CameraInstance::stop] Exception during camera stop: "
-              << e.GetDescription() << std::endl;
+    BJNI_LOG_ERROR("CameraInstance::stop",
+                   "Exception during camera stop: " << e.GetDescription());
     return false;
   }
 }
 
-void CameraInstance::awaitNewFrame() {
+int CameraInstance::awaitNewFrame(int timeoutMs) {
+  auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+  // A second caller queues here; the time spent waiting counts against its
+  // timeout.
+  std::unique_lock<std::mutex> grabLock(grabMutex);
+  int status;
+  while (true) {
+    // Pylon treats 0xFFFFFFFF as an infinite timeout.
+    unsigned int waitMs = std::numeric_limits<unsigned int>::max();
+    if (timeoutMs >= 0) {
+      auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+          deadline - std::chrono::steady_clock::now());
+      waitMs = static_cast<unsigned int>(std::max<int64_t>(left.count(), 0));
+    }
+    status = retrieveFrame(waitMs);
+    if (status != kFrameSuppressed) {
+      break;
+    }
+    // Suppressed frames don't count as new; keep waiting for one that is.
+    if (timeoutMs >= 0 && std::chrono::steady_clock::now() >= deadline) {
+      status = kFrameTimeout;
+      break;
+    }
+  }
+  grabLock.unlock();
+  if (status == kFrameTimeout) {
+    stats.grabTimeouts.fetch_add(1, std::memory_order_relaxed);
+  }
+  return status;
+}
+
+int CameraInstance::pollFrame(uint64_t lastSequence) {
+  // Pick up a result Pylon already has queued, but never wait for one, nor
+  // for another thread that is retrieving.
+  int status = kFrameTimeout;
+  std::unique_lock<std::mutex> grabLock(grabMutex, std::try_to_lock);
+  if (grabLock.owns_lock()) {
+    status = retrieveFrame(0);
+    grabLock.unlock();
+  }
+  if (status == kFrameSuppressed) {
+    status = kFrameTimeout;
+  }
+  if (status == kFrameTimeout &&
+      mailbox.sequence() > lastSequence) {
+    return kFrameNew;
+  }
+  return status;
+}
+
+uint64_t CameraInstance::getFrameSequence() const {
+  return mailbox.sequence();
+}
+
+int64_t CameraInstance::getLastGrabError() const {
+  return lastGrabError.load(std::memory_order_relaxed);
+}
+
+int CameraInstance::retrieveFrame(unsigned int timeoutMs) {
+  if (connectionState.load(std::memory_order_relaxed) != kConnected) {
+    return kFrameDisconnected;
+  }
+
   try {
     if (!camera->IsGrabbing()) {
-      // std::cout
-      //     << "[CameraInstance::awaitNewFrame] Warning: called await new frame "
-      //        "but the camera is not grabbing, call startCamera() first."
-      //     << std::endl;
-    }
-    while (camera->IsGrabbing()) {
-      CGrabResultPtr grabResult;
-      try {
-        if (camera->RetrieveResult(5000, grabResult,
-                                   TimeoutHandling_ThrowException)) {
-          if (grabResult->GrabSucceeded()) {
-            std::lock_guard<std::mutex> lock(frameMutex);
-            currentGrabResult = grabResult;
-            currentFramePtr = convertToMat(grabResult);
-            return;
-          }
-        }
-      } catch (const TimeoutException &e) {
-        std::cout << "[CameraInstance::awaitNewFrame] Timeout while waiting "
-                     "for frame: "
-                  << e.GetDescription() << std::endl;
-        return;
-      }
+      return kFrameNotGrabbing;
+    }
+
+    CBaslerUniversalGrabResultPtr grabResult;
+    if (!camera->RetrieveResult(timeoutMs, grabResult,
+                                TimeoutHandling_Return)) {
+      // A removal during the wait surfaces here as a plain timeout.
+      return connectionState.load() == kConnected ? kFrameTimeout
+                                                  : kFrameDisconnected;
+    }
+
+    if (!grabResult->GrabSucceeded()) {
+      stats.grabFailures.fetch_add(1, std::memory_order_relaxed);
+      lastGrabError.store(grabResult->GetErrorCode(),
+                          std::memory_order_relaxed);
+      return kFrameGrabFailed;
+    }
+
+    // LatestImages drops frames the app didn't take in time; anything
+    // missing beyond those never made it across the link.
+    uint64_t skipped = grabResult->GetNumberOfSkippedImages();
+    uint64_t blockId = grabResult->GetBlockID();
+    if (skipped > 0) {
+      stats.framesSkipped.fetch_add(skipped, std::memory_order_relaxed);
+    }
+    // Block IDs restart (GigE wraps at 16 bits) or are 0 when unsupported.
+    if (lastBlockId != 0 && blockId > lastBlockId + 1 + skipped) {
+      stats.blockIdGaps.fetch_add(blockId - lastBlockId - 1 - skipped,
+                                  std::memory_order_relaxed);
+    }
+    lastBlockId = blockId;
+
+    // Only the grabMutex holder advances the sequence, so the next value is
+    // known.
+    uint64_t sequence = mailbox.sequence() + 1;
+    FrameMetadata metadata = parseMetadata(grabResult, sequence);
+    bool tracing = latencyMode.load(std::memory_order_relaxed) &&
+                   grabResult->GetPayloadSize() >=
+                       static_cast<size_t>(kLatencyStampBytes);
+    if (tracing) {
+      // Stamp the pixels so the receiver can prove which retrieve it got.
+      uint64_t stamp[3] = {blockId, sequence,
+                           static_cast<uint64_t>(metadata.hostTimestampNs)};
+      std::memcpy(grabResult->GetBuffer(), stamp, sizeof(stamp));
+    }
+    tagBracket(grabResult, metadata);
+    if (!scoreChange(grabResult, metadata)) {
+      stats.framesSuppressed.fetch_add(1, std::memory_order_relaxed);
+      return kFrameSuppressed;
+    }
+
+    std::shared_ptr<cv::Mat> mask;
+    auto frame = convertToMat(grabResult, mask);
+    auto fused = fuseBracket(frame, metadata);
+    int64_t convertedNs = tracing ? steadyNowNs() : 0;
+    recordHistory(grabResult, *frame, metadata);
+    if (histogramEnabled.load(std::memory_order_relaxed)) {
+      publishHistogram(*frame, sequence);
+    }
+    if (tagEnabled.load(std::memory_order_relaxed)) {
+      submitTagFrame(frame, metadata);
+    }
+
+    currentGrabResult = grabResult;
+    if (fused) {
+      std::lock_guard<std::mutex> lock(fusedMutex);
+      currentFusedPtr = fused;
+    }
+    if (tracing) {
+      std::lock_guard<std::mutex> traceLock(latencyMutex);
+      LatencyTrace &trace = latencySlot(sequence);
+      trace.sequence = sequence;
+      trace.blockId = blockId;
+      trace.captureNs = cameraToHostNs(grabResult->GetTimeStamp());
+      trace.retrievedNs = metadata.hostTimestampNs;
+      trace.convertedNs = convertedNs;
+      trace.publishedNs = steadyNowNs();
+      trace.takenNs = 0;
     }
+    mailbox.publish({frame, mask, metadata});
+    stats.framesGrabbed.fetch_add(1, std::memory_order_relaxed);
+    return kFrameNew;
   } catch (const GenericException &e) {
-    std::cout << "[CameraInstance::awaitNewFrame] Exception during frame grab: "
-              << e.GetDescription() << std::endl;
+    if (connectionState.load() != kConnected) {
+      return kFrameDisconnected;
+    }
+    BJNI_LOG_ERROR("CameraInstance::retrieveFrame",
+                   "Exception during frame grab: " << e.GetDescription());
+  } catch (const std::exception &e) {
+    BJNI_LOG_ERROR("CameraInstance::retrieveFrame",
+                   "Exception converting frame: " << e.what());
+  }
+
+  stats.grabFailures.fetch_add(1, std::memory_order_relaxed);
+  lastGrabError.store(-1, std::memory_order_relaxed);
+  return kFrameGrabFailed;
+}
+
+std::array<double, kStatCount> CameraInstance::getStats() const {
+  AutoLock deviceLock(camera->GetLock());
+  auto values = stats.snapshot();
+
+  try {
+    auto &streamParams = camera->GetStreamGrabberParams();
+    auto readCounter = [&values](auto &param, CameraStat index) {
+      if (param.IsReadable()) {
+        values[index] = static_cast<double>(param.GetValue());
+      }
+    };
+    readCounter(streamParams.Statistic_Resend_Request_Count,
+                kStatResendRequests);
+    readCounter(streamParams.Statistic_Resend_Packet_Count,
+                kStatResendPackets);
+    readCounter(streamParams.Statistic_Buffer_Underrun_Count,
+                kStatBufferUnderruns);
+    readCounter(streamParams.Statistic_Failed_Buffer_Count,
+                kStatFailedBuffers);
+    readCounter(streamParams.Statistic_Total_Buffer_Count, kStatTotalBuffers);
+    readCounter(streamParams.Statistic_Missed_Frame_Count, kStatMissedFrames);
+    readCounter(streamParams.Statistic_Resynchronization_Count, kStatResyncs);
+  } catch (const GenericException &e) {
+    // No stream grabber while disconnected; report the host-side counters.
   }
+  return values;
+}
+
+void CameraInstance::setOpenTime(double ms) {
+  stats.openTimeMs.store(ms, std::memory_order_relaxed);
 }
 
 std::shared_ptr<cv::Mat> CameraInstance::takeFrame() {
-  std::lock_guard<std::mutex> lock(frameMutex);
-  return currentFramePtr; // TODO: Maybe dont clone?
+  if (!latencyMode.load(std::memory_order_relaxed)) {
+    // Shared, not copied; the JNI layer clones it for Java.
+    return mailbox.frame();
+  }
+
+  PublishedFrame published = mailbox.latest();
+  if (published.frame) {
+    std::lock_guard<std::mutex> traceLock(latencyMutex);
+    LatencyTrace &trace = latencySlot(published.metadata.sequence);
+    if (trace.sequence == published.metadata.sequence && trace.takenNs == 0) {
+      trace.takenNs = steadyNowNs();
+    }
+  }
+  return published.frame;
+}
+
+int64_t CameraInstance::copyFrameRegions(const int *rects, int count,
+                                         uint8_t *out, size_t capacity,
+                                         int *layout) {
+  // The shared_ptr keeps the frame alive even if a newer one is published
+  // while we copy.
+  auto frame = takeFrame();
+  if (!frame || frame->empty()) {
+    return 0;
+  }
+
+  cv::Rect bounds(0, 0, frame->cols, frame->rows);
+  size_t elemSize = frame->elemSize();
+  // Offsets go back through int layout entries, so the packed size has to
+  // stay within int range.
+  constexpr int64_t maxPacked = std::numeric_limits<int>::max();
+  int64_t offset = 0;
+  for (int i = 0; i < count; i++) {
+    const int *rect = rects + i * kRegionRectInts;
+    cv::Rect region =
+        cv::Rect(rect[0], rect[1], rect[2], rect[3]) & bounds;
+    int64_t stride =
+        static_cast<int64_t>(region.width) * static_cast<int64_t>(elemSize);
+    int64_t size = stride * region.height;
+    if (size > maxPacked - offset) {
+      BJNI_LOG_WARN("CameraInstance::copyFrameRegions",
+                    "Regions need more than " << maxPacked << " bytes");
+      return kRegionError;
+    }
+
+    int *entry = layout + i * kRegionLayoutInts;
+    entry[0] = static_cast<int>(offset);
+    entry[1] = static_cast<int>(stride);
+    entry[2] = region.width;
+    entry[3] = region.height;
+    entry[4] = frame->channels();
+    offset += size;
+  }
+
+  if (static_cast<size_t>(offset) > capacity) {
+    return -offset;
+  }
+
+  for (int i = 0; i < count; i++) {
+    const int *entry = layout + i * kRegionLayoutInts;
+    int width = entry[2];
+    int height = entry[3];
+    if (width == 0 || height == 0) {
+      continue;
+    }
+    const int *rect = rects + i * kRegionRectInts;
+    int x = std::max(rect[0], 0);
+    int y = std::max(rect[1], 0);
+    uint8_t *dst = out + entry[0];
+    size_t stride = static_cast<size_t>(entry[1]);
+    for (int row = 0; row < height; row++) {
+      std::memcpy(dst + row * stride, frame->ptr(y + row) + x * elemSize,
+                  stride);
+    }
+  }
+  return offset;
+}
+
+void CameraInstance::recordHistory(const CGrabResultPtr &grabResult,
+                                   const cv::Mat &converted,
+                                   const FrameMetadata &metadata) {
+  auto ring = std::atomic_load(&history);
+  if (!ring) {
+    return;
+  }
+
+  if (historyRaw.load(std::memory_order_relaxed)) {
+    int cvType;
+    int colorCvt;
+    grabLayout(grabResult->GetPixelType(), cvType, colorCvt);
+    cv::Mat raw(grabResult->GetHeight(), grabResult->GetWidth(), cvType,
+                (uint8_t *)grabResult->GetBuffer());
+    ring->push(metadata, raw, colorCvt);
+  } else {
+    ring->push(metadata, converted, -1);
+  }
+}
+
+FrameMetadata
+CameraInstance::parseMetadata(const CBaslerUniversalGrabResultPtr &grabResult,
+                              uint64_t sequence) {
+  FrameMetadata metadata;
+  metadata.sequence = sequence;
+  metadata.hostTimestampNs = steadyNowNs();
+  metadata.cameraTimestamp = grabResult->GetTimeStamp();
+
+  if (!chunksEnabled.load(std::memory_order_relaxed) ||
+      !grabResult->IsChunkDataAvailable()) {
+    return metadata;
+  }
+
+  // The chunk nodes read straight from the payload, so none of this touches
+  // the device.
+  if (grabResult->ChunkTimestamp.IsReadable()) {
+    metadata.cameraTimestamp = grabResult->ChunkTimestamp.GetValue();
+    metadata.fields |= FrameMetadata::kChunkTimestamp;
+  }
+  if (grabResult->ChunkExposureTime.IsReadable()) {
+    metadata.exposureUs = grabResult->ChunkExposureTime.GetValue();
+    metadata.fields |= FrameMetadata::kExposure;
+  }
+  if (grabResult->ChunkGain.IsReadable()) {
+    metadata.gain = grabResult->ChunkGain.GetValue();
+    metadata.fields |= FrameMetadata::kGain;
+  }
+  if (grabResult->ChunkLineStatusAll.IsReadable()) {
+    metadata.lineStatus = grabResult->ChunkLineStatusAll.GetValue();
+    metadata.fields |= FrameMetadata::kLineStatus;
+  }
+  // GigE models call the counter Framecounter, USB models CounterValue.
+  if (grabResult->ChunkFramecounter.IsReadable()) {
+    metadata.frameCounter = grabResult->ChunkFramecounter.GetValue();
+    metadata.fields |= FrameMetadata::kFrameCounter;
+  } else if (grabResult->ChunkCounterValue.IsReadable()) {
+    metadata.frameCounter = grabResult->ChunkCounterValue.GetValue();
+    metadata.fields |= FrameMetadata::kFrameCounter;
+  }
+  return metadata;
+}
+
+bool CameraInstance::setChunkMetadata(bool enable) {
+  AutoLock deviceLock(camera->GetLock());
+  if (!camera->ChunkModeActive.IsValid()) {
+    BJNI_LOG_WARN("CameraInstance::setChunkMetadata",
+                  "Camera " << serial << " does not support chunk mode.");
+    return false;
+  }
+
+  // Chunk layout is part of the payload size, so it can only change while
+  // acquisition is stopped.
+  bool ok = withAcquisitionStopped([&] {
+    camera->ChunkModeActive.SetValue(enable);
+    if (enable) {
+      const ChunkSelectorEnums chunks[] = {
+          ChunkSelector_Timestamp,    ChunkSelector_ExposureTime,
+          ChunkSelector_Gain,         ChunkSelector_LineStatusAll,
+          ChunkSelector_Framecounter, ChunkSelector_CounterValue,
+          ChunkSelector_SequencerSetActive,
+      };
+      for (auto chunk : chunks) {
+        // Not every model has every chunk; enable what exists.
+        if (camera->ChunkSelector.TrySetValue(chunk) &&
+            camera->ChunkEnable.IsWritable()) {
+          camera->ChunkEnable.SetValue(true);
+        }
+      }
+    }
+    return true;
+  });
+  if (ok) {
+    chunksEnabled.store(enable);
+  }
+  return ok;
 }
 
 std::shared_ptr<cv::Mat>
-CameraInstance::convertToMat(const CGrabResultPtr &grabResult) {
-  int cvType;
-  int colorCvt = -1;
+CameraInstance::takeFrameWithMetadata(FrameMetadata &metadata) {
+  PublishedFrame published = mailbox.latest();
+  metadata = published.metadata;
+  return published.frame;
+}
 
-  auto pixelType = grabResult->GetPixelType();
-  switch (pixelType) {
-  case PixelType_Mono8:
-    cvType = CV_8UC1;
-    // colorCvt = cv::COLOR_GRAY2BGR;
-    break;
-  case PixelType_BGR8packed:
-    cvType = CV_8UC3;
-    break;
-  case PixelType_RGB8packed:
-    cvType = CV_8UC3;
-    colorCvt = cv::COLOR_RGB2BGR;
-    break;
-  case PixelType_YUV422_YUYV_Packed:
-  case PixelType_YUV422packed:
-    cvType = CV_8UC2;
-    colorCvt = cv::COLOR_YUV2BGR_YUYV;
-    break;
-  case PixelType_YCbCr422_8_YY_CbCr_Semiplanar:
-    cvType = CV_8UC2;
-    colorCvt = cv::COLOR_YUV2BGR_UYVY;
-    break;
-  default:
-    throw std::runtime_error("Unsupported pixel format");
+bool CameraInstance::getFrameMetadata(uint64_t sequence,
+                                      FrameMetadata &metadata) {
+  if (mailbox.metadataFor(sequence, metadata)) {
+    return true;
+  }
+  auto ring = std::atomic_load(&history);
+  return ring && ring->readMetadata(sequence, metadata);
+}
+
+bool CameraInstance::setFrameHistory(int frames, bool raw) {
+  AutoLock deviceLock(camera->GetLock());
+  if (frames <= 0) {
+    std::atomic_store(&history, std::shared_ptr<FrameHistory>());
+    return true;
+  }
+
+  size_t slotBytes;
+  try {
+    // Size slots for the full sensor so later ROI or binning changes still
+    // fit; converted frames are at most 3 bytes per pixel.
+    int64_t width = camera->SensorWidth.IsReadable()
+                        ? camera->SensorWidth.GetValue()
+                        : camera->Width.GetMax();
+    int64_t height = camera->SensorHeight.IsReadable()
+                         ? camera->SensorHeight.GetValue()
+                         : camera->Height.GetMax();
+    slotBytes = static_cast<size_t>(width * height * 3);
+  } catch (const GenericException &e) {
+    BJNI_LOG_ERROR("CameraInstance::setFrameHistory",
+                   "Exception reading sensor size: " << e.GetDescription());
+    return false;
+  }
+
+  try {
+    auto ring = std::make_shared<FrameHistory>(frames, slotBytes);
+    historyRaw.store(raw);
+    std::atomic_store(&history, ring);
+    return true;
+  } catch (const std::bad_alloc &) {
+    BJNI_LOG_WARN("CameraInstance::setFrameHistory",
+                  "Could not allocate " << frames << " frames of " << slotBytes
+                                        << " bytes.");
+    return false;
+  }
+}
+
+bool CameraInstance::takeFrameAt(uint64_t sequence, cv::Mat &out,
+                                 FrameMetadata *metadata) {
+  auto ring = std::atomic_load(&history);
+  return ring && ring->read(sequence, out, metadata);
+}
+
+std::array<uint64_t, 2> CameraInstance::getFrameHistoryRange() const {
+  auto ring = std::atomic_load(&history);
+  if (!ring) {
+    return {0, 0};
+  }
+  return {ring->oldest(), ring->newest()};
+}
+
+int CameraInstance::dumpRecentFrames(const std::string &directory, int count) {
+  auto ring = std::atomic_load(&history);
+  if (!ring) {
+    return 0;
+  }
+
+  uint64_t newest = ring->newest();
+  uint64_t oldest = ring->oldest();
+  if (newest == 0) {
+    return 0;
+  }
+  if (count > 0 && newest - oldest + 1 > static_cast<uint64_t>(count)) {
+    oldest = newest - count + 1;
+  }
+
+  // Copy everything out first; encoding is slow enough that the oldest
+  // frames would otherwise be overwritten mid-dump.
+  std::vector<std::pair<uint64_t, cv::Mat>> frames;
+  for (uint64_t sequence = oldest; sequence <= newest; sequence++) {
+    cv::Mat frame;
+    if (ring->read(sequence, frame)) {
+      frames.emplace_back(sequence, std::move(frame));
+    }
+  }
+
+  std::error_code error;
+  std::filesystem::create_directories(directory, error);
+
+  int written = 0;
+  for (const auto &[sequence, frame] : frames) {
+    std::string path =
+        directory + "/" + serial + "_" + std::to_string(sequence) + ".png";
+    try {
+      if (cv::imwrite(path, frame)) {
+        written++;
+      }
+    } catch (const cv::Exception &e) {
+      BJNI_LOG_WARN("CameraInstance::dumpRecentFrames",
+                    "Failed to write " << path << ": " << e.what());
+    }
   }
+  return written;
+}
+
+std::shared_ptr<cv::Mat>
+CameraInstance::convertToMat(const CGrabResultPtr &grabResult,
+                             std::shared_ptr<cv::Mat> &mask) {
+  int cvType;
+  int colorCvt;
+  grabLayout(grabResult->GetPixelType(), cvType, colorCvt);
 
   cv::Mat wrapped(grabResult->GetHeight(), grabResult->GetWidth(), cvType,
                   (uint8_t *)grabResult->GetBuffer());
 
-  cv::Mat owned = wrapped.clone();
-  if (colorCvt != -1) {
-    cv::Mat converted;
-    cv::cvtColor(owned, converted, colorCvt);
-    return std::make_shared<cv::Mat>(std::move(converted));
+  // Convert straight from the grab buffer into the owned Mat, split into row
+  // stripes across the shared conversion pool.
+  auto converted = std::make_shared<cv::Mat>(wrapped.rows, wrapped.cols,
+                                             convertedType(cvType, colorCvt));
+
+  auto threshold = std::atomic_load(&thresholdStage);
+  if (threshold) {
+    mask = std::make_shared<cv::Mat>(
+        threshold->maskSize(wrapped.size()), CV_8UC1);
+  } else {
+    mask.reset();
+  }
+
+  auto stage = std::atomic_load(&undistort);
+  ConversionStages stages;
+  stages.threshold = threshold.get();
+  stages.undistort = stage.get();
+  if (stage) {
+    stages.geometry.width = wrapped.cols;
+    stages.geometry.height = wrapped.rows;
+    stages.geometry.offsetX = static_cast<int>(grabResult->GetOffsetX());
+    stages.geometry.offsetY = static_cast<int>(grabResult->GetOffsetY());
+    stages.geometry.binH = binningH.load(std::memory_order_relaxed);
+    stages.geometry.binV = binningV.load(std::memory_order_relaxed);
+  }
+
+  convertFrame(wrapped, colorCvt, *converted, mask.get(), stages,
+               undistortScratch);
+  return converted;
+}
+
+bool CameraInstance::setThreshold(const ThresholdConfig *config) {
+  if (!config) {
+    std::atomic_store(&thresholdStage, std::shared_ptr<ThresholdStage>());
+    return true;
+  }
+  if (config->satLow > config->satHigh || config->valLow > config->valHigh) {
+    BJNI_LOG_WARN("CameraInstance::setThreshold",
+                  "Empty saturation or value range.");
+    return false;
+  }
+  std::atomic_store(&thresholdStage, std::make_shared<ThresholdStage>(*config));
+  return true;
+}
+
+std::shared_ptr<cv::Mat> CameraInstance::takeMask() {
+  return mailbox.mask();
+}
+
+bool CameraInstance::setUndistortion(const cv::Mat &cameraMatrix,
+                                     const cv::Mat &distCoeffs,
+                                     int calibWidth, int calibHeight) {
+  AutoLock deviceLock(camera->GetLock());
+  if (cameraMatrix.empty()) {
+    std::atomic_store(&undistort, std::shared_ptr<UndistortStage>());
+    return true;
+  }
+
+  FrameGeometry calibration;
+  try {
+    // The calibration is taken to match the camera's current geometry, so
+    // later ROI or binning changes can be mapped back onto it.
+    calibration.width = static_cast<int>(camera->Width.GetValue());
+    calibration.height = static_cast<int>(camera->Height.GetValue());
+    calibration.offsetX = static_cast<int>(camera->OffsetX.GetValue());
+    calibration.offsetY = static_cast<int>(camera->OffsetY.GetValue());
+    if (camera->BinningHorizontal.IsReadable()) {
+      calibration.binH = static_cast<int>(camera->BinningHorizontal.GetValue());
+      calibration.binV = static_cast<int>(camera->BinningVertical.GetValue());
+    }
+  } catch (const GenericException &e) {
+    BJNI_LOG_ERROR("CameraInstance::setUndistortion",
+                   "Exception reading frame geometry: " << e.GetDescription());
+    return false;
+  }
+
+  if (calibration.width != calibWidth || calibration.height != calibHeight) {
+    BJNI_LOG_WARN("CameraInstance::setUndistortion",
+                  "Calibration is for " << calibWidth << "x" << calibHeight
+                                        << " but the camera is at "
+                                        << calibration.width << "x"
+                                        << calibration.height);
+    return false;
   }
 
-  return std::make_shared<cv::Mat>(std::move(owned));
+  binningH.store(calibration.binH);
+  binningV.store(calibration.binV);
+  std::atomic_store(&undistort, std::make_shared<UndistortStage>(
+                                    cameraMatrix, distCoeffs, calibration));
+  return true;
 }
 
 // Getter implementations
 
 double CameraInstance::getExposure() const {
+  AutoLock deviceLock(camera->GetLock());
   try {
     if (camera->ExposureTime.IsReadable()) {
       return camera->ExposureTime.GetValue();
     }
-    std::cout << "[CameraInstance::getExposure] ExposureTime not readable."
-              << std::endl;
+    BJNI_LOG_WARN("CameraInstance::getExposure", "ExposureTime not readable.");
     return -1.0;
   } catch (const GenericException &e) {
-    std::cout << "[CameraInstance::getExposure] Exception during getExposure: "
-              << e.GetDescription() << std::endl;
+    BJNI_LOG_ERROR("CameraInstance::getExposure",
+                   "Exception during getExposure: " << e.GetDescription());
     return -1.0;
   }
 }
 
 bool CameraInstance::getAutoExposure() const {
+  AutoLock deviceLock(camera->GetLock());
   try {
     if (camera->ExposureAuto.IsReadable()) {
       return camera->ExposureAuto.GetValue() != ExposureAuto_Off;
     }
-    std::cout << "[CameraInstance::getAutoExposure] ExposureAuto not readable."
-              << std::endl;
+    BJNI_LOG_WARN("CameraInstance::getAutoExposure",
+                  "ExposureAuto not readable.");
     return false;
   } catch (const GenericException &e) {
-    std::cout << "[CameraInstance::getAutoExposure] Exception during "
-                 "getAutoExposure: "
-              << e.GetDescription() << std::endl;
+    BJNI_LOG_ERROR("CameraInstance::getAutoExposure",
+                   "Exception during getAutoExposure: " << e.GetDescription());
     return false;
   }
 }
 
 double CameraInstance::getGain() const {
+  AutoLock deviceLock(camera->GetLock());
   try {
     if (camera->Gain.IsReadable()) {
       return camera->Gain.GetValue();
     }
-    std::cout << "[CameraInstance::getGain] Gain not readable." << std::endl;
+    BJNI_LOG_WARN("CameraInstance::getGain", "Gain not readable.");
     return -1.0;
   } catch (const GenericException &e) {
-    std::cout << "[CameraInstance::getGain] Exception during getGain: "
-              << e.GetDescription() << std::endl;
+    BJNI_LOG_ERROR("CameraInstance::getGain",
+                   "Exception during getGain: " << e.GetDescription());
     return -1.0;
   }
 }
 
 double CameraInstance::getFrameRate() const {
+  AutoLock deviceLock(camera->GetLock());
   try {
     if (camera->AcquisitionFrameRate.IsReadable()) {
       return camera->AcquisitionFrameRate.GetValue();
     }
-    std::cout
-        << "[CameraInstance::getFrameRate] AcquisitionFrameRate not readable."
-        << std::endl;
+    BJNI_LOG_WARN("CameraInstance::getFrameRate",
+                  "AcquisitionFrameRate not readable.");
     return -1.0;
   } catch (const GenericException &e) {
-    std::cout
-        << "[CameraInstance::getFrameRate] Exception during getFrameRate: "
-        << e.GetDescription() << std::endl;
+    BJNI_LOG_ERROR("CameraInstance::getFrameRate",
+                   "Exception during getFrameRate: " << e.GetDescription());
     return -1.0;
   }
 }
 
 bool CameraInstance::getAutoWhiteBalance() const {
+  AutoLock deviceLock(camera->GetLock());
   try {
     if (camera->BalanceWhiteAuto.IsReadable()) {
       return camera->BalanceWhiteAuto.GetValue() != BalanceWhiteAuto_Off;
     }
-    std::cout << "[CameraInstance::getWhiteBalance] BalanceRatio not readable."
-              << std::endl;
-    return -1.0;
+    BJNI_LOG_WARN("CameraInstance::getAutoWhiteBalance",
+                  "BalanceWhiteAuto not readable.");
+    return false;
   } catch (const GenericException &e) {
-    std::cout << "[CameraInstance::getAutoWhiteBalance] Exception during "
-                 "getAutoWhiteBalance: "
-              << e.GetDescription() << std::endl;
+    BJNI_LOG_ERROR("CameraInstance::getAutoWhiteBalance",
+                   "Exception during getAutoWhiteBalance: "
+                   << e.GetDescription());
     return false;
   }
 }
 
 std::vector<int> CameraInstance::getSupportedPixelFormats() const {
+  AutoLock deviceLock(camera->GetLock());
   try {
     std::vector<int> formats;
 
@@ -240,24 +932,28 @@ std::vector<int> CameraInstance::getSupportedPixelFormats() const {
           formats.push_back(7); // kUYVY
         } else if (formatStr == "Mono8") {
           formats.push_back(5);
+        } else if (isBayer8Name(formatStr.c_str()) &&
+                   std::find(formats.begin(), formats.end(),
+                             kPixelFormatBayer8) == formats.end()) {
+          formats.push_back(kPixelFormatBayer8);
         }
       }
     } else {
-      std::cout << "[CameraInstance::getSupportedPixelFormats] PixelFormat not "
-                   "readable."
-                << std::endl;
+      BJNI_LOG_WARN("CameraInstance::getSupportedPixelFormats",
+                    "PixelFormat not readable.");
     }
 
     return formats;
   } catch (const GenericException &e) {
-    std::cout << "[CameraInstance::getSupportedPixelFormats] Exception during "
-                 "getSupportedPixelFormats: "
-              << e.GetDescription() << std::endl;
+    BJNI_LOG_ERROR("CameraInstance::getSupportedPixelFormats",
+                   "Exception during getSupportedPixelFormats: "
+                   << e.GetDescription());
     return {};
   }
 }
 
 std::array<double, 3> CameraInstance::getWhiteBalance() {
+  AutoLock deviceLock(camera->GetLock());
   std::array<double, 3> balances = {-1.0, -1.0, -1.0};
 
   try {
@@ -269,132 +965,190 @@ std::array<double, 3> CameraInstance::getWhiteBalance() {
       camera->BalanceRatioSelector.SetValue(BalanceRatioSelector_Blue);
       balances[2] = camera->BalanceRatio.GetValue();
     } else {
-      std::cout << "[CameraInstance::getAutoWhiteBalance] BalanceWhiteAuto not "
-                   "readable."
-                << std::endl;
+      BJNI_LOG_WARN("CameraInstance::getAutoWhiteBalance",
+                    "BalanceWhiteAuto not readable.");
     }
   } catch (const GenericException &e) {
-    std::cout << "[CameraInstance::getWhiteBalance] Exception during "
-                 "getWhiteBalance: "
-              << e.GetDescription() << std::endl;
+    BJNI_LOG_ERROR("CameraInstance::getWhiteBalance",
+                   "Exception during getWhiteBalance: " << e.GetDescription());
   }
   return balances;
 }
 
 int CameraInstance::getPixelFormat() const {
+  AutoLock deviceLock(camera->GetLock());
   try {
     if (camera->PixelFormat.IsReadable()) {
-      switch (camera->PixelFormat.GetValue()) {
-      case PixelFormat_RGB8:
-        return 4; // kBGR;
-      case PixelFormat_YCbCr422_8:
-        return 7; // kUYVY
-      case PixelFormat_Mono8:
-        return 5; // kGray
-      default:
-        return -1;
-      }
+      return toJavaPixelFormat(camera->PixelFormat.GetValue());
     }
-    std::cout << "[CameraInstance::getPixelFormat] PixelFormat not readable."
-              << std::endl;
+    BJNI_LOG_WARN("CameraInstance::getPixelFormat",
+                  "PixelFormat not readable.");
   } catch (const GenericException &e) {
-    std::cout
-        << "[CameraInstance::getPixelFormat] Exception during getPixelFormat: "
-        << e.GetDescription() << std::endl;
+    BJNI_LOG_ERROR("CameraInstance::getPixelFormat",
+                   "Exception during getPixelFormat: " << e.GetDescription());
   }
   return -1;
 }
 
-double CameraInstance::getMinExposure() const {
+std::array<double, kStateCount> CameraInstance::getCameraState() {
+  AutoLock deviceLock(camera->GetLock());
+  std::array<double, kStateCount> state;
+  state.fill(-1.0);
+
+  // Each group is read independently so one missing node (e.g. white
+  // balance on a mono sensor) does not blank the rest.
+  auto readRange = [&state](auto &param, CameraStateField value,
+                            CameraStateField min, CameraStateField max) {
+    try {
+      if (param.IsReadable()) {
+        state[value] = param.GetValue();
+        state[min] = param.GetMin();
+        state[max] = param.GetMax();
+      }
+    } catch (const GenericException &e) {
+      BJNI_LOG_ERROR("CameraInstance::getCameraState",
+                     "Exception reading " << param.GetInfo(ParameterInfo_Name)
+                                          << ": " << e.GetDescription());
+    }
+  };
+  readRange(camera->ExposureTime, kStateExposure, kStateMinExposure,
+            kStateMaxExposure);
+  readRange(camera->Gain, kStateGain, kStateMinGain, kStateMaxGain);
+
+  try {
+    if (camera->AcquisitionFrameRate.IsReadable()) {
+      state[kStateFrameRate] = camera->AcquisitionFrameRate.GetValue();
+    }
+    if (camera->ExposureAuto.IsReadable()) {
+      state[kStateAutoExposure] =
+          camera->ExposureAuto.GetValue() != ExposureAuto_Off ? 1.0 : 0.0;
+    }
+    if (camera->BalanceWhiteAuto.IsReadable()) {
+      state[kStateAutoWhiteBalance] =
+          camera->BalanceWhiteAuto.GetValue() != BalanceWhiteAuto_Off ? 1.0
+                                                                      : 0.0;
+    }
+    if (camera->PixelFormat.IsReadable()) {
+      state[kStatePixelFormat] =
+          toJavaPixelFormat(camera->PixelFormat.GetValue());
+    }
+  } catch (const GenericException &e) {
+    BJNI_LOG_ERROR("CameraInstance::getCameraState",
+                   "Exception during getCameraState: " << e.GetDescription());
+  }
+
+  try {
+    if (camera->BalanceRatio.IsReadable() &&
+        camera->BalanceRatioSelector.IsWritable()) {
+      // The ratio range is the same for every channel; read it once.
+      camera->BalanceRatioSelector.SetValue(BalanceRatioSelector_Red);
+      state[kStateWhiteBalanceRed] = camera->BalanceRatio.GetValue();
+      state[kStateMinWhiteBalance] = camera->BalanceRatio.GetMin();
+      state[kStateMaxWhiteBalance] = camera->BalanceRatio.GetMax();
+      camera->BalanceRatioSelector.SetValue(BalanceRatioSelector_Green);
+      state[kStateWhiteBalanceGreen] = camera->BalanceRatio.GetValue();
+      camera->BalanceRatioSelector.SetValue(BalanceRatioSelector_Blue);
+      state[kStateWhiteBalanceBlue] = camera->BalanceRatio.GetValue();
+    }
+  } catch (const GenericException &e) {
+    BJNI_LOG_ERROR("CameraInstance::getCameraState",
+                   "Exception reading white balance: " << e.GetDescription());
+  }
+  return state;
+}
+
+double CameraInstance::getMinExposure() const {
+  AutoLock deviceLock(camera->GetLock());
   try {
     if (camera->ExposureTime.IsReadable()) {
       return camera->ExposureTime.GetMin();
     }
 
-    std::cout << "[CameraInstance::getMinExposure] ExposureTime not readable"
-              << std::endl;
+    BJNI_LOG_WARN("CameraInstance::getMinExposure",
+                  "ExposureTime not readable");
   } catch (const GenericException &e) {
-    std::cout
-        << "[CameraInstance::getMinExposure] Exception during getMinExposure: "
-        << e.GetDescription() << std::endl;
+    BJNI_LOG_ERROR("CameraInstance::getMinExposure",
+                   "Exception during getMinExposure: " << e.GetDescription());
   }
   return -1.0;
 }
 
 double CameraInstance::getMaxExposure() const {
+  AutoLock deviceLock(camera->GetLock());
   try {
     if (camera->ExposureTime.IsReadable()) {
       return camera->ExposureTime.GetMax();
     }
 
-    std::cout << "[CameraInstance::getMaxExposure] ExposureTime not readable"
-              << std::endl;
+    BJNI_LOG_WARN("CameraInstance::getMaxExposure",
+                  "ExposureTime not readable");
   } catch (const GenericException &e) {
-    std::cout
-        << "[CameraInstance::getMaxExposure] Exception during getMaxExposure: "
-        << e.GetDescription() << std::endl;
+    BJNI_LOG_ERROR("CameraInstance::getMaxExposure",
+                   "Exception during getMaxExposure: " << e.GetDescription());
   }
   return -1.0;
 }
 
 double CameraInstance::getMinWhiteBalance() const {
+  AutoLock deviceLock(camera->GetLock());
   try {
     if (camera->BalanceRatio.IsReadable()) {
       return camera->BalanceRatio.GetMin();
     }
 
-    std::cout
-        << "[CameraInstance::getMinWhiteBalance] BalanceRatio not readable"
-        << std::endl;
+    BJNI_LOG_WARN("CameraInstance::getMinWhiteBalance",
+                  "BalanceRatio not readable");
   } catch (GenericException &e) {
-    std::cout << "[CameraInstance::getMinWhiteBalance] Exception during "
-                 "getMinWhiteBalance: "
-              << e.GetDescription() << std::endl;
+    BJNI_LOG_ERROR("CameraInstance::getMinWhiteBalance",
+                   "Exception during getMinWhiteBalance: "
+                   << e.GetDescription());
   }
   return -1.0;
 }
 
 double CameraInstance::getMaxWhiteBalance() const {
+  AutoLock deviceLock(camera->GetLock());
   try {
     if (camera->BalanceRatio.IsReadable()) {
-      return camera->ExposureTime.GetMax();
+      return camera->BalanceRatio.GetMax();
     }
 
-    std::cout
-        << "[CameraInstance::getMaxWhiteBalance] BalanceRatio not readable"
-        << std::endl;
+    BJNI_LOG_WARN("CameraInstance::getMaxWhiteBalance",
+                  "BalanceRatio not readable");
   } catch (GenericException &e) {
-    std::cout << "[CameraInstance::getMaxWhiteBalance] Exception during "
-                 "getMaxWhiteBalance: "
-              << e.GetDescription() << std::endl;
+    BJNI_LOG_ERROR("CameraInstance::getMaxWhiteBalance",
+                   "Exception during getMaxWhiteBalance: "
+                   << e.GetDescription());
   }
   return -1.0;
 }
 
 double CameraInstance::getMinGain() const {
+  AutoLock deviceLock(camera->GetLock());
   try {
     if (camera->Gain.IsReadable()) {
       return camera->Gain.GetMin();
     }
 
-    std::cout << "[CameraInstance::getMinGain] Gain not readable" << std::endl;
+    BJNI_LOG_WARN("CameraInstance::getMinGain", "Gain not readable");
   } catch (const GenericException &e) {
-    std::cout << "[CameraInstance::getMinGain] Exception during getMinGain: "
-              << e.GetDescription() << std::endl;
+    BJNI_LOG_ERROR("CameraInstance::getMinGain",
+                   "Exception during getMinGain: " << e.GetDescription());
   }
   return -1.0;
 }
 
 double CameraInstance::getMaxGain() const {
+  AutoLock deviceLock(camera->GetLock());
   try {
     if (camera->Gain.IsReadable()) {
       return camera->Gain.GetMax();
     }
 
-    std::cout << "[CameraInstance::getMaxGain] Gain not readable" << std::endl;
+    BJNI_LOG_WARN("CameraInstance::getMaxGain", "Gain not readable");
   } catch (const GenericException &e) {
-    std::cout << "[CameraInstance::getMaxGain] Exception during getMaxGain: "
-              << e.GetDescription() << std::endl;
+    BJNI_LOG_ERROR("CameraInstance::getMaxGain",
+                   "Exception during getMaxGain: " << e.GetDescription());
   }
   return -1.0;
 }
@@ -402,6 +1156,7 @@ double CameraInstance::getMaxGain() const {
 // Setter implementations
 
 bool CameraInstance::setExposure(double exposure) {
+  AutoLock deviceLock(camera->GetLock());
   try {
     if (camera->ExposureTime.IsWritable() &&
         camera->ExposureAuto.IsWritable() &&
@@ -417,21 +1172,25 @@ bool CameraInstance::setExposure(double exposure) {
       if (camera->ExposureTimeMode.IsWritable()) {
         camera->ExposureTimeMode.SetValue(ExposureTimeMode_Standard);
       }
+      recordSettings([&](CameraSettings &s) {
+        s.exposure = exposure;
+        s.autoExposure = false;
+        s.fields |= CameraSettings::kExposure | CameraSettings::kAutoExposure;
+      });
       return true;
     }
 
-    std::cout
-        << "[CameraInstance::setExposure] ExposureTime or ExposureAuto or "
-           "ExposureMode not writable."
-        << std::endl;
+    BJNI_LOG_WARN("CameraInstance::setExposure",
+                  "ExposureTime or ExposureAuto or ExposureMode not writable.");
   } catch (const GenericException &e) {
-    std::cout << "[CameraInstance::setExposure] Exception during setExposure: "
-              << e.GetDescription() << std::endl;
+    BJNI_LOG_ERROR("CameraInstance::setExposure",
+                   "Exception during setExposure: " << e.GetDescription());
   }
   return false;
 }
 
 bool CameraInstance::setAutoExposure(bool enable) {
+  AutoLock deviceLock(camera->GetLock());
   try {
     if (camera->ExposureAuto.IsWritable()) {
       if (enable) {
@@ -439,19 +1198,31 @@ bool CameraInstance::setAutoExposure(bool enable) {
       } else {
         camera->ExposureAuto.SetValue(ExposureAuto_Off);
       }
+      bool autoGain;
+      {
+        std::lock_guard<std::mutex> lock(settingsMutex);
+        autoGain = autoConfigured && autoConfig.autoGain;
+      }
+      if (autoGain && camera->GainAuto.IsWritable()) {
+        camera->GainAuto.SetValue(enable ? GainAuto_Continuous : GainAuto_Off);
+      }
+      recordSettings([&](CameraSettings &s) {
+        s.autoExposure = enable;
+        s.fields |= CameraSettings::kAutoExposure;
+      });
       return true;
     }
-    std::cout << "[CameraInstance::setAutoExposure] ExposureAuto not writable."
-              << std::endl;
+    BJNI_LOG_WARN("CameraInstance::setAutoExposure",
+                  "ExposureAuto not writable.");
   } catch (const GenericException &e) {
-    std::cout << "[CameraInstance::setAutoExposure] Exception during "
-                 "setAutoExposure: "
-              << e.GetDescription() << std::endl;
+    BJNI_LOG_ERROR("CameraInstance::setAutoExposure",
+                   "Exception during setAutoExposure: " << e.GetDescription());
   }
   return false;
 }
 
 bool CameraInstance::setGain(double gain) {
+  AutoLock deviceLock(camera->GetLock());
   try {
     if (camera->Gain.IsWritable() && camera->GainSelector.IsWritable()) {
       auto min = camera->Gain.GetMin();
@@ -462,19 +1233,24 @@ bool CameraInstance::setGain(double gain) {
       gain = std::clamp(gain, min, max);
 
       camera->Gain.SetValue(gain);
+      recordSettings([&](CameraSettings &s) {
+        s.gain = gain;
+        s.fields |= CameraSettings::kGain;
+      });
       return true;
     }
 
-    std::cout << "[CameraInstance::setGain] Gain not writable." << std::endl;
+    BJNI_LOG_WARN("CameraInstance::setGain", "Gain not writable.");
 
   } catch (const GenericException &e) {
-    std::cout << "[CameraInstance::setGain] Exception during setGain: "
-              << e.GetDescription() << std::endl;
+    BJNI_LOG_ERROR("CameraInstance::setGain",
+                   "Exception during setGain: " << e.GetDescription());
   }
   return false;
 }
 
 bool CameraInstance::setFrameRate(double frameRate) {
+  AutoLock deviceLock(camera->GetLock());
   try {
     if (camera->AcquisitionFrameRateEnable.IsWritable()) {
       camera->AcquisitionFrameRateEnable.SetValue(true);
@@ -487,22 +1263,27 @@ bool CameraInstance::setFrameRate(double frameRate) {
       frameRate = std::clamp(frameRate, min, max);
 
       camera->AcquisitionFrameRate.SetValue(frameRate);
+      recordSettings([&](CameraSettings &s) {
+        s.frameRate = frameRate;
+        s.fields |= CameraSettings::kFrameRate;
+      });
+      // Keep the auto exposure cap in step with the new frame period.
+      applyAutoFunctions();
 
       return true;
     }
 
-    std::cout
-        << "[CameraInstance::setFrameRate] AcquisitionFrameRate not writable."
-        << std::endl;
+    BJNI_LOG_WARN("CameraInstance::setFrameRate",
+                  "AcquisitionFrameRate not writable.");
   } catch (const GenericException &e) {
-    std::cout
-        << "[CameraInstance::setFrameRate] Exception during setFrameRate: "
-        << e.GetDescription() << std::endl;
+    BJNI_LOG_ERROR("CameraInstance::setFrameRate",
+                   "Exception during setFrameRate: " << e.GetDescription());
   }
   return false;
 }
 
 bool CameraInstance::setWhiteBalance(std::array<double, 3> balance) {
+  AutoLock deviceLock(camera->GetLock());
   try {
     if (camera->BalanceRatio.IsWritable() &&
         camera->BalanceRatioSelector.IsWritable()) {
@@ -525,21 +1306,24 @@ bool CameraInstance::setWhiteBalance(std::array<double, 3> balance) {
       camera->BalanceRatioSelector.SetValue(BalanceRatioSelector_Blue);
       camera->BalanceRatio.SetValue(balance[2]);
 
+      recordSettings([&](CameraSettings &s) {
+        s.whiteBalance = balance;
+        s.fields |= CameraSettings::kWhiteBalance;
+      });
       return true;
     }
 
-    std::cout << "[CameraInstance::setWhiteBalance] BalanceRatio or "
-                 "BalanceRatioSelector not writable."
-              << std::endl;
+    BJNI_LOG_WARN("CameraInstance::setWhiteBalance",
+                  "BalanceRatio or BalanceRatioSelector not writable.");
   } catch (const GenericException &e) {
-    std::cout << "[CameraInstance::setWhiteBalance] Exception during "
-                 "setWhiteBalance: "
-              << e.GetDescription() << std::endl;
+    BJNI_LOG_ERROR("CameraInstance::setWhiteBalance",
+                   "Exception during setWhiteBalance: " << e.GetDescription());
   }
   return false;
 }
 
 bool CameraInstance::setAutoWhiteBalance(bool enable) {
+  AutoLock deviceLock(camera->GetLock());
   try {
     if (camera->BalanceWhiteAuto.IsWritable()) {
       if (enable) {
@@ -547,69 +1331,193 @@ bool CameraInstance::setAutoWhiteBalance(bool enable) {
       } else {
         camera->BalanceWhiteAuto.SetValue(BalanceWhiteAuto_Off);
       }
+      recordSettings([&](CameraSettings &s) {
+        s.autoWhiteBalance = enable;
+        s.fields |= CameraSettings::kAutoWhiteBalance;
+      });
       return true;
     }
-    std::cout << "[CameraInstance::setAutoWhiteBalance] BalanceWhiteAuto not "
-                 "writable."
-              << std::endl;
+    BJNI_LOG_WARN("CameraInstance::setAutoWhiteBalance",
+                  "BalanceWhiteAuto not writable.");
   } catch (const GenericException &e) {
-    std::cout << "[CameraInstance::setAutoWhiteBalance] Exception during "
-                 "setAutoWhiteBalance: "
-              << e.GetDescription() << std::endl;
+    BJNI_LOG_ERROR("CameraInstance::setAutoWhiteBalance",
+                   "Exception during setAutoWhiteBalance: "
+                   << e.GetDescription());
   }
   return false;
 }
 
 bool CameraInstance::setPixelFormat(int format) {
+  AutoLock deviceLock(camera->GetLock());
   try {
     if (camera->PixelFormat.IsWritable()) {
       switch (format) {
       case 4: // kBGR
         camera->PixelFormat.SetValue(PixelFormat_RGB8);
-        return true;
+        break;
       case 7: // kUYVY
         camera->PixelFormat.SetValue(PixelFormat_YCbCr422_8);
-        return true;
+        break;
       case 5: // kGray
         camera->PixelFormat.SetValue(PixelFormat_Mono8);
-        return true;
+        break;
+      case kPixelFormatBayer8:
+        // A sensor has one native pattern; take whichever is offered.
+        if (!camera->PixelFormat.TrySetValue(PixelFormat_BayerRG8) &&
+            !camera->PixelFormat.TrySetValue(PixelFormat_BayerBG8) &&
+            !camera->PixelFormat.TrySetValue(PixelFormat_BayerGR8) &&
+            !camera->PixelFormat.TrySetValue(PixelFormat_BayerGB8)) {
+          BJNI_LOG_WARN("CameraInstance::setPixelFormat",
+                        "Camera " << serial << " has no 8-bit Bayer format.");
+          return false;
+        }
+        break;
       default:
-        std::cout << "[CameraInstance::setPixelFormat] Unsupported pixel "
-                     "format value: "
-                  << format << std::endl;
+        BJNI_LOG_WARN("CameraInstance::setPixelFormat",
+                      "Unsupported pixel format value: " << format);
         return false;
       }
+      recordSettings([&](CameraSettings &s) {
+        s.pixelFormat = format;
+        s.fields |= CameraSettings::kPixelFormat;
+      });
+      return true;
     }
-    std::cout << "[CameraInstance::setPixelFormat] PixelFormat not writable."
-              << std::endl;
+    BJNI_LOG_WARN("CameraInstance::setPixelFormat",
+                  "PixelFormat not writable.");
   } catch (const GenericException &e) {
-    std::cout
-        << "[CameraInstance::setPixelFormat] Exception setting PixelFormat: "
-        << e.GetDescription() << std::endl;
+    BJNI_LOG_ERROR("CameraInstance::setPixelFormat",
+                   "Exception setting PixelFormat: " << e.GetDescription());
   }
   return false;
 }
 
+// Pixel format negotiation
+
+double CameraInstance::linkBytesPerSecond() {
+  AutoLock deviceLock(camera->GetLock());
+  double bytesPerSecond = 0.0;
+  if (camera->DeviceLinkThroughputLimitMode.IsReadable() &&
+      camera->DeviceLinkThroughputLimitMode.GetValue() ==
+          DeviceLinkThroughputLimitMode_On &&
+      camera->DeviceLinkThroughputLimit.IsReadable()) {
+    return camera->DeviceLinkThroughputLimit.GetValue();
+  }
+  if (camera->DeviceLinkSpeed.IsReadable()) {
+    bytesPerSecond = static_cast<double>(camera->DeviceLinkSpeed.GetValue());
+  } else if (camera->GevLinkSpeed.IsReadable()) {
+    // Mbit/s
+    bytesPerSecond = camera->GevLinkSpeed.GetValue() * 125000.0;
+  }
+
+  std::lock_guard<std::mutex> lock(transportMutex);
+  if (bandwidthShare > 0) {
+    bytesPerSecond *= bandwidthShare;
+  }
+  return bytesPerSecond;
+}
+
+int CameraInstance::negotiatePixelFormat(int intent, bool apply,
+                                         std::string &reasoning) {
+  AutoLock deviceLock(camera->GetLock());
+  struct Negotiable {
+    const char *name;
+    EPixelType pixelType;
+    int libraryFormat;
+    double bytesPerPixel;
+    bool color;
+  };
+  // Only the first Bayer format found is used, matching setPixelFormat.
+  static const Negotiable kNegotiable[] = {
+      {"Mono8", PixelType_Mono8, 5, 1.0, false},
+      {"BayerRG8", PixelType_BayerRG8, kPixelFormatBayer8, 1.0, true},
+      {"BayerBG8", PixelType_BayerBG8, kPixelFormatBayer8, 1.0, true},
+      {"BayerGR8", PixelType_BayerGR8, kPixelFormatBayer8, 1.0, true},
+      {"BayerGB8", PixelType_BayerGB8, kPixelFormatBayer8, 1.0, true},
+      {"RGB8", PixelType_RGB8packed, 4, 3.0, true},
+      {"YCbCr422_8", PixelType_YCbCr422_8_YY_CbCr_Semiplanar, 7, 2.0, true},
+  };
+
+  NegotiationInput input;
+  input.intent = intent;
+  try {
+    input.width = static_cast<int>(camera->Width.GetValue());
+    input.height = static_cast<int>(camera->Height.GetValue());
+    input.linkBytesPerSecond = linkBytesPerSecond();
+    if (camera->AcquisitionFrameRate.IsReadable()) {
+      input.sensorMaxFps = camera->AcquisitionFrameRate.GetMax();
+    }
+
+    GenApi::StringList_t settable;
+    camera->PixelFormat.GetSettableValues(settable);
+    bool haveBayer = false;
+    for (const auto &format : kNegotiable) {
+      bool offered = std::find(settable.begin(), settable.end(),
+                               GenICam::gcstring(format.name)) !=
+                     settable.end();
+      if (!offered || (format.libraryFormat == kPixelFormatBayer8 && haveBayer)) {
+        continue;
+      }
+      haveBayer = haveBayer || format.libraryFormat == kPixelFormatBayer8;
+
+      FormatCandidate candidate;
+      candidate.name = format.name;
+      candidate.libraryFormat = format.libraryFormat;
+      candidate.bytesPerPixel = format.bytesPerPixel;
+      candidate.color = format.color;
+      int cvType, colorCvt;
+      grabLayout(format.pixelType, cvType, colorCvt);
+      candidate.convertNs =
+          measureConversionNs(cvType, colorCvt, input.width, input.height);
+      input.candidates.push_back(candidate);
+    }
+  } catch (const GenericException &e) {
+    reasoning = std::string("Could not read camera capabilities: ") +
+                e.GetDescription();
+    BJNI_LOG_INFO("CameraInstance::negotiatePixelFormat", reasoning);
+    return -1;
+  }
+
+  NegotiationResult result = negotiateFormat(input);
+  reasoning = result.reasoning;
+  if (result.chosen < 0) {
+    return -1;
+  }
+
+  int format = input.candidates[result.chosen].libraryFormat;
+  if (apply &&
+      !withAcquisitionStopped([&] { return setPixelFormat(format); })) {
+    reasoning += " Failed to apply it.";
+    return -1;
+  }
+  return format;
+}
+
 bool CameraInstance::setBrightness(double brightness) {
+  AutoLock deviceLock(camera->GetLock());
   try {
     if (camera->BslBrightness.IsWritable()) {
       brightness = std::clamp(brightness, -1.0, 1.0);
 
       camera->BslBrightness.SetValue(brightness);
+      recordSettings([&](CameraSettings &s) {
+        s.brightness = brightness;
+        s.fields |= CameraSettings::kBrightness;
+      });
       return true;
     }
 
-    std::cout << "[CameraInstance::setBrightness] BslBrightness not writable"
-              << std::endl;
+    BJNI_LOG_WARN("CameraInstance::setBrightness",
+                  "BslBrightness not writable");
   } catch (const GenericException &e) {
-    std::cout
-        << "[CameraInstance::setBrightness] Exception during setBrightness: "
-        << e.GetDescription() << std::endl;
+    BJNI_LOG_ERROR("CameraInstance::setBrightness",
+                   "Exception during setBrightness: " << e.GetDescription());
   }
   return false;
 }
 
 bool CameraInstance::setPixelBinning(int binMode, int horzBin, int vertBin) {
+  AutoLock deviceLock(camera->GetLock());
   try {
     if (camera->BinningHorizontal.IsWritable() &&
         camera->BinningVertical.IsWritable() &&
@@ -622,9 +1530,8 @@ bool CameraInstance::setPixelBinning(int binMode, int horzBin, int vertBin) {
         camera->BinningHorizontalMode.SetValue(BinningHorizontalMode_Sum);
         camera->BinningVerticalMode.SetValue(BinningVerticalMode_Sum);
       } else {
-        std::cout
-            << "[CameraInstance::setPixelBinning] Unsupported BinningMode: "
-            << binMode << std::endl;
+        BJNI_LOG_WARN("CameraInstance::setPixelBinning",
+                      "Unsupported BinningMode: " << binMode);
         return false;
       }
 
@@ -633,31 +1540,1726 @@ bool CameraInstance::setPixelBinning(int binMode, int horzBin, int vertBin) {
       }
       camera->BinningHorizontal.SetValue(horzBin);
       camera->BinningVertical.SetValue(vertBin);
+      binningH.store(horzBin);
+      binningV.store(vertBin);
+      recordSettings([&](CameraSettings &s) {
+        s.binMode = binMode;
+        s.horzBin = horzBin;
+        s.vertBin = vertBin;
+        s.fields |= CameraSettings::kBinning;
+      });
       return true;
     }
-    std::cout << "[CameraInstance::setPixelBinning] "
-                 "BinningMode[Horizonal|Vertical] or "
-                 "Binning[Horizontal|Vertical] not writable."
-              << std::endl;
-
-    // log each one to see which is not writable
+    // Name each node that is not writable, as one record.
+    std::string unwritable;
     if (!camera->BinningHorizontal.IsWritable()) {
-      std::cout << " - BinningHorizontal not writable." << std::endl;
+      unwritable += " BinningHorizontal";
     }
     if (!camera->BinningVertical.IsWritable()) {
-      std::cout << " - BinningVertical not writable." << std::endl;
+      unwritable += " BinningVertical";
     }
     if (!camera->BinningHorizontalMode.IsWritable()) {
-      std::cout << " - BinningHorizontalMode not writable." << std::endl;
+      unwritable += " BinningHorizontalMode";
     }
     if (!camera->BinningVerticalMode.IsWritable()) {
-      std::cout << " - BinningVerticalMode not writable." << std::endl;
+      unwritable += " BinningVerticalMode";
+    }
+    BJNI_LOG_WARN("CameraInstance::setPixelBinning",
+                  "Binning nodes not writable:" << unwritable);
+
+  } catch (const GenericException &e) {
+    BJNI_LOG_ERROR("CameraInstance::setPixelBinning",
+                   "Exception setting pixel binning: " << e.GetDescription());
+  }
+  return false;
+}
+// Profiles
+
+bool CameraInstance::saveProfile(const std::string &path, bool fullNodeMap) {
+  AutoLock deviceLock(camera->GetLock());
+  if (!fullNodeMap) {
+    return getSettings().saveToFile(path);
+  }
+
+  try {
+    CFeaturePersistence::Save(path.c_str(), &camera->GetNodeMap());
+    return true;
+  } catch (const GenericException &e) {
+    BJNI_LOG_ERROR("CameraInstance::saveProfile",
+                   "Exception saving profile: " << e.GetDescription());
+  }
+  return false;
+}
+
+bool CameraInstance::loadProfile(const std::string &path) {
+  AutoLock deviceLock(camera->GetLock());
+  if (CameraSettings::isBinaryProfile(path)) {
+    CameraSettings loaded;
+    if (!CameraSettings::loadFromFile(path, loaded)) {
+      BJNI_LOG_WARN("CameraInstance::loadProfile", "Invalid profile: " << path);
+      return false;
+    }
+    return applySettings(loaded);
+  }
+
+  try {
+    bool ok = withAcquisitionStopped([&] {
+      CFeaturePersistence::Load(path.c_str(), &camera->GetNodeMap(), true);
+      return true;
+    });
+    captureSettings();
+    return ok;
+  } catch (const GenericException &e) {
+    BJNI_LOG_ERROR("CameraInstance::loadProfile",
+                   "Exception loading profile: " << e.GetDescription());
+  }
+  return false;
+}
+
+bool CameraInstance::saveUserSet(int userSet, bool makeDefault) {
+  AutoLock deviceLock(camera->GetLock());
+  static const UserSetSelectorEnums selectors[] = {
+      UserSetSelector_UserSet1, UserSetSelector_UserSet2,
+      UserSetSelector_UserSet3};
+  static const UserSetDefaultEnums defaults[] = {
+      UserSetDefault_UserSet1, UserSetDefault_UserSet2,
+      UserSetDefault_UserSet3};
+  static const UserSetDefaultSelectorEnums legacyDefaults[] = {
+      UserSetDefaultSelector_UserSet1, UserSetDefaultSelector_UserSet2,
+      UserSetDefaultSelector_UserSet3};
+
+  if (userSet < 1 || userSet > 3) {
+    BJNI_LOG_WARN("CameraInstance::saveUserSet",
+                  "Unsupported user set: " << userSet);
+    return false;
+  }
+
+  try {
+    return withAcquisitionStopped([&] {
+      camera->UserSetSelector.SetValue(selectors[userSet - 1]);
+      camera->UserSetSave.Execute();
+
+      if (makeDefault) {
+        // Newer cameras use UserSetDefault, older GigE models the selector.
+        if (camera->UserSetDefault.IsWritable()) {
+          camera->UserSetDefault.SetValue(defaults[userSet - 1]);
+        } else if (camera->UserSetDefaultSelector.IsWritable()) {
+          camera->UserSetDefaultSelector.SetValue(legacyDefaults[userSet - 1]);
+        } else {
+          BJNI_LOG_WARN("CameraInstance::saveUserSet",
+                        "Default user set not writable.");
+          return false;
+        }
+      }
+      return true;
+    });
+  } catch (const GenericException &e) {
+    BJNI_LOG_ERROR("CameraInstance::saveUserSet",
+                   "Exception saving user set: " << e.GetDescription());
+  }
+  return false;
+}
+
+bool CameraInstance::loadUserSet(int userSet) {
+  AutoLock deviceLock(camera->GetLock());
+  static const UserSetSelectorEnums selectors[] = {
+      UserSetSelector_Default, UserSetSelector_UserSet1,
+      UserSetSelector_UserSet2, UserSetSelector_UserSet3};
+
+  if (userSet < 0 || userSet > 3) {
+    BJNI_LOG_WARN("CameraInstance::loadUserSet",
+                  "Unsupported user set: " << userSet);
+    return false;
+  }
+
+  try {
+    bool ok = withAcquisitionStopped([&] {
+      camera->UserSetSelector.SetValue(selectors[userSet]);
+      camera->UserSetLoad.Execute();
+      return true;
+    });
+    captureSettings();
+    return ok;
+  } catch (const GenericException &e) {
+    BJNI_LOG_ERROR("CameraInstance::loadUserSet",
+                   "Exception loading user set: " << e.GetDescription());
+  }
+  return false;
+}
+
+CameraSettings CameraInstance::getSettings() {
+  std::lock_guard<std::mutex> lock(settingsMutex);
+  return settings;
+}
+
+bool CameraInstance::applySettings(const CameraSettings &target) {
+  AutoLock deviceLock(camera->GetLock());
+  return withAcquisitionStopped([&] {
+    bool ok = true;
+    // Format and binning change the valid ranges of everything after them.
+    if (target.has(CameraSettings::kPixelFormat)) {
+      ok = setPixelFormat(target.pixelFormat) && ok;
+    }
+    if (target.has(CameraSettings::kBinning)) {
+      ok = setPixelBinning(target.binMode, target.horzBin, target.vertBin) &&
+           ok;
+    }
+    if (target.has(CameraSettings::kFrameRate)) {
+      ok = setFrameRate(target.frameRate) && ok;
+    }
+    if (target.has(CameraSettings::kExposure)) {
+      ok = setExposure(target.exposure) && ok;
+    }
+    if (target.has(CameraSettings::kAutoExposure)) {
+      ok = setAutoExposure(target.autoExposure) && ok;
+    }
+    if (target.has(CameraSettings::kGain)) {
+      ok = setGain(target.gain) && ok;
+    }
+    if (target.has(CameraSettings::kWhiteBalance)) {
+      ok = setWhiteBalance(target.whiteBalance) && ok;
+    }
+    if (target.has(CameraSettings::kAutoWhiteBalance)) {
+      ok = setAutoWhiteBalance(target.autoWhiteBalance) && ok;
+    }
+    if (target.has(CameraSettings::kBrightness)) {
+      ok = setBrightness(target.brightness) && ok;
+    }
+    return ok;
+  });
+}
+
+void CameraInstance::captureSettings() {
+  AutoLock deviceLock(camera->GetLock());
+  CameraSettings captured;
+
+  double exposure = getExposure();
+  if (exposure >= 0) {
+    captured.exposure = exposure;
+    captured.fields |= CameraSettings::kExposure;
+  }
+  // A camera without the node must not record "off", or every restore
+  // would try to write it.
+  if (camera->ExposureAuto.IsReadable()) {
+    captured.autoExposure = getAutoExposure();
+    captured.fields |= CameraSettings::kAutoExposure;
+  }
+
+  double gain = getGain();
+  if (gain >= 0) {
+    captured.gain = gain;
+    captured.fields |= CameraSettings::kGain;
+  }
+
+  double frameRate = getFrameRate();
+  if (frameRate >= 0) {
+    captured.frameRate = frameRate;
+    captured.fields |= CameraSettings::kFrameRate;
+  }
+
+  auto balance = getWhiteBalance();
+  if (balance[0] >= 0) {
+    captured.whiteBalance = balance;
+    captured.fields |= CameraSettings::kWhiteBalance;
+  }
+  // Mono cameras have no BalanceWhiteAuto.
+  if (camera->BalanceWhiteAuto.IsReadable()) {
+    captured.autoWhiteBalance = getAutoWhiteBalance();
+    captured.fields |= CameraSettings::kAutoWhiteBalance;
+  }
+
+  int format = getPixelFormat();
+  if (format >= 0) {
+    captured.pixelFormat = format;
+    captured.fields |= CameraSettings::kPixelFormat;
+  }
+
+  try {
+    if (camera->BslBrightness.IsReadable()) {
+      captured.brightness = camera->BslBrightness.GetValue();
+      captured.fields |= CameraSettings::kBrightness;
+    }
+    if (camera->BinningHorizontal.IsReadable() &&
+        camera->BinningVertical.IsReadable() &&
+        camera->BinningHorizontalMode.IsReadable()) {
+      captured.binMode = camera->BinningHorizontalMode.GetValue() ==
+                                 BinningHorizontalMode_Sum
+                             ? 1
+                             : 0;
+      captured.horzBin =
+          static_cast<int>(camera->BinningHorizontal.GetValue());
+      captured.vertBin = static_cast<int>(camera->BinningVertical.GetValue());
+      captured.fields |= CameraSettings::kBinning;
+    }
+  } catch (const GenericException &e) {
+    BJNI_LOG_ERROR("CameraInstance::captureSettings",
+                   "Exception reading settings: " << e.GetDescription());
+  }
+
+  std::lock_guard<std::mutex> lock(settingsMutex);
+  settings = captured;
+}
+
+// Disconnect handling
+
+int CameraInstance::getConnectionState() const {
+  return connectionState.load();
+}
+
+void CameraInstance::RemovalHandler::OnCameraDeviceRemoved(CInstantCamera &) {
+  owner.onDeviceRemoved();
+}
+
+void CameraInstance::onDeviceRemoved() {
+  int expected = kConnected;
+  if (!connectionState.compare_exchange_strong(expected, kDisconnected)) {
+    return;
+  }
+  removedAtNs.store(steadyNowNs());
+  stats.disconnects.fetch_add(1, std::memory_order_relaxed);
+  BJNI_LOG_WARN("CameraInstance::onDeviceRemoved",
+                "Camera " << serial
+                          << " removed, reconnecting in the background");
+
+  // Notify under the lock so the wakeup cannot slip in between the reconnect
+  // thread's predicate check and its wait.
+  std::lock_guard<std::mutex> lock(reconnectMutex);
+  reconnectCv.notify_all();
+}
+
+void CameraInstance::reconnectLoop() {
+  constexpr auto kMinBackoff = std::chrono::milliseconds(250);
+  constexpr auto kMaxBackoff = std::chrono::milliseconds(2000);
+  auto backoff = kMinBackoff;
+  uint64_t scheduleApplied = 0;
+  followThreadSchedule(scheduleApplied, kThreadReconnect);
+
+  std::unique_lock<std::mutex> lock(reconnectMutex);
+  while (true) {
+    // Also wakes for a new thread schedule, since this is the one worker
+    // every camera has.
+    reconnectCv.wait(lock, [&] {
+      return shuttingDown || connectionState.load() != kConnected ||
+             scheduleGeneration.load() != scheduleApplied;
+    });
+    if (shuttingDown) {
+      forgetThreadSchedule(kThreadReconnect);
+      return;
+    }
+
+    lock.unlock();
+    followThreadSchedule(scheduleApplied, kThreadReconnect);
+    if (connectionState.load() == kConnected) {
+      lock.lock();
+      continue;
+    }
+    bool reconnected = tryReconnect();
+    lock.lock();
+
+    if (reconnected) {
+      backoff = kMinBackoff;
+    } else {
+      reconnectCv.wait_for(lock, backoff, [this] { return shuttingDown; });
+      backoff = std::min(backoff * 2, kMaxBackoff);
+    }
+  }
+}
+
+bool CameraInstance::tryReconnect() {
+  connectionState.store(kReconnecting);
+
+  try {
+    // Setters and getters hold the same lock around every node access, so
+    // none of them can be inside a node of the device being destroyed.
+    {
+      AutoLock lock(camera->GetLock());
+      camera->DestroyDevice();
+    }
+
+    DeviceCache &cache = DeviceCache::instance();
+    cache.refresh();
+    CDeviceInfo devInfo;
+    if (!cache.find(serial, devInfo)) {
+      connectionState.store(kDisconnected);
+      return false;
+    }
+
+    AutoLock lock(camera->GetLock());
+    camera->Attach(CTlFactory::GetInstance().CreateDevice(devInfo));
+    camera->Open();
+  } catch (const GenericException &e) {
+    BJNI_LOG_DEBUG("CameraInstance::tryReconnect",
+                   "Camera " << serial << " not back yet: "
+                             << e.GetDescription());
+    connectionState.store(kDisconnected);
+    return false;
+  }
+
+  // Mark connected before restoring so start() and the setters go through.
+  connectionState.store(kConnected);
+  applySettings(getSettings());
+
+  bool restoreTransport;
+  {
+    std::lock_guard<std::mutex> lock(transportMutex);
+    restoreTransport = gigeConfigured;
+  }
+  if (restoreTransport) {
+    applyGigETransport();
+    // Through the balancer, so this write cannot overlap a rebalance; the
+    // device may also have come back on another interface.
+    if (inBandwidthBalancer.load()) {
+      BandwidthBalancer::instance().join(this, linkInterface());
+    } else {
+      applyBandwidthShare(0.0);
+    }
+  }
+  applyAutoFunctions();
+  if (chunksEnabled.load()) {
+    setChunkMetadata(true);
+  }
+  auto plan = std::atomic_load(&bracketPlan);
+  if (plan && plan->sequencer) {
+    applySequencer(plan->exposuresUs);
+  }
+  if (latencyMode.load()) {
+    // Brings back the test image and re-latches the camera clock, which
+    // restarted with the device.
+    setLatencyTestMode(true);
+  }
+  if (wantGrabbing.load()) {
+    start();
+  }
+
+  int64_t removedAt = removedAtNs.load();
+  if (removedAt != 0) {
+    stats.lastReconnectMs.store((steadyNowNs() - removedAt) / 1e6,
+                                std::memory_order_relaxed);
+  }
+  stats.reconnects.fetch_add(1, std::memory_order_relaxed);
+  BJNI_LOG_INFO("CameraInstance::tryReconnect",
+                "Camera " << serial << " reconnected");
+  return true;
+}
+
+// Auto functions
+
+namespace {
+
+// Writes a lower/upper limit pair, ordering the writes so the camera never
+// sees lower > upper in between.
+template <typename Param>
+void setLimits(Param &lowerParam, Param &upperParam, double lower,
+               double upper) {
+  if (lower >= 0 && upper >= 0) {
+    lower = std::min(lower, upper);
+  }
+  if (upper >= 0 && upperParam.IsWritable() && lowerParam.IsReadable() &&
+      upper < lowerParam.GetValue() && lowerParam.IsWritable()) {
+    lowerParam.SetValue(lower >= 0 ? lower : upper,
+                        FloatValueCorrection_ClipToRange);
+  }
+  if (lower >= 0 && lowerParam.IsWritable()) {
+    if (upperParam.IsWritable() && lower > upperParam.GetValue()) {
+      upperParam.SetValue(upper >= 0 ? upper : lower,
+                          FloatValueCorrection_ClipToRange);
+    }
+    lowerParam.SetValue(lower, FloatValueCorrection_ClipToRange);
+  }
+  if (upper >= 0 && upperParam.IsWritable()) {
+    upperParam.SetValue(upper, FloatValueCorrection_ClipToRange);
+  }
+}
+
+} // namespace
+
+bool CameraInstance::configureAutoFunctions(const AutoFunctionConfig &config) {
+  {
+    std::lock_guard<std::mutex> lock(settingsMutex);
+    autoConfig = config;
+    autoConfigured = true;
+  }
+  return applyAutoFunctions();
+}
+
+double CameraInstance::frameRateExposureCapUs() const {
+  AutoLock deviceLock(camera->GetLock());
+  if (!camera->AcquisitionFrameRateEnable.IsReadable() ||
+      !camera->AcquisitionFrameRateEnable.GetValue() ||
+      !camera->AcquisitionFrameRate.IsReadable()) {
+    return -1.0;
+  }
+  double frameRate = camera->AcquisitionFrameRate.GetValue();
+  if (frameRate <= 0) {
+    return -1.0;
+  }
+
+  double cap = 1e6 / frameRate;
+  // Without overlapped exposure the sensor readout also has to fit in the
+  // frame period, so leave room for it.
+  if (camera->SensorReadoutTime.IsReadable()) {
+    cap -= camera->SensorReadoutTime.GetValue();
+  }
+  return cap;
+}
+
+bool CameraInstance::applyAutoFunctions() {
+  AutoLock deviceLock(camera->GetLock());
+  AutoFunctionConfig config;
+  {
+    std::lock_guard<std::mutex> lock(settingsMutex);
+    if (!autoConfigured) {
+      return true;
+    }
+    config = autoConfig;
+  }
+
+  try {
+    if (camera->AutoFunctionROISelector.IsWritable()) {
+      camera->AutoFunctionROISelector.SetValue(AutoFunctionROISelector_ROI1);
+      int64_t width = config.roiWidth > 0 ? config.roiWidth
+                                          : camera->Width.GetValue();
+      int64_t height = config.roiHeight > 0 ? config.roiHeight
+                                            : camera->Height.GetValue();
+      int64_t x = config.roiWidth > 0 ? config.roiX : 0;
+      int64_t y = config.roiHeight > 0 ? config.roiY : 0;
+      // Zero the offsets first so the new size is always in range.
+      camera->AutoFunctionROIOffsetX.SetValue(0);
+      camera->AutoFunctionROIOffsetY.SetValue(0);
+      camera->AutoFunctionROIWidth.SetValue(width,
+                                            IntegerValueCorrection_Nearest);
+      camera->AutoFunctionROIHeight.SetValue(height,
+                                             IntegerValueCorrection_Nearest);
+      camera->AutoFunctionROIOffsetX.SetValue(x,
+                                              IntegerValueCorrection_Nearest);
+      camera->AutoFunctionROIOffsetY.SetValue(y,
+                                              IntegerValueCorrection_Nearest);
+      if (camera->AutoFunctionROIUseBrightness.IsWritable()) {
+        camera->AutoFunctionROIUseBrightness.SetValue(true);
+      }
+    }
+
+    double exposureUpper = config.exposureUpperUs;
+    if (config.capExposureToFrameRate) {
+      double cap = frameRateExposureCapUs();
+      if (cap > 0) {
+        exposureUpper = exposureUpper >= 0 ? std::min(exposureUpper, cap) : cap;
+      }
+    }
+    setLimits(camera->AutoExposureTimeLowerLimit,
+              camera->AutoExposureTimeUpperLimit, config.exposureLowerUs,
+              exposureUpper);
+    setLimits(camera->AutoGainLowerLimit, camera->AutoGainUpperLimit,
+              config.gainLower, config.gainUpper);
+
+    if (config.targetBrightness >= 0 &&
+        camera->AutoTargetBrightness.IsWritable()) {
+      camera->AutoTargetBrightness.SetValue(config.targetBrightness,
+                                            FloatValueCorrection_ClipToRange);
+    }
+    if (config.profile >= 0 && camera->AutoFunctionProfile.IsWritable()) {
+      camera->AutoFunctionProfile.SetValue(
+          config.profile == 0 ? AutoFunctionProfile_MinimizeGain
+                              : AutoFunctionProfile_MinimizeExposureTime);
     }
+    return true;
+  } catch (const GenericException &e) {
+    BJNI_LOG_ERROR("CameraInstance::applyAutoFunctions",
+                   "Exception applying auto function settings: "
+                   << e.GetDescription());
+  }
+  return false;
+}
+
+bool CameraInstance::triggerAutoExposureOnce() {
+  AutoLock deviceLock(camera->GetLock());
+  bool autoGain;
+  {
+    std::lock_guard<std::mutex> lock(settingsMutex);
+    autoGain = autoConfigured && autoConfig.autoGain;
+  }
 
+  try {
+    if (!camera->ExposureAuto.IsWritable()) {
+      BJNI_LOG_WARN("CameraInstance::triggerAutoExposureOnce",
+                    "ExposureAuto not writable.");
+      return false;
+    }
+    if (autoGain && camera->GainAuto.IsWritable()) {
+      camera->GainAuto.SetValue(GainAuto_Once);
+    }
+    camera->ExposureAuto.SetValue(ExposureAuto_Once);
+    // The camera drops back to Off once it converges, leaving the settled
+    // exposure in place. Until getAutoExposureState sees that, the recorded
+    // values are stale and must not be restored.
+    recordSettings([&](CameraSettings &s) {
+      s.autoExposure = false;
+      s.fields |= CameraSettings::kAutoExposure;
+      s.fields &= ~CameraSettings::kExposure;
+      if (autoGain) {
+        s.fields &= ~CameraSettings::kGain;
+      }
+    });
+    autoOncePending.store(true);
+    return true;
   } catch (const GenericException &e) {
-    std::cout << "[CameraInstance::setPixelBinning] Exception setting pixel "
-                 "binning: "
-              << e.GetDescription() << std::endl;
+    BJNI_LOG_ERROR("CameraInstance::triggerAutoExposureOnce",
+                   "Exception during triggerAutoExposureOnce: "
+                   << e.GetDescription());
   }
   return false;
-}
\ No newline at end of file
+}
+
+int CameraInstance::getAutoExposureState() {
+  AutoLock deviceLock(camera->GetLock());
+  try {
+    if (camera->ExposureAuto.IsReadable()) {
+      switch (camera->ExposureAuto.GetValue()) {
+      case ExposureAuto_Continuous:
+        return kAutoExposureContinuous;
+      case ExposureAuto_Once:
+        return kAutoExposureConverging;
+      default:
+        if (autoOncePending.exchange(false)) {
+          double exposure = camera->ExposureTime.GetValue();
+          bool hasGain = camera->Gain.IsReadable();
+          double gain = hasGain ? camera->Gain.GetValue() : 0.0;
+          recordSettings([&](CameraSettings &s) {
+            s.exposure = exposure;
+            s.fields |= CameraSettings::kExposure;
+            if (hasGain) {
+              s.gain = gain;
+              s.fields |= CameraSettings::kGain;
+            }
+          });
+        }
+        return kAutoExposureOff;
+      }
+    }
+  } catch (const GenericException &e) {
+    BJNI_LOG_ERROR("CameraInstance::getAutoExposureState",
+                   "Exception during getAutoExposureState: "
+                   << e.GetDescription());
+  }
+  return -1;
+}
+
+// Software auto exposure
+
+bool CameraInstance::configureSoftwareAutoExposure(
+    const SoftwareAutoExposureConfig &config) {
+  if (config.control) {
+    try {
+      AutoLock deviceLock(camera->GetLock());
+      if (camera->ExposureAuto.IsWritable()) {
+        camera->ExposureAuto.SetValue(ExposureAuto_Off);
+        // Otherwise a reconnect would hand exposure back to the camera.
+        recordSettings([&](CameraSettings &s) {
+          s.autoExposure = false;
+          s.fields |= CameraSettings::kAutoExposure;
+        });
+      }
+      if (camera->GainAuto.IsWritable()) {
+        camera->GainAuto.SetValue(GainAuto_Off);
+      }
+    } catch (const GenericException &e) {
+      BJNI_LOG_ERROR("CameraInstance::configureSoftwareAutoExposure",
+                     "Exception disabling camera auto functions: "
+                     << e.GetDescription());
+      return false;
+    }
+  }
+
+  bool enable = config.histogram || config.control;
+  {
+    std::lock_guard<std::mutex> lock(aeMutex);
+    aeConfig = config;
+    latestHistogram = LumaHistogram();
+    histogramSequence = 0;
+  }
+  histogramEnabled.store(enable);
+
+  if (config.control && !aeThread.joinable()) {
+    aeThread = std::thread(&CameraInstance::softwareAutoExposureLoop, this);
+  } else if (!config.control) {
+    stopSoftwareAutoExposure();
+  }
+  return true;
+}
+
+LumaHistogram CameraInstance::getLumaHistogram() {
+  std::lock_guard<std::mutex> lock(aeMutex);
+  return latestHistogram;
+}
+
+void CameraInstance::publishHistogram(const cv::Mat &frame,
+                                      uint64_t sequence) {
+  cv::Rect roi;
+  int subsample;
+  {
+    std::unique_lock<std::mutex> lock(aeMutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+      return;
+    }
+    roi = cv::Rect(aeConfig.roiX, aeConfig.roiY, aeConfig.roiWidth,
+                   aeConfig.roiHeight);
+    subsample = aeConfig.subsample;
+  }
+
+  LumaHistogram histogram;
+  computeLumaHistogram(frame, roi, subsample, histogram);
+
+  {
+    // Missing one histogram is harmless; stalling the grab thread is not.
+    std::unique_lock<std::mutex> lock(aeMutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+      return;
+    }
+    latestHistogram = histogram;
+    histogramSequence = sequence;
+  }
+  aeCv.notify_one();
+}
+
+void CameraInstance::stopSoftwareAutoExposure() {
+  if (!aeThread.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(aeMutex);
+    aeStopping = true;
+  }
+  aeCv.notify_all();
+  aeThread.join();
+
+  std::lock_guard<std::mutex> lock(aeMutex);
+  aeStopping = false;
+}
+
+void CameraInstance::softwareAutoExposureLoop() {
+  // A new exposure shows up a frame or two after it is written, so skip the
+  // frames that were already in flight before judging its effect.
+  constexpr uint64_t kSettleFrames = 2;
+
+  pthread_setname_np(pthread_self(), "bjni-ae");
+
+  ExposureController controller;
+  uint64_t handledSequence = 0;
+  uint64_t settleUntil = 0;
+  uint64_t scheduleApplied = 0;
+  followThreadSchedule(scheduleApplied, kThreadAutoExposure);
+
+  std::unique_lock<std::mutex> lock(aeMutex);
+  while (true) {
+    aeCv.wait(lock, [&] {
+      return aeStopping || histogramSequence > handledSequence;
+    });
+    if (aeStopping) {
+      forgetThreadSchedule(kThreadAutoExposure);
+      return;
+    }
+
+    handledSequence = histogramSequence;
+    if (handledSequence <= settleUntil) {
+      continue;
+    }
+    double meanLuma = latestHistogram.mean();
+    SoftwareAutoExposureConfig config = aeConfig;
+    lock.unlock();
+
+    followThreadSchedule(scheduleApplied, kThreadAutoExposure);
+
+    try {
+      AutoLock deviceLock(camera->GetLock());
+      ExposureControllerConfig limits;
+      limits.targetLuma = config.targetLuma;
+      limits.kp = config.kp;
+      limits.ki = config.ki;
+      limits.maxStepRatio = config.maxStepRatio;
+      limits.minExposureUs = camera->ExposureTime.GetMin();
+      limits.maxExposureUs = camera->ExposureTime.GetMax();
+      double cap = config.maxExposureUs > 0 ? config.maxExposureUs
+                                            : frameRateExposureCapUs();
+      if (cap > 0) {
+        limits.maxExposureUs =
+            std::clamp(cap, limits.minExposureUs, limits.maxExposureUs);
+      }
+      bool hasGain = camera->Gain.IsWritable();
+      limits.minGain = hasGain ? camera->Gain.GetMin() : 0.0;
+      limits.maxGain = hasGain ? camera->Gain.GetMax() : 0.0;
+      if (hasGain && config.maxGain >= 0) {
+        limits.maxGain = std::clamp(config.maxGain, limits.minGain,
+                                    limits.maxGain);
+      }
+      controller.setConfig(limits);
+
+      double gain = hasGain ? camera->Gain.GetValue() : 0.0;
+      auto next =
+          controller.step(meanLuma, camera->ExposureTime.GetValue(), gain);
+      camera->ExposureTime.SetValue(next.exposureUs,
+                                    FloatValueCorrection_ClipToRange);
+      if (hasGain) {
+        camera->Gain.SetValue(next.gain, FloatValueCorrection_ClipToRange);
+      }
+      // Keeps profiles and the reconnect restore at the controller's latest
+      // values.
+      recordSettings([&](CameraSettings &s) {
+        s.exposure = next.exposureUs;
+        s.fields |= CameraSettings::kExposure;
+        if (hasGain) {
+          s.gain = next.gain;
+          s.fields |= CameraSettings::kGain;
+        }
+      });
+    } catch (const GenericException &e) {
+      BJNI_LOG_ERROR("CameraInstance::softwareAutoExposureLoop",
+                     "Exception during controller step: "
+                     << e.GetDescription());
+      controller.reset();
+    }
+
+    settleUntil = mailbox.sequence() + kSettleFrames;
+    lock.lock();
+  }
+}
+
+// Change detection
+
+bool CameraInstance::configureChangeDetection(
+    const ChangeDetectorConfig *config) {
+  std::atomic_store(&changeDetector,
+                    config ? std::make_shared<ChangeDetector>(*config)
+                           : std::shared_ptr<ChangeDetector>());
+  return true;
+}
+
+bool CameraInstance::scoreChange(const CGrabResultPtr &grabResult,
+                                 FrameMetadata &metadata) {
+  auto detector = std::atomic_load(&changeDetector);
+  int pixelBytes, lumaOffset;
+  if (!detector ||
+      !lumaLayout(grabResult->GetPixelType(), pixelBytes, lumaOffset)) {
+    return true;
+  }
+
+  int width = static_cast<int>(grabResult->GetWidth());
+  size_t stride =
+      static_cast<size_t>(width) * pixelBytes + grabResult->GetPaddingX();
+  double score = detector->measure(
+      static_cast<const uint8_t *>(grabResult->GetBuffer()), width,
+      static_cast<int>(grabResult->GetHeight()), stride, pixelBytes,
+      lumaOffset);
+  if (detector->shouldSuppress(score)) {
+    return false;
+  }
+
+  detector->accept();
+  if (score >= 0) {
+    metadata.changeScore = score;
+    metadata.fields |= FrameMetadata::kChangeScore;
+  }
+  return true;
+}
+
+// Exposure bracketing
+
+int CameraInstance::configureExposureBracketing(const BracketConfig *config) {
+  // The writer takes the device lock, so it is stopped before taking it here.
+  stopBracketWriter();
+  AutoLock deviceLock(camera->GetLock());
+  int mode = applyExposureBracketing(config);
+
+  // On failure the previous plan stays, and may still need its writer.
+  auto plan = std::atomic_load(&bracketPlan);
+  if (plan && !plan->sequencer && !bracketThread.joinable()) {
+    bracketThread = std::thread(&CameraInstance::bracketWriterLoop, this);
+  }
+  return mode;
+}
+
+int CameraInstance::applyExposureBracketing(const BracketConfig *config) {
+  if (!config) {
+    auto old = std::atomic_exchange(&bracketPlan,
+                                    std::shared_ptr<const BracketPlan>());
+    if (old && old->sequencer) {
+      withAcquisitionStopped([&] {
+        camera->SequencerMode.SetValue(SequencerMode_Off);
+        return true;
+      });
+    }
+    restoreBracketState();
+    std::lock_guard<std::mutex> lock(fusedMutex);
+    currentFusedPtr.reset();
+    return kBracketOff;
+  }
+
+  size_t count = config->exposuresUs.size();
+  if (count < 2 || count > 4 ||
+      std::any_of(config->exposuresUs.begin(), config->exposuresUs.end(),
+                  [](double exposure) { return exposure <= 0; })) {
+    BJNI_LOG_WARN("CameraInstance::configureExposureBracketing",
+                  "Need 2-4 positive exposure times.");
+    return -1;
+  }
+  if (config->fuse && count != 2) {
+    BJNI_LOG_WARN("CameraInstance::configureExposureBracketing",
+                  "Fusion needs exactly 2 exposure times, got " << count
+                                                                << ".");
+    return -1;
+  }
+
+  auto plan = std::make_shared<BracketPlan>();
+  plan->exposuresUs = config->exposuresUs;
+  std::sort(plan->exposuresUs.begin(), plan->exposuresUs.end());
+  if (config->fuse) {
+    plan->fusion = std::make_unique<ExposureFusion>(
+        plan->exposuresUs[1] / plan->exposuresUs[0], config->fusionKnee);
+  }
+
+  // Only the state from before the first plan is worth going back to.
+  bool saved = false;
+  if (!bracketRestorePending) {
+    saved = saveBracketState();
+    if (!saved) {
+      return -1;
+    }
+  }
+  // Undoes what a failed first enable already changed.
+  auto fail = [&] {
+    if (saved) {
+      restoreBracketState();
+    }
+    return -1;
+  };
+
+  // Frames are tagged from their sequencer set or exposure chunk.
+  if (!chunksEnabled.load() && !setChunkMetadata(true)) {
+    BJNI_LOG_WARN("CameraInstance::configureExposureBracketing",
+                  "Camera " << serial
+                            << " cannot tag frames without chunk data.");
+    return fail();
+  }
+
+  try {
+    if (camera->ExposureAuto.IsWritable()) {
+      camera->ExposureAuto.SetValue(ExposureAuto_Off);
+    }
+  } catch (const GenericException &e) {
+    BJNI_LOG_ERROR("CameraInstance::configureExposureBracketing",
+                   "Exception disabling ExposureAuto: " << e.GetDescription());
+    return fail();
+  }
+
+  bool useSequencer = config->preferSequencer &&
+                      camera->SequencerMode.IsValid() &&
+                      withAcquisitionStopped([&] {
+                        return applySequencer(plan->exposuresUs);
+                      });
+  if (!useSequencer) {
+    try {
+      if (camera->SequencerMode.IsWritable()) {
+        camera->SequencerMode.SetValue(SequencerMode_Off);
+      }
+      camera->ExposureTime.SetValue(plan->exposuresUs[0],
+                                    FloatValueCorrection_ClipToRange);
+    } catch (const GenericException &e) {
+      BJNI_LOG_ERROR("CameraInstance::configureExposureBracketing",
+                     "Exception setting the first exposure: "
+                     << e.GetDescription());
+      return fail();
+    }
+  }
+  plan->sequencer = useSequencer;
+
+  std::atomic_store(&bracketPlan,
+                    std::shared_ptr<const BracketPlan>(std::move(plan)));
+  return useSequencer ? kBracketSequencer : kBracketHost;
+}
+
+bool CameraInstance::saveBracketState() {
+  try {
+    BracketRestore state;
+    state.exposureUs = camera->ExposureTime.GetValue();
+    state.hasExposureAuto = camera->ExposureAuto.IsReadable();
+    if (state.hasExposureAuto) {
+      state.exposureAuto = camera->ExposureAuto.GetValue();
+    }
+    state.chunks = chunksEnabled.load();
+    bracketRestore = state;
+    bracketRestorePending = true;
+    return true;
+  } catch (const GenericException &e) {
+    BJNI_LOG_ERROR("CameraInstance::saveBracketState",
+                   "Exception reading the exposure state: "
+                   << e.GetDescription());
+    return false;
+  }
+}
+
+void CameraInstance::restoreBracketState() {
+  if (!bracketRestorePending) {
+    return;
+  }
+  bracketRestorePending = false;
+  try {
+    camera->ExposureTime.SetValue(bracketRestore.exposureUs,
+                                  FloatValueCorrection_ClipToRange);
+    if (bracketRestore.hasExposureAuto && camera->ExposureAuto.IsWritable()) {
+      camera->ExposureAuto.SetValue(bracketRestore.exposureAuto);
+    }
+  } catch (const GenericException &e) {
+    BJNI_LOG_ERROR("CameraInstance::restoreBracketState",
+                   "Exception restoring the exposure: " << e.GetDescription());
+  }
+  if (!bracketRestore.chunks && chunksEnabled.load()) {
+    setChunkMetadata(false);
+  }
+}
+
+std::shared_ptr<cv::Mat> CameraInstance::takeFusedFrame() {
+  std::lock_guard<std::mutex> lock(fusedMutex);
+  return currentFusedPtr;
+}
+
+bool CameraInstance::applySequencer(const std::vector<double> &exposuresUs) {
+  AutoLock deviceLock(camera->GetLock());
+  try {
+    camera->SequencerMode.SetValue(SequencerMode_Off);
+    camera->SequencerConfigurationMode.SetValue(
+        SequencerConfigurationMode_On);
+
+    int64_t count = static_cast<int64_t>(exposuresUs.size());
+    for (int64_t set = 0; set < count; set++) {
+      // Each set snapshots every sequenceable parameter, so only the
+      // exposure differs between them.
+      camera->SequencerSetSelector.SetValue(set);
+      camera->ExposureTime.SetValue(exposuresUs[set],
+                                    FloatValueCorrection_ClipToRange);
+      camera->SequencerPathSelector.SetValue(0);
+      camera->SequencerSetNext.SetValue((set + 1) % count);
+      if (!camera->SequencerTriggerSource.TrySetValue(
+              SequencerTriggerSource_FrameStart)) {
+        camera->SequencerTriggerSource.SetValue(
+            SequencerTriggerSource_ExposureActive);
+      }
+      camera->SequencerSetSave.Execute();
+    }
+    if (camera->SequencerSetStart.IsWritable()) {
+      camera->SequencerSetStart.SetValue(0);
+    }
+
+    camera->SequencerConfigurationMode.SetValue(
+        SequencerConfigurationMode_Off);
+    camera->SequencerMode.SetValue(SequencerMode_On);
+    return true;
+  } catch (const GenericException &e) {
+    BJNI_LOG_ERROR("CameraInstance::applySequencer",
+                   "Exception programming the sequencer: "
+                   << e.GetDescription());
+    try {
+      camera->SequencerConfigurationMode.TrySetValue(
+          SequencerConfigurationMode_Off);
+    } catch (const GenericException &) {
+    }
+    return false;
+  }
+}
+
+void CameraInstance::tagBracket(const CBaslerUniversalGrabResultPtr &grabResult,
+                                FrameMetadata &metadata) {
+  auto plan = std::atomic_load(&bracketPlan);
+  if (plan != bracketPlanSeen) {
+    bracketPlanSeen = plan;
+    bracketRequested = 0;
+    bracketPrevFrame.reset();
+  }
+  if (!plan) {
+    return;
+  }
+
+  const auto &exposures = plan->exposuresUs;
+  int count = static_cast<int>(exposures.size());
+  int index = -1;
+  if (plan->sequencer && grabResult->IsChunkDataAvailable() &&
+      grabResult->ChunkSequencerSetActive.IsReadable()) {
+    index = static_cast<int>(grabResult->ChunkSequencerSetActive.GetValue());
+  } else if (metadata.fields & FrameMetadata::kExposure) {
+    // The camera rounds exposures to its own step, so match the nearest
+    // bracket by ratio.
+    double best = std::numeric_limits<double>::max();
+    for (int i = 0; i < count; i++) {
+      double distance = std::abs(std::log(metadata.exposureUs / exposures[i]));
+      if (distance < best) {
+        best = distance;
+        index = i;
+      }
+    }
+  }
+  if (index < 0 || index >= count) {
+    return;
+  }
+  metadata.bracketIndex = index;
+  metadata.fields |= FrameMetadata::kBracketIndex;
+
+  if (!plan->sequencer && index == bracketRequested) {
+    // Waiting for the requested bracket to show up keeps the cycle in step
+    // even when the camera applies writes a frame late. If the writer is
+    // busy, the next frame of this bracket asks again.
+    std::unique_lock<std::mutex> lock(bracketMutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+      return;
+    }
+    bracketRequested = (index + 1) % count;
+    bracketPendingUs = exposures[bracketRequested];
+    bracketPendingPlan = plan;
+    lock.unlock();
+    bracketCv.notify_one();
+  }
+}
+
+void CameraInstance::stopBracketWriter() {
+  if (!bracketThread.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(bracketMutex);
+    bracketStopping = true;
+  }
+  bracketCv.notify_all();
+  bracketThread.join();
+
+  std::lock_guard<std::mutex> lock(bracketMutex);
+  bracketStopping = false;
+  bracketPendingUs = 0;
+  bracketPendingPlan.reset();
+}
+
+void CameraInstance::bracketWriterLoop() {
+  pthread_setname_np(pthread_self(), "bjni-bracket");
+
+  uint64_t scheduleApplied = 0;
+  followThreadSchedule(scheduleApplied, kThreadBracket);
+
+  std::unique_lock<std::mutex> lock(bracketMutex);
+  while (true) {
+    bracketCv.wait(lock,
+                   [&] { return bracketStopping || bracketPendingUs > 0; });
+    if (bracketStopping) {
+      forgetThreadSchedule(kThreadBracket);
+      return;
+    }
+
+    double exposureUs = bracketPendingUs;
+    std::shared_ptr<const BracketPlan> requestedBy =
+        std::move(bracketPendingPlan);
+    bracketPendingUs = 0;
+    lock.unlock();
+
+    followThreadSchedule(scheduleApplied, kThreadBracket);
+
+    try {
+      AutoLock deviceLock(camera->GetLock());
+      // Checked under the device lock, which configureExposureBracketing
+      // holds while swapping plans, so a stale request never lands after a
+      // reconfigure or a restore.
+      if (std::atomic_load(&bracketPlan) == requestedBy) {
+        camera->ExposureTime.SetValue(exposureUs,
+                                      FloatValueCorrection_ClipToRange);
+      }
+    } catch (const GenericException &e) {
+      BJNI_LOG_ERROR("CameraInstance::bracketWriterLoop",
+                     "Exception setting the next exposure: "
+                     << e.GetDescription());
+    }
+    lock.lock();
+  }
+}
+
+std::shared_ptr<cv::Mat>
+CameraInstance::fuseBracket(const std::shared_ptr<cv::Mat> &frame,
+                            const FrameMetadata &metadata) {
+  if (!bracketPlanSeen || !bracketPlanSeen->fusion ||
+      metadata.bracketIndex < 0) {
+    return nullptr;
+  }
+
+  std::shared_ptr<cv::Mat> fused;
+  const auto &previous = bracketPrevFrame;
+  if (previous && bracketPrevMetadata.sequence + 1 == metadata.sequence &&
+      bracketPrevMetadata.bracketIndex != metadata.bracketIndex &&
+      previous->size() == frame->size() &&
+      previous->type() == frame->type()) {
+    bool frameIsShort = metadata.bracketIndex == 0;
+    fused = std::make_shared<cv::Mat>(frame->size(), frame->type());
+    fuseFrames(*bracketPlanSeen->fusion, frameIsShort ? *frame : *previous,
+               frameIsShort ? *previous : *frame, *fused);
+  }
+
+  bracketPrevFrame = frame;
+  bracketPrevMetadata = metadata;
+  return fused;
+}
+
+// Latency test mode
+
+bool CameraInstance::setLatencyTestMode(bool enable) {
+  AutoLock deviceLock(camera->GetLock());
+  if (!enable) {
+    if (!latencyMode.exchange(false)) {
+      return true;
+    }
+    return withAcquisitionStopped([&] {
+      camera->PixelFormat.SetValue(latencyRestore.pixelFormat);
+      if (latencyRestore.hasTestImage &&
+          camera->TestImageSelector.IsWritable()) {
+        camera->TestImageSelector.SetValue(latencyRestore.testImage);
+      }
+      recordSettings([&](CameraSettings &s) {
+        s.pixelFormat = latencyRestore.settingsPixelFormat;
+        if (latencyRestore.settingsHadPixelFormat) {
+          s.fields |= CameraSettings::kPixelFormat;
+        } else {
+          s.fields &= ~CameraSettings::kPixelFormat;
+        }
+      });
+      return true;
+    });
+  }
+
+  bool ok = withAcquisitionStopped([&] {
+    // Already on when a reconnect re-enters to reapply it; the state to go
+    // back to was saved the first time.
+    bool first = !latencyMode.load();
+    if (first) {
+      latencyRestore.pixelFormat = camera->PixelFormat.GetValue();
+      latencyRestore.hasTestImage = camera->TestImageSelector.IsReadable();
+      if (latencyRestore.hasTestImage) {
+        latencyRestore.testImage = camera->TestImageSelector.GetValue();
+      }
+    }
+
+    // Mono8 frames reach Java byte for byte, so the stamp survives.
+    camera->PixelFormat.SetValue(PixelFormat_Mono8);
+    if (camera->TestImageSelector.IsWritable()) {
+      camera->TestImageSelector.TrySetValue(TestImageSelector_Testimage1);
+    }
+    // Recorded so a settings restore keeps Mono8 rather than switching the
+    // format back under the stamp.
+    recordSettings([&](CameraSettings &s) {
+      if (first) {
+        latencyRestore.settingsPixelFormat = s.pixelFormat;
+        latencyRestore.settingsHadPixelFormat =
+            s.has(CameraSettings::kPixelFormat);
+      }
+      s.pixelFormat = toJavaPixelFormat(PixelFormat_Mono8);
+      s.fields |= CameraSettings::kPixelFormat;
+    });
+
+    // Latch the camera clock against the host clock once, splitting the
+    // difference of the round trip.
+    int64_t before = steadyNowNs();
+    int64_t ticks = -1;
+    double tickNs = 1.0;
+    if (camera->TimestampLatch.IsWritable()) {
+      camera->TimestampLatch.Execute();
+      ticks = camera->TimestampLatchValue.GetValue();
+    } else if (camera->GevTimestampControlLatch.IsWritable()) {
+      camera->GevTimestampControlLatch.Execute();
+      ticks = camera->GevTimestampValue.GetValue();
+      tickNs = 1e9 / camera->GevTimestampTickFrequency.GetValue();
+    }
+    int64_t after = steadyNowNs();
+
+    std::lock_guard<std::mutex> lock(latencyMutex);
+    latencyTraces.fill(LatencyTrace());
+    if (ticks >= 0) {
+      latencyTickNs = tickNs;
+      latencyClockOffsetNs =
+          (before + after) / 2 - static_cast<int64_t>(ticks * tickNs);
+    } else {
+      latencyTickNs = 0.0;
+    }
+    return true;
+  });
+  if (ok) {
+    latencyMode.store(true);
+  }
+  return ok;
+}
+
+bool CameraInstance::getLatencyTrace(uint64_t sequence, LatencyTrace &trace) {
+  std::lock_guard<std::mutex> lock(latencyMutex);
+  const LatencyTrace &slot = latencySlot(sequence);
+  if (sequence == 0 || slot.sequence != sequence) {
+    return false;
+  }
+  trace = slot;
+  return true;
+}
+
+int64_t CameraInstance::cameraToHostNs(uint64_t ticks) {
+  if (latencyTickNs <= 0.0) {
+    return -1;
+  }
+  return latencyClockOffsetNs + static_cast<int64_t>(ticks * latencyTickNs);
+}
+
+LatencyTrace &CameraInstance::latencySlot(uint64_t sequence) {
+  return latencyTraces[sequence % kLatencyTraceFrames];
+}
+
+// Tag detection
+
+bool CameraInstance::configureTagDetection(const TagDetectorConfig *config) {
+  if (!config) {
+    tagEnabled.store(false);
+    stopTagDetection();
+    return true;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(tagMutex);
+    tagConfig = *config;
+    tagConfigGeneration++;
+    tagResult = TagDetectionResult();
+  }
+  tagEnabled.store(true);
+
+  if (!tagThread.joinable()) {
+    tagThread = std::thread(&CameraInstance::tagDetectionLoop, this);
+  }
+  return true;
+}
+
+bool CameraInstance::getTagDetections(TagDetectionResult &result) {
+  std::lock_guard<std::mutex> lock(tagMutex);
+  if (tagResult.sequence == 0) {
+    return false;
+  }
+  result = tagResult;
+  return true;
+}
+
+void CameraInstance::submitTagFrame(const std::shared_ptr<cv::Mat> &frame,
+                                    const FrameMetadata &metadata) {
+  {
+    // A busy worker just gets the newer frame next time it looks.
+    std::unique_lock<std::mutex> lock(tagMutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+      return;
+    }
+    // Published frames are never written again, so sharing avoids a copy.
+    tagPendingFrame = frame;
+    tagPendingMetadata = metadata;
+    tagPendingSinceNs = steadyNowNs();
+  }
+  tagCv.notify_one();
+}
+
+void CameraInstance::stopTagDetection() {
+  if (!tagThread.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(tagMutex);
+    tagStopping = true;
+  }
+  tagCv.notify_all();
+  tagThread.join();
+
+  std::lock_guard<std::mutex> lock(tagMutex);
+  tagStopping = false;
+  tagPendingFrame.reset();
+  tagResult = TagDetectionResult();
+}
+
+void CameraInstance::tagDetectionLoop() {
+  pthread_setname_np(pthread_self(), "bjni-tag");
+
+  std::unique_ptr<TagDetector> detector;
+  uint64_t detectorGeneration = 0;
+  uint64_t scheduleApplied = 0;
+  std::vector<TagDetection> detections;
+  followThreadSchedule(scheduleApplied, kThreadTagDetection);
+
+  std::unique_lock<std::mutex> lock(tagMutex);
+  while (true) {
+    tagCv.wait(lock, [&] { return tagStopping || tagPendingFrame; });
+    if (tagStopping) {
+      forgetThreadSchedule(kThreadTagDetection);
+      return;
+    }
+
+    std::shared_ptr<cv::Mat> frame = std::move(tagPendingFrame);
+    FrameMetadata metadata = tagPendingMetadata;
+    int64_t handedOffNs = tagPendingSinceNs;
+    if (!detector || detectorGeneration != tagConfigGeneration) {
+      detectorGeneration = tagConfigGeneration;
+      TagDetectorConfig config = tagConfig;
+      lock.unlock();
+      detector = std::make_unique<TagDetector>(config);
+    } else {
+      lock.unlock();
+    }
+
+    followThreadSchedule(scheduleApplied, kThreadTagDetection);
+
+    try {
+      detector->detect(*frame, detections);
+    } catch (const cv::Exception &e) {
+      BJNI_LOG_ERROR("CameraInstance::tagDetectionLoop",
+                     "Exception during detection: " << e.what());
+      detections.clear();
+    }
+    frame.reset();
+
+    lock.lock();
+    if (detectorGeneration != tagConfigGeneration) {
+      // Reconfigured mid-frame; these detections used the old settings.
+      continue;
+    }
+    tagResult.sequence = metadata.sequence;
+    tagResult.hostTimestampNs = metadata.hostTimestampNs;
+    tagResult.cameraTimestamp = metadata.cameraTimestamp;
+    tagResult.latencyNs = steadyNowNs() - handedOffNs;
+    tagResult.detections.swap(detections);
+  }
+}
+
+// GigE transport
+
+bool CameraInstance::configureGigETransport(const GigETransportConfig &config) {
+  try {
+    AutoLock deviceLock(camera->GetLock());
+    if (!camera->IsGigE()) {
+      BJNI_LOG_WARN("CameraInstance::configureGigETransport",
+                    "Camera " << serial << " is not a GigE camera.");
+      return false;
+    }
+  } catch (const GenericException &e) {
+    BJNI_LOG_ERROR("CameraInstance::configureGigETransport",
+                   "Exception: " << e.GetDescription());
+    return false;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(transportMutex);
+    gigeConfig = config;
+    gigeConfigured = true;
+  }
+
+  // Stream grabber parameters are only writable while not grabbing.
+  bool ok = withAcquisitionStopped([this] { return applyGigETransport(); });
+
+  // The balancer locks each member's device in turn, so it must be called
+  // without ours held.
+  if (config.shareBandwidth) {
+    inBandwidthBalancer.store(true);
+    BandwidthBalancer::instance().join(this, linkInterface());
+  } else {
+    if (inBandwidthBalancer.exchange(false)) {
+      BandwidthBalancer::instance().leave(this);
+    }
+    applyBandwidthShare(0.0);
+  }
+  return ok;
+}
+
+bool CameraInstance::configureUsbTransport(const UsbTransportConfig &config) {
+  AutoLock deviceLock(camera->GetLock());
+  try {
+    if (!camera->IsUsb()) {
+      BJNI_LOG_WARN("CameraInstance::configureUsbTransport",
+                    "Camera " << serial << " is not a USB camera.");
+      return false;
+    }
+  } catch (const GenericException &e) {
+    BJNI_LOG_ERROR("CameraInstance::configureUsbTransport",
+                   "Exception: " << e.GetDescription());
+    return false;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(transportMutex);
+    usbConfig = config;
+    usbConfigured = true;
+  }
+
+  // start() applies the settings, so only a running camera needs a restart.
+  return withAcquisitionStopped([] { return true; });
+}
+
+bool CameraInstance::applyUsbTransport() {
+  AutoLock deviceLock(camera->GetLock());
+  UsbTransportConfig config;
+  {
+    std::lock_guard<std::mutex> lock(transportMutex);
+    if (!usbConfigured) {
+      return true;
+    }
+    config = usbConfig;
+  }
+
+  try {
+    auto &streamParams = camera->GetStreamGrabberParams();
+    auto setIfWritable = [](auto &param, int64_t value) {
+      if (value >= 0 && param.IsWritable()) {
+        param.SetValue(value, IntegerValueCorrection_Nearest);
+      }
+    };
+    setIfWritable(streamParams.MaxTransferSize, config.maxTransferSize);
+    setIfWritable(streamParams.NumMaxQueuedUrbs, config.numMaxQueuedUrbs);
+    setIfWritable(streamParams.MaxBufferSize, config.maxBufferSize);
+    setIfWritable(camera->MaxNumBuffer, config.maxNumBuffer);
+
+    if (config.throughputLimitMode >= 0 &&
+        camera->DeviceLinkThroughputLimitMode.IsWritable()) {
+      camera->DeviceLinkThroughputLimitMode.SetValue(
+          config.throughputLimitMode ? DeviceLinkThroughputLimitMode_On
+                                     : DeviceLinkThroughputLimitMode_Off);
+      if (config.throughputLimitMode) {
+        setIfWritable(camera->DeviceLinkThroughputLimit,
+                      config.throughputLimit);
+      }
+    }
+    return true;
+  } catch (const GenericException &e) {
+    BJNI_LOG_ERROR("CameraInstance::applyUsbTransport",
+                   "Exception applying transport settings: "
+                   << e.GetDescription());
+  }
+  return false;
+}
+
+bool CameraInstance::applyGigETransport() {
+  AutoLock deviceLock(camera->GetLock());
+  GigETransportConfig config;
+  {
+    std::lock_guard<std::mutex> lock(transportMutex);
+    config = gigeConfig;
+  }
+
+  try {
+    auto &streamParams = camera->GetStreamGrabberParams();
+
+    if (config.packetSize <= 0) {
+      if (streamParams.AutoPacketSize.IsWritable()) {
+        streamParams.AutoPacketSize.SetValue(true);
+      }
+    } else if (camera->GevSCPSPacketSize.IsWritable()) {
+      if (streamParams.AutoPacketSize.IsWritable()) {
+        streamParams.AutoPacketSize.SetValue(false);
+      }
+      camera->GevSCPSPacketSize.SetValue(config.packetSize,
+                                         IntegerValueCorrection_Nearest);
+    }
+
+    if (config.maxResendRequests >= 0) {
+      if (streamParams.EnableResend.IsWritable()) {
+        streamParams.EnableResend.SetValue(config.maxResendRequests > 0);
+      }
+      if (config.maxResendRequests > 0 &&
+          streamParams.MaximumNumberResendRequests.IsWritable()) {
+        streamParams.MaximumNumberResendRequests.SetValue(
+            config.maxResendRequests, IntegerValueCorrection_Nearest);
+      }
+    }
+
+    if (config.socketBufferKb > 0 &&
+        streamParams.SocketBufferSize.IsWritable()) {
+      streamParams.SocketBufferSize.SetValue(config.socketBufferKb,
+                                             IntegerValueCorrection_Nearest);
+    }
+    return true;
+  } catch (const GenericException &e) {
+    BJNI_LOG_ERROR("CameraInstance::applyGigETransport",
+                   "Exception applying transport settings: "
+                   << e.GetDescription());
+  }
+  return false;
+}
+
+std::string CameraInstance::linkInterface() {
+  AutoLock deviceLock(camera->GetLock());
+  try {
+    // For GigE devices this is the address of the host NIC they sit behind.
+    const CDeviceInfo &info = camera->GetDeviceInfo();
+    if (info.IsInterfaceAvailable()) {
+      return std::string(info.GetInterface().c_str());
+    }
+  } catch (const GenericException &e) {
+    BJNI_LOG_WARN("CameraInstance::linkInterface",
+                  "Exception reading the host interface: "
+                  << e.GetDescription());
+  }
+  return "";
+}
+
+void CameraInstance::applyBandwidthShare(double share) {
+  AutoLock deviceLock(camera->GetLock());
+  // Leave headroom for resends and control traffic, as GevSCBWR does.
+  constexpr double kUsableLinkFraction = 0.9;
+
+  int interPacketDelay;
+  {
+    std::lock_guard<std::mutex> lock(transportMutex);
+    bandwidthShare = share;
+    interPacketDelay = gigeConfig.interPacketDelay;
+  }
+
+  try {
+    double linkBytesPerSec = 125e6; // assume 1 GbE if the camera won't say
+    if (camera->GevLinkSpeed.IsReadable()) {
+      linkBytesPerSec = camera->GevLinkSpeed.GetValue() * 1e6 / 8.0;
+    }
+    bool limit = share > 0.0;
+    double budget = linkBytesPerSec * kUsableLinkFraction * share;
+
+    bool hasThroughputLimit =
+        camera->DeviceLinkThroughputLimitMode.IsWritable();
+    if (hasThroughputLimit) {
+      camera->DeviceLinkThroughputLimitMode.SetValue(
+          limit ? DeviceLinkThroughputLimitMode_On
+                : DeviceLinkThroughputLimitMode_Off);
+      if (limit && camera->DeviceLinkThroughputLimit.IsWritable()) {
+        camera->DeviceLinkThroughputLimit.SetValue(
+            static_cast<int64_t>(budget), IntegerValueCorrection_Nearest);
+      }
+    }
+
+    // Older GigE models have no throughput limit, so pace packets instead.
+    if (camera->GevSCPD.IsWritable() &&
+        (interPacketDelay >= 0 || !hasThroughputLimit)) {
+      int64_t delay = std::max(interPacketDelay, 0);
+      if (interPacketDelay < 0 && limit &&
+          camera->GevSCPSPacketSize.IsReadable() &&
+          camera->GevTimestampTickFrequency.IsReadable()) {
+        double packetBytes = camera->GevSCPSPacketSize.GetValue();
+        double ticksPerSec = camera->GevTimestampTickFrequency.GetValue();
+        // Stretch each packet's slot from its wire time at full link speed
+        // to its wire time at the budgeted rate.
+        delay = static_cast<int64_t>(
+            packetBytes * (1.0 / budget - 1.0 / linkBytesPerSec) *
+            ticksPerSec);
+      }
+      camera->GevSCPD.SetValue(delay, IntegerValueCorrection_Nearest);
+    }
+  } catch (const GenericException &e) {
+    BJNI_LOG_ERROR("CameraInstance::applyBandwidthShare",
+                   "Exception applying bandwidth share: "
+                   << e.GetDescription());
+  }
+}
+
+bool CameraInstance::setThreadScheduling(const ThreadSchedule &schedule,
+                                         int grabEnginePriority,
+                                         int grabLoopPriority) {
+  AutoLock deviceLock(camera->GetLock());
+  // Pylon only reads the grab engine priority when grabbing starts.
+  bool ok = withAcquisitionStopped([&] {
+    if (grabEnginePriority >= 0) {
+      camera->InternalGrabEngineThreadPriorityOverride.SetValue(true);
+      camera->InternalGrabEngineThreadPriority.SetValue(std::clamp<int64_t>(
+          grabEnginePriority, camera->InternalGrabEngineThreadPriority.GetMin(),
+          camera->InternalGrabEngineThreadPriority.GetMax()));
+    } else {
+      camera->InternalGrabEngineThreadPriorityOverride.SetValue(false);
+    }
+
+    if (grabLoopPriority >= 0) {
+      camera->GrabLoopThreadPriorityOverride.SetValue(true);
+      camera->GrabLoopThreadPriority.SetValue(std::clamp<int64_t>(
+          grabLoopPriority, camera->GrabLoopThreadPriority.GetMin(),
+          camera->GrabLoopThreadPriority.GetMax()));
+    } else {
+      camera->GrabLoopThreadPriorityOverride.SetValue(false);
+    }
+    return true;
+  });
+  if (!ok) {
+    BJNI_LOG_ERROR("CameraInstance::setThreadScheduling",
+                   "Camera " << serial
+                             << " could not set its grab thread priorities.");
+    return false;
+  }
+
+  // Only hand the schedule to the worker threads once the Pylon side took.
+  {
+    std::lock_guard<std::mutex> lock(scheduleMutex);
+    threadSchedule = schedule;
+    scheduleConfigured = true;
+    // Each worker reports again once it has applied the new schedule.
+    for (auto &effective : effectiveSchedules) {
+      effective = EffectiveThreadSchedule();
+    }
+    scheduleGeneration++;
+  }
+  // The reconnect thread always exists, so the schedule takes effect now
+  // rather than on the next disconnect; the others pick it up on their next
+  // wakeup or at startup.
+  std::lock_guard<std::mutex> lock(reconnectMutex);
+  reconnectCv.notify_all();
+  return true;
+}
+
+std::vector<int> CameraInstance::getThreadScheduling() {
+  AutoLock deviceLock(camera->GetLock());
+  std::vector<int> result = {-1, -1, -1, 0};
+
+  try {
+    if (camera->InternalGrabEngineThreadPriorityOverride.GetValue()) {
+      result[0] =
+          static_cast<int>(camera->InternalGrabEngineThreadPriority.GetValue());
+    }
+    if (camera->GrabLoopThreadPriorityOverride.GetValue()) {
+      result[1] = static_cast<int>(camera->GrabLoopThreadPriority.GetValue());
+    }
+  } catch (const GenericException &e) {
+    BJNI_LOG_ERROR("CameraInstance::getThreadScheduling",
+                   "Exception reading thread priorities: "
+                   << e.GetDescription());
+  }
+
+  std::lock_guard<std::mutex> lock(scheduleMutex);
+  if (scheduleConfigured) {
+    result[2] = threadSchedule.fifoPriority;
+    result[3] = static_cast<int>(threadSchedule.cpus.size());
+    result.insert(result.end(), threadSchedule.cpus.begin(),
+                  threadSchedule.cpus.end());
+  }
+
+  size_t countAt = result.size();
+  result.push_back(0);
+  for (int thread = 0; thread < kScheduledThreadCount; thread++) {
+    const EffectiveThreadSchedule &effective = effectiveSchedules[thread];
+    if (effective.policy < 0) {
+      continue;
+    }
+    result.push_back(thread);
+    result.push_back(effective.policy);
+    result.push_back(effective.priority);
+    result.push_back(static_cast<int>(effective.cpus.size()));
+    result.insert(result.end(), effective.cpus.begin(), effective.cpus.end());
+    result[countAt]++;
+  }
+  return result;
+}
+
+void CameraInstance::followThreadSchedule(uint64_t &applied,
+                                          ScheduledThread thread) {
+  uint64_t generation = scheduleGeneration.load(std::memory_order_acquire);
+  if (generation == applied) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(scheduleMutex);
+  applyThreadSchedule(threadSchedule);
+  // Read back what the kernel granted rather than what was asked for.
+  effectiveSchedules[thread] = currentThreadSchedule();
+  applied = scheduleGeneration.load();
+}
+
+void CameraInstance::forgetThreadSchedule(ScheduledThread thread) {
+  std::lock_guard<std::mutex> lock(scheduleMutex);
+  effectiveSchedules[thread] = EffectiveThreadSchedule();
+}
@@ -0,0 +1,124 @@
+#include "device_cache.hpp"
+#include "native_log.hpp"
+#include <chrono>
+
+DeviceCache &DeviceCache::instance() {
+  static DeviceCache cache;
+  return cache;
+}
+
+size_t DeviceCache::refresh() {
+  // Serialize refreshes, but enumerate without holding the lookup lock so
+  // cached lookups keep answering during a slow discovery.
+  std::lock_guard<std::mutex> refreshLock(refreshMutex);
+
+  DeviceInfoList_t found;
+  try {
+    CTlFactory::GetInstance().EnumerateDevices(found);
+  } catch (const GenericException &e) {
+    BJNI_LOG_ERROR("DeviceCache::refresh",
+                   "Exception during enumeration: " << e.GetDescription());
+    return 0;
+  }
+
+  std::vector<CDeviceInfo> fresh(found.begin(), found.end());
+  std::unordered_map<std::string, size_t> serials;
+  std::unordered_map<std::string, size_t> userNames;
+  for (size_t i = 0; i < fresh.size(); i++) {
+    serials[std::string(fresh[i].GetSerialNumber())] = i;
+    if (fresh[i].IsUserDefinedNameAvailable()) {
+      userNames[std::string(fresh[i].GetUserDefinedName())] = i;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  devices.swap(fresh);
+  bySerial.swap(serials);
+  byUserName.swap(userNames);
+  populated = true;
+  return devices.size();
+}
+
+bool DeviceCache::ensurePopulated() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (populated) {
+      return false;
+    }
+  }
+  refresh();
+  return true;
+}
+
+bool DeviceCache::find(const std::string &serialOrName, CDeviceInfo &out) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = bySerial.find(serialOrName);
+  if (it == bySerial.end()) {
+    it = byUserName.find(serialOrName);
+    if (it == byUserName.end()) {
+      return false;
+    }
+  }
+  out = devices[it->second];
+  return true;
+}
+
+std::vector<CDeviceInfo> DeviceCache::snapshot() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return devices;
+}
+
+void DeviceCache::setWatcherInterval(int intervalMs) {
+  if (intervalMs <= 0) {
+    stopWatcher();
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(watcherMutex);
+  watcherIntervalMs = intervalMs;
+  // A running watcher picks up the new interval after its current wait.
+  if (!watcher.joinable()) {
+    watcherStop = false;
+    watcher = std::thread(&DeviceCache::watcherLoop, this);
+  }
+}
+
+bool DeviceCache::isWatching() {
+  std::lock_guard<std::mutex> lock(watcherMutex);
+  return watcher.joinable();
+}
+
+void DeviceCache::clear() {
+  stopWatcher();
+
+  std::lock_guard<std::mutex> lock(mutex);
+  devices.clear();
+  bySerial.clear();
+  byUserName.clear();
+  populated = false;
+}
+
+void DeviceCache::stopWatcher() {
+  std::thread old;
+  {
+    std::lock_guard<std::mutex> lock(watcherMutex);
+    watcherStop = true;
+    old.swap(watcher);
+  }
+  watcherCv.notify_all();
+  if (old.joinable()) {
+    old.join();
+  }
+}
+
+void DeviceCache::watcherLoop() {
+  std::unique_lock<std::mutex> lock(watcherMutex);
+  while (!watcherStop) {
+    lock.unlock();
+    refresh();
+    lock.lock();
+
+    watcherCv.wait_for(lock, std::chrono::milliseconds(watcherIntervalMs),
+                       [this] { return watcherStop; });
+  }
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+class CameraInstance;
+
+/**
+ * Splits each GigE link evenly across the cameras on it that opted in via
+ * CameraInstance::configureGigETransport, re-dividing whenever a camera
+ * joins, leaves or comes back on a different link. Cameras on different
+ * host interfaces never share.
+ *
+ * Every share is written with the balancer's mutex held, so a camera's
+ * share writes never overlap. Members must not hold their device lock when
+ * calling in.
+ */
+class BandwidthBalancer {
+  public:
+    static BandwidthBalancer& instance();
+
+    /**
+     * Add a camera, or move it to another link, and rebalance. link names
+     * the host interface the camera is reached through; cameras that cannot
+     * tell share the "" link. Joining again with the same link re-applies
+     * the camera's share, e.g. after a reconnect.
+     */
+    void join(CameraInstance* camera, const std::string& link);
+    void leave(CameraInstance* camera);
+
+  private:
+    BandwidthBalancer() = default;
+
+    struct Member {
+        CameraInstance* camera;
+        std::string link;
+    };
+
+    // Must hold mutex.
+    void rebalance(const std::string& link);
+
+    std::mutex mutex;
+    std::vector<Member> members;
+};
@@ -1,14 +1,215 @@
 #pragma once
 
+#include "camera_settings.hpp"
+#include "camera_stats.hpp"
+#include "change_detector.hpp"
+#include "exposure_controller.hpp"
+#include "exposure_fusion.hpp"
+#include "format_negotiation.hpp"
+#include "frame_history.hpp"
+#include "frame_mailbox.hpp"
+#include "frame_metadata.hpp"
+#include "luma_histogram.hpp"
+#include "tag_detector.hpp"
+#include "thread_scheduling.hpp"
+#include "threshold_stage.hpp"
+#include "undistort_stage.hpp"
 #include <opencv2/core.hpp>
 #include <pylon/PylonIncludes.h>
 #include <pylon/BaslerUniversalInstantCamera.h>
 #include <atomic>
 #include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <thread>
 
 using namespace Pylon;
 using namespace Basler_UniversalCameraParams;
 
+enum ConnectionState : int {
+    kConnected = 0,
+    kDisconnected = 1,
+    kReconnecting = 2,
+};
+
+/** Result of waiting for or polling a frame. Mirrored in BaslerJNI.FRAME_*. */
+enum FrameStatus : int {
+    kFrameNew = 0,
+    kFrameTimeout = 1,
+    kFrameNotGrabbing = 2,
+    kFrameGrabFailed = 3,
+    kFrameDisconnected = 4,
+};
+
+/**
+ * Layout of the array filled by CameraInstance::getCameraState. Part of the
+ * Java API (BaslerJNI.STATE_*), so only ever append before kStateCount.
+ */
+enum CameraStateField : int {
+    kStateExposure = 0,
+    kStateMinExposure,
+    kStateMaxExposure,
+    kStateGain,
+    kStateMinGain,
+    kStateMaxGain,
+    kStateFrameRate,
+    kStateAutoExposure,
+    kStateAutoWhiteBalance,
+    kStateWhiteBalanceRed,
+    kStateWhiteBalanceGreen,
+    kStateWhiteBalanceBlue,
+    kStateMinWhiteBalance,
+    kStateMaxWhiteBalance,
+    kStatePixelFormat,
+    kStateCount
+};
+
+/**
+ * setPixelFormat/getPixelFormat code for the camera's 8-bit Bayer format,
+ * demosaiced natively and delivered as BGR. Outside PhotonVision's
+ * PixelFormat range; mirrored in BaslerJNI.PIXEL_FORMAT_BAYER8.
+ */
+constexpr int kPixelFormatBayer8 = 100;
+
+/** State reported by CameraInstance::getAutoExposureState. */
+enum AutoExposureState : int {
+    kAutoExposureOff = 0,
+    kAutoExposureContinuous = 1,
+    // ExposureAuto_Once is still adjusting; reads Off once it has settled.
+    kAutoExposureConverging = 2,
+};
+
+/**
+ * Auto exposure/gain region and limits, see
+ * CameraInstance::configureAutoFunctions. Negative values keep the camera's
+ * current setting.
+ */
+struct AutoFunctionConfig {
+    // Region the auto functions meter on, width/height <= 0 for the full frame.
+    int roiX = 0;
+    int roiY = 0;
+    int roiWidth = 0;
+    int roiHeight = 0;
+    double exposureLowerUs = -1.0;
+    double exposureUpperUs = -1.0;
+    // Cap the exposure so it never pushes the frame period past the
+    // configured frame rate. Tracks later setFrameRate calls.
+    bool capExposureToFrameRate = true;
+    double gainLower = -1.0;
+    double gainUpper = -1.0;
+    // Target mean brightness, 0-1.
+    double targetBrightness = -1.0;
+    // 0 = minimize gain, 1 = minimize exposure time.
+    int profile = -1;
+    // Let GainAuto follow ExposureAuto instead of keeping gain fixed.
+    bool autoGain = false;
+};
+
+/** Host-side auto exposure, see CameraInstance::configureSoftwareAutoExposure. */
+struct SoftwareAutoExposureConfig {
+    // Compute the luma histogram of each frame (readable via getLumaHistogram).
+    bool histogram = false;
+    // Drive ExposureTime/Gain from the histogram. Implies histogram.
+    bool control = false;
+    // Metering region, width/height <= 0 for the full frame.
+    int roiX = 0;
+    int roiY = 0;
+    int roiWidth = 0;
+    int roiHeight = 0;
+    // Sample every Nth pixel of every Nth row.
+    int subsample = 4;
+    double targetLuma = 110.0;
+    double kp = 0.6;
+    double ki = 0.1;
+    double maxStepRatio = 1.5;
+    // Exposure ceiling, -1 for the longest exposure that keeps the frame rate.
+    double maxExposureUs = -1.0;
+    // Gain ceiling in dB, -1 for the camera's maximum.
+    double maxGain = -1.0;
+};
+
+/**
+ * Worker threads a CameraInstance owns, as reported by
+ * CameraInstance::getThreadScheduling. Mirrored in BaslerJNI.THREAD_*.
+ */
+enum ScheduledThread : int {
+    kThreadReconnect = 0,
+    kThreadAutoExposure = 1,
+    kThreadTagDetection = 2,
+    kThreadBracket = 3,
+    kScheduledThreadCount = 4,
+};
+
+/** How frames are being bracketed. Mirrored in BaslerJNI.BRACKET_*. */
+enum BracketMode : int {
+    kBracketOff = 0,
+    // The camera's sequencer cycles the exposures itself.
+    kBracketSequencer = 1,
+    // The host writes the next exposure as each frame arrives.
+    kBracketHost = 2,
+};
+
+/** Exposure bracketing, see CameraInstance::configureExposureBracketing. */
+struct BracketConfig {
+    // 2-4 exposure times in microseconds. Sorted ascending, so bracket 0 is
+    // always the shortest.
+    std::vector<double> exposuresUs;
+    // Use the camera's sequencer where it has one.
+    bool preferSequencer = true;
+    // Fuse each consecutive short/long pair. Needs exactly two brackets.
+    bool fuse = false;
+    // Long-exposure level where fusion starts blending in the short one.
+    int fusionKnee = 200;
+};
+
+/**
+ * Where each frame was on the host steady clock (ns), recorded in latency
+ * test mode. See CameraInstance::setLatencyTestMode.
+ */
+struct LatencyTrace {
+    uint64_t sequence = 0;
+    uint64_t blockId = 0;
+    // Camera timestamp mapped onto the host clock, -1 if it cannot be mapped.
+    int64_t captureNs = -1;
+    int64_t retrievedNs = 0;
+    int64_t convertedNs = 0;
+    int64_t publishedNs = 0;
+    // First takeFrame of this frame, 0 while untaken.
+    int64_t takenNs = 0;
+};
+
+/** GigE stream tuning, see CameraInstance::configureGigETransport. */
+struct GigETransportConfig {
+    // Packet size in bytes, 0 lets Pylon negotiate the largest size the
+    // path supports (jumbo frames where the NIC allows them).
+    int packetSize = 0;
+    // Inter-packet delay in timestamp ticks, -1 derives it from the
+    // camera's bandwidth share.
+    int interPacketDelay = -1;
+    // Split the link evenly with every other sharing camera on the same host interface.
+    bool shareBandwidth = true;
+    // Maximum resend requests per frame, 0 disables resends, -1 keeps Pylon's default.
+    int maxResendRequests = -1;
+    // Stream grabber socket buffer in KB, -1 keeps Pylon's default.
+    int socketBufferKb = -1;
+};
+
+/**
+ * USB3 stream grabber tuning, see CameraInstance::configureUsbTransport.
+ * Negative values keep Pylon's defaults.
+ */
+struct UsbTransportConfig {
+    int maxTransferSize = -1;
+    int numMaxQueuedUrbs = -1;
+    int maxBufferSize = -1;
+    int maxNumBuffer = -1;
+    // 0 = Off, 1 = On, -1 leaves DeviceLinkThroughputLimitMode alone.
+    int throughputLimitMode = -1;
+    // Bytes per second, only used when the limit mode is On.
+    int64_t throughputLimit = -1;
+};
+
 class CameraInstance {
   public:
     CameraInstance(IPylonDevice* device);
@@ -17,8 +218,127 @@ class CameraInstance {
     bool start();
     bool stop();
     
-    void awaitNewFrame();
+    /**
+     * Wait up to timeoutMs (negative waits forever) for the next frame and
+     * make it the current frame. Returns a FrameStatus. Concurrent callers
+     * take turns.
+     */
+    int awaitNewFrame(int timeoutMs);
+    /**
+     * Non-blocking variant of awaitNewFrame. Returns kFrameNew if the current
+     * frame is newer than lastSequence, kFrameTimeout if not. Never waits,
+     * so while another thread is retrieving it only checks the sequence.
+     */
+    int pollFrame(uint64_t lastSequence);
+    /** Sequence number of the current frame, 0 before the first frame. */
+    uint64_t getFrameSequence() const;
+    /** Pylon error code of the last failed grab, -1 for a non-Pylon failure. */
+    int64_t getLastGrabError() const;
     std::shared_ptr<cv::Mat> takeFrame();
+    /** The current frame together with its metadata, read atomically. */
+    std::shared_ptr<cv::Mat> takeFrameWithMetadata(FrameMetadata& metadata);
+    /**
+     * Metadata of the current frame or of one still in the history ring.
+     * Returns false if the sequence is neither.
+     */
+    bool getFrameMetadata(uint64_t sequence, FrameMetadata& metadata);
+    /**
+     * Turn on chunk mode with timestamp, exposure, gain, line status and
+     * frame counter chunks so every frame carries its exact settings.
+     * Restarts acquisition once if grabbing.
+     */
+    bool setChunkMetadata(bool enable);
+
+    /**
+     * Undistort every frame natively before it is published, using
+     * calibration taken at the camera's current calibWidth x calibHeight.
+     * An empty cameraMatrix turns undistortion off.
+     */
+    bool setUndistortion(const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs, int calibWidth,
+                         int calibHeight);
+
+    /**
+     * Produce an HSV threshold mask alongside every frame, fused into the
+     * conversion pass. nullptr turns it off.
+     */
+    bool setThreshold(const ThresholdConfig* config);
+    /** Mask of the current frame, null if thresholding is off. */
+    std::shared_ptr<cv::Mat> takeMask();
+
+    /**
+     * Score every frame by how much it differs from the last published one
+     * (FrameMetadata::changeScore) and optionally drop frames that barely
+     * changed before they are converted. nullptr turns it off.
+     */
+    bool configureChangeDetection(const ChangeDetectorConfig* config);
+
+    /**
+     * Cycle frames through several exposure times and tag each frame with
+     * its bracket index (FrameMetadata::bracketIndex). Uses the camera's
+     * sequencer if it has one, otherwise alternates ExposureTime from the
+     * host, with the writes made off the grab thread. Turns chunk metadata
+     * on, since frames are tagged from their chunks, and ExposureAuto off.
+     * nullptr turns bracketing off and restores the exposure, ExposureAuto
+     * and chunk state from before it was first enabled. Returns a
+     * BracketMode, -1 on failure.
+     */
+    int configureExposureBracketing(const BracketConfig* config);
+    /** Latest fusion of a short/long pair, null if fusion is off or no pair yet. */
+    std::shared_ptr<cv::Mat> takeFusedFrame();
+
+    /**
+     * Latency test mode: switch to Mono8 and the camera's test image (where
+     * it has one), stamp each frame's block ID, sequence and retrieve time
+     * into its first kLatencyStampBytes pixels, and record a LatencyTrace
+     * per frame. Meant for the emulator and bench tests, not production.
+     * Mono8 is recorded in the settings so reconnects keep it; disabling
+     * restores the previous pixel format, test image and recorded format.
+     */
+    bool setLatencyTestMode(bool enable);
+    /** Trace of a recent frame, false if it is no longer held. */
+    bool getLatencyTrace(uint64_t sequence, LatencyTrace& trace);
+    static constexpr int kLatencyStampBytes = 24;
+
+    /**
+     * Run AprilTag detection on every frame on a per-camera worker thread.
+     * The grab thread only hands the frame over; if the worker is still busy
+     * the older pending frame is replaced. nullptr turns detection off.
+     */
+    bool configureTagDetection(const TagDetectorConfig* config);
+    /** Detections of the most recently processed frame, false if none yet. */
+    bool getTagDetections(TagDetectionResult& result);
+
+    /**
+     * Copy rectangles of the current frame, packed back to back, into out.
+     * rects holds {x, y, width, height} per region; each is clipped to the
+     * frame. layout receives {offset, stride, width, height, channels} per
+     * region (kRegionLayoutInts each). Returns the bytes used, the negated
+     * required size if out is too small (nothing is copied), 0 if there is
+     * no frame yet, or kRegionError if the packed size does not fit the int
+     * layout offsets.
+     */
+    int64_t copyFrameRegions(const int* rects, int count, uint8_t* out, size_t capacity,
+                             int* layout);
+    static constexpr int kRegionRectInts = 4;
+    static constexpr int kRegionLayoutInts = 5;
+    // Never a valid negated size, unlike -1 which means "needs 1 byte".
+    static constexpr int64_t kRegionError = INT64_MIN;
+
+    /**
+     * Keep the last `frames` frames in a preallocated ring, 0 disables it.
+     * Raw frames are stored in the camera's pixel format (smaller, converted
+     * on read); otherwise the converted BGR/mono frame is stored.
+     */
+    bool setFrameHistory(int frames, bool raw);
+    /** Copy out a frame (and optionally its metadata) from the ring by sequence number. */
+    bool takeFrameAt(uint64_t sequence, cv::Mat& out, FrameMetadata* metadata = nullptr);
+    /** {oldest, newest} sequence held in the ring, {0, 0} if empty or off. */
+    std::array<uint64_t, 2> getFrameHistoryRange() const;
+    /**
+     * Write the newest `count` frames in the ring (all if count <= 0) to
+     * directory as <serial>_<sequence>.png. Returns the number written.
+     */
+    int dumpRecentFrames(const std::string& directory, int count);
 
     double getExposure() const;
     bool getAutoExposure() const;
@@ -35,6 +355,12 @@ class CameraInstance {
     double getMaxWhiteBalance() const;
     double getMinGain() const;
     double getMaxGain() const;
+
+    /**
+     * Read every value and range above in a single pass, laid out by
+     * CameraStateField. Entries the camera cannot report are -1.
+     */
+    std::array<double, kStateCount> getCameraState();
   
     bool setExposure(double exposure);
     bool setAutoExposure(bool enable);
@@ -46,13 +372,357 @@ class CameraInstance {
     bool setBrightness(double brightness);
     bool setPixelBinning(int binMode, int horzBin, int vertBin);
 
+    /**
+     * Pick the pixel format with the highest sustainable frame rate for an
+     * OutputIntent, weighing the formats the camera offers, the link
+     * bandwidth and the conversion cost measured on this host. Applies the
+     * choice (restarting acquisition once) if apply is set. Returns the
+     * setPixelFormat code, or -1; reasoning explains the choice either way.
+     */
+    int negotiatePixelFormat(int intent, bool apply, std::string& reasoning);
+
+    /**
+     * Set CPU affinity and SCHED_FIFO priority for the native worker threads
+     * this camera owns (auto exposure, tag detection, bracketing,
+     * reconnect), plus Pylon's grab engine and grab loop thread priorities
+     * (-1 leaves Pylon's default). Threads calling in from Java are never touched. Restarts
+     * acquisition if grabbing so the grab engine picks up its new priority.
+     * Nothing changes if the Pylon priorities cannot be written. The
+     * reconnect thread applies the schedule right away; the other workers
+     * on their next wakeup, or when they start.
+     */
+    bool setThreadScheduling(const ThreadSchedule& schedule, int grabEnginePriority, int grabLoopPriority);
+    /**
+     * Requested and effective settings as [grabEnginePriority,
+     * grabLoopPriority, fifoPriority, cpuCount, cpus..., threadCount,
+     * threads...], each thread being [ScheduledThread, policy, priority,
+     * cpuCount, cpus...] as read back by that thread. fifoPriority is -1
+     * while no schedule was requested; only threads running under the latest
+     * schedule are listed.
+     */
+    std::vector<int> getThreadScheduling();
+
+    /**
+     * Save the camera configuration. A full profile is Pylon's .pfs dump of
+     * the whole node map; otherwise only the settings written through this
+     * class are saved in a compact binary form.
+     */
+    bool saveProfile(const std::string& path, bool fullNodeMap);
+    /**
+     * Load a profile written by saveProfile (either format), restarting
+     * acquisition at most once.
+     */
+    bool loadProfile(const std::string& path);
+    /** Store the current configuration in on-camera user set 1-3. */
+    bool saveUserSet(int userSet, bool makeDefault);
+    /** Load on-camera user set 1-3, or 0 for the factory default set. */
+    bool loadUserSet(int userSet);
+
+    /** Settings written through this class since the camera was opened. */
+    CameraSettings getSettings();
+    /** Apply recorded settings in dependency order with one acquisition restart. */
+    bool applySettings(const CameraSettings& settings);
+
+    /**
+     * Set the auto-function metering region, exposure/gain limits, target
+     * brightness and profile. Applies to both continuous and once modes and
+     * is reapplied after a reconnect.
+     */
+    bool configureAutoFunctions(const AutoFunctionConfig& config);
+    /**
+     * Run ExposureAuto (and GainAuto if configured) once until it settles.
+     * The recorded exposure (and gain) are dropped until then, so a restore
+     * never brings back the pre-convergence values.
+     */
+    bool triggerAutoExposureOnce();
+    /**
+     * One of AutoExposureState, -1 if ExposureAuto cannot be read. The first
+     * call to see a once run finished records the settled exposure and gain.
+     */
+    int getAutoExposureState();
+
+    /**
+     * Enable the host-side luma histogram and, optionally, the PI exposure
+     * controller fed by it. The histogram is computed on the grab thread;
+     * controller steps and the resulting camera writes run on a separate
+     * thread so they never delay a frame. Enabling control turns the
+     * camera's own ExposureAuto/GainAuto off.
+     */
+    bool configureSoftwareAutoExposure(const SoftwareAutoExposureConfig& config);
+    /** Histogram of the most recent frame, empty if histograms are off. */
+    LumaHistogram getLumaHistogram();
+
+    /**
+     * Tune the GigE stream (packet size, inter-packet delay, resends, socket
+     * buffer) and optionally join the shared bandwidth split. Returns false
+     * for non-GigE cameras. Reapplied automatically after a reconnect.
+     */
+    bool configureGigETransport(const GigETransportConfig& config);
+    /**
+     * Limit the camera to a fraction of its link, 0 removes the limit.
+     * Called by BandwidthBalancer, which serializes it.
+     */
+    void applyBandwidthShare(double share);
+
+    /**
+     * Set USB3 stream grabber parameters. They are applied on every start(),
+     * so calling this while grabbing restarts acquisition once. Returns false
+     * for non-USB cameras.
+     */
+    bool configureUsbTransport(const UsbTransportConfig& config);
+
+    /** One of ConnectionState. */
+    int getConnectionState() const;
+
+    /** Snapshot of the counters documented in camera_stats.hpp. */
+    std::array<double, kStatCount> getStats() const;
+    /** Record how long creating and opening the device took. */
+    void setOpenTime(double ms);
+
   private:
-    std::unique_ptr<Pylon::CBaslerUniversalInstantCamera> camera;
-    std::mutex frameMutex;
+    // Forwards Pylon's device removal callback to onDeviceRemoved().
+    class RemovalHandler : public CConfigurationEventHandler {
+      public:
+        explicit RemovalHandler(CameraInstance& owner) : owner(owner) {}
+        void OnCameraDeviceRemoved(CInstantCamera& camera) override;
+
+      private:
+        CameraInstance& owner;
+    };
 
+    // Every node access holds camera->GetLock(), which tryReconnect also
+    // holds while it swaps the device. It is recursive, but must not be held
+    // while joining a worker thread or calling into BandwidthBalancer.
+    std::unique_ptr<Pylon::CBaslerUniversalInstantCamera> camera;
+    std::string serial;
+    FrameMailbox mailbox;
+    // Held around retrieveFrame, so however many Java threads wait or poll,
+    // one frame is retrieved at a time. Everything marked "grab path only"
+    // is guarded by it.
+    std::mutex grabMutex;
+    // Grab path only.
     CGrabResultPtr currentGrabResult;
-    std::shared_ptr<cv::Mat> currentFramePtr;
+    std::atomic<int64_t> lastGrabError{0};
+
+    // Retrieves, converts and publishes at most one frame. Must hold
+    // grabMutex.
+    int retrieveFrame(unsigned int timeoutMs);
+    void recordHistory(const CGrabResultPtr& grabResult, const cv::Mat& converted,
+                       const FrameMetadata& metadata);
+    FrameMetadata parseMetadata(const CBaslerUniversalGrabResultPtr& grabResult,
+                                uint64_t sequence);
+    // Fills metadata.changeScore; false if the frame should be suppressed.
+    bool scoreChange(const CGrabResultPtr& grabResult, FrameMetadata& metadata);
+
+    std::atomic<bool> chunksEnabled{false};
+
+    // Swapped with std::atomic_load/store so the grab path never takes a lock.
+    std::shared_ptr<FrameHistory> history;
+    std::atomic<bool> historyRaw{false};
+
+    CameraStats stats;
+
+    std::mutex settingsMutex;
+    CameraSettings settings;
+    AutoFunctionConfig autoConfig;
+    bool autoConfigured = false;
+    // A once run whose settled values are not recorded yet.
+    std::atomic<bool> autoOncePending{false};
+
+    // Applies autoConfig, including the frame-rate exposure cap.
+    bool applyAutoFunctions();
+    // Longest exposure that still sustains the configured frame rate, -1 if
+    // the frame rate is not fixed.
+    double frameRateExposureCapUs() const;
+
+    template <typename Fn>
+    void recordSettings(Fn&& update);
+    // Stops acquisition around fn if the camera is grabbing.
+    template <typename Fn>
+    bool withAcquisitionStopped(Fn&& fn);
+    // Re-reads recorded settings from the device after a bulk load.
+    void captureSettings();
+
+    // Called on a Pylon thread; must not touch the device.
+    void onDeviceRemoved();
+    // Background thread that re-creates the device by serial after removal
+    // and restores settings and grabbing under the same handle.
+    void reconnectLoop();
+    bool tryReconnect();
+
+    // Usable link bandwidth in bytes/s, after any bandwidth share; 0 if the
+    // transport does not report it.
+    double linkBytesPerSecond();
+
+    // Host interface the device is reached through, the BandwidthBalancer
+    // grouping key; "" if the transport does not say.
+    std::string linkInterface();
+
+    // Applies the stream grabber part of gigeConfig. Must not be grabbing.
+    bool applyGigETransport();
+
+    // Applies usbConfig. Must not be grabbing.
+    bool applyUsbTransport();
+
+    void publishHistogram(const cv::Mat& frame, uint64_t sequence);
+    void softwareAutoExposureLoop();
+    void stopSoftwareAutoExposure();
+
+    // Held only for short copies; the grab thread skips publishing rather
+    // than wait on it.
+    std::mutex aeMutex;
+    std::condition_variable aeCv;
+    SoftwareAutoExposureConfig aeConfig;
+    LumaHistogram latestHistogram;
+    uint64_t histogramSequence = 0;
+    bool aeStopping = false;
+    std::atomic<bool> histogramEnabled{false};
+    std::thread aeThread;
+
+    std::mutex transportMutex;
+    UsbTransportConfig usbConfig;
+    bool usbConfigured = false;
+    // Block ID of the previous frame, grab path only.
+    uint64_t lastBlockId = 0;
+    GigETransportConfig gigeConfig;
+    bool gigeConfigured = false;
+    double bandwidthShare = 0.0;
+    std::atomic<bool> inBandwidthBalancer{false};
+
+    RemovalHandler removalHandler{*this};
+    std::atomic<int> connectionState{kConnected};
+    // Whether the user wants frames; survives a disconnect.
+    std::atomic<bool> wantGrabbing{false};
+    std::atomic<int64_t> removedAtNs{0};
+
+    std::mutex reconnectMutex;
+    std::condition_variable reconnectCv;
+    bool shuttingDown = false;
+    std::thread reconnectThread;
+
+    // Also produces the threshold mask when a ThresholdStage is set.
+    std::shared_ptr<cv::Mat> convertToMat(const CGrabResultPtr& grabResult,
+                                          std::shared_ptr<cv::Mat>& mask);
+
+    std::shared_ptr<ThresholdStage> thresholdStage;
+
+    void submitTagFrame(const std::shared_ptr<cv::Mat>& frame, const FrameMetadata& metadata);
+    void tagDetectionLoop();
+    void stopTagDetection();
+
+    // Same hand-off rules as aeMutex: the grab thread only ever try_locks.
+    std::mutex tagMutex;
+    std::condition_variable tagCv;
+    TagDetectorConfig tagConfig;
+    // Bumped on every configure so the worker rebuilds its detector.
+    uint64_t tagConfigGeneration = 0;
+    std::shared_ptr<cv::Mat> tagPendingFrame;
+    FrameMetadata tagPendingMetadata;
+    int64_t tagPendingSinceNs = 0;
+    TagDetectionResult tagResult;
+    bool tagStopping = false;
+    std::atomic<bool> tagEnabled{false};
+    std::thread tagThread;
+
+    // Swapped whole on reconfigure; the detector itself is grab path only.
+    std::shared_ptr<ChangeDetector> changeDetector;
+
+    struct BracketPlan {
+        std::vector<double> exposuresUs;
+        bool sequencer = false;
+        std::unique_ptr<ExposureFusion> fusion;
+    };
+
+    // Programs one sequencer set per exposure, cycling through them on
+    // every frame. Must not be grabbing.
+    bool applySequencer(const std::vector<double>& exposuresUs);
+    // configureExposureBracketing minus the writer thread. Must hold the
+    // device lock.
+    int applyExposureBracketing(const BracketConfig* config);
+    // Record and put back the exposure state bracketing overrides. Must hold
+    // the device lock.
+    bool saveBracketState();
+    void restoreBracketState();
+    void tagBracket(const CBaslerUniversalGrabResultPtr& grabResult, FrameMetadata& metadata);
+    // Writes the host-mode exposures tagBracket asks for.
+    void bracketWriterLoop();
+    void stopBracketWriter();
+    // Fuses frame with the previous frame if they form a pair.
+    std::shared_ptr<cv::Mat> fuseBracket(const std::shared_ptr<cv::Mat>& frame,
+                                         const FrameMetadata& metadata);
+
+    // Swapped with std::atomic_load/store; the rest is grab path only.
+    std::shared_ptr<const BracketPlan> bracketPlan;
+    std::shared_ptr<const BracketPlan> bracketPlanSeen;
+    int bracketRequested = 0;
+    std::shared_ptr<cv::Mat> bracketPrevFrame;
+    FrameMetadata bracketPrevMetadata;
+    std::mutex fusedMutex;
+    std::shared_ptr<cv::Mat> currentFusedPtr;
+
+    // Same hand-off rules as aeMutex: the grab thread only ever try_locks.
+    std::mutex bracketMutex;
+    std::condition_variable bracketCv;
+    // Next exposure to write, 0 if none, and the plan that asked for it.
+    double bracketPendingUs = 0;
+    std::shared_ptr<const BracketPlan> bracketPendingPlan;
+    bool bracketStopping = false;
+    std::thread bracketThread;
+
+    struct BracketRestore {
+        double exposureUs = 0;
+        bool hasExposureAuto = false;
+        ExposureAutoEnums exposureAuto = ExposureAuto_Off;
+        bool chunks = false;
+    };
+    // Camera state from before bracketing; under the device lock.
+    BracketRestore bracketRestore;
+    bool bracketRestorePending = false;
+
+    // Maps a camera timestamp onto the host clock, -1 if not latched.
+    int64_t cameraToHostNs(uint64_t ticks);
+    LatencyTrace& latencySlot(uint64_t sequence);
+
+    static constexpr size_t kLatencyTraceFrames = 256;
+    std::atomic<bool> latencyMode{false};
+    std::mutex latencyMutex;
+    std::array<LatencyTrace, kLatencyTraceFrames> latencyTraces{};
+    // Host time of camera tick 0 and ns per tick, from a timestamp latch.
+    int64_t latencyClockOffsetNs = 0;
+    double latencyTickNs = 0.0;
+
+    struct LatencyRestore {
+        PixelFormatEnums pixelFormat = PixelFormat_Mono8;
+        bool hasTestImage = false;
+        TestImageSelectorEnums testImage = TestImageSelector_Off;
+        // The recorded settings' pixel format, for reconnects and profiles.
+        int settingsPixelFormat = 0;
+        bool settingsHadPixelFormat = false;
+    };
+    // What latency test mode replaced; under the device lock.
+    LatencyRestore latencyRestore;
+
+    std::shared_ptr<UndistortStage> undistort;
+    // YUV frames are converted here before undistortion; grab path only.
+    cv::Mat undistortScratch;
+    // Tracked here so the grab path never reads binning from the device.
+    std::atomic<int> binningH{1};
+    std::atomic<int> binningV{1};
+
+    // Applies threadSchedule to the calling worker thread if it has not
+    // seen the latest configuration yet; applied is the thread's own
+    // generation, 0 initially. Only for threads this instance owns, never a
+    // caller's thread.
+    void followThreadSchedule(uint64_t& applied, ScheduledThread thread);
+    // Drops a stopping worker from the reported schedule.
+    void forgetThreadSchedule(ScheduledThread thread);
 
-    std::shared_ptr<cv::Mat> convertToMat(const CGrabResultPtr& grabResult);
+    std::mutex scheduleMutex;
+    ThreadSchedule threadSchedule;
+    bool scheduleConfigured = false;
+    // As read back by each worker; policy is -1 until it has applied the
+    // latest schedule.
+    std::array<EffectiveThreadSchedule, kScheduledThreadCount> effectiveSchedules{};
+    std::atomic<uint64_t> scheduleGeneration{0};
     
 };
\ No newline at end of file
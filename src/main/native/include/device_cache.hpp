@@ -0,0 +1,68 @@
+#pragma once
+
+#include <pylon/PylonIncludes.h>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace Pylon;
+
+/**
+ * Process-wide cache of enumerated Pylon devices.
+ *
+ * CTlFactory::EnumerateDevices is a broadcast discovery on GigE and can take
+ * hundreds of milliseconds, so lookups by serial (or user-defined name) are
+ * served from the last enumeration instead. The cache is refreshed
+ * explicitly or by an optional background watcher.
+ *
+ * Pylon must be initialized before refreshing.
+ */
+class DeviceCache {
+  public:
+    static DeviceCache& instance();
+
+    /** Enumerate devices once and replace the cache. Returns the device count. */
+    size_t refresh();
+
+    /** Refresh only if nothing has been enumerated yet. Returns true if it did. */
+    bool ensurePopulated();
+
+    /** Look up a device by serial number or user-defined name. */
+    bool find(const std::string& serialOrName, CDeviceInfo& out);
+
+    /** Copy of all cached devices in enumeration order. */
+    std::vector<CDeviceInfo> snapshot();
+
+    /**
+     * Start (or retune) the background watcher refreshing every intervalMs.
+     * An interval of 0 or less stops it.
+     */
+    void setWatcherInterval(int intervalMs);
+    bool isWatching();
+
+    /** Stop the watcher and drop all cached devices. */
+    void clear();
+
+  private:
+    DeviceCache() = default;
+
+    void watcherLoop();
+    void stopWatcher();
+
+    std::mutex refreshMutex;
+
+    std::mutex mutex;
+    std::vector<CDeviceInfo> devices;
+    std::unordered_map<std::string, size_t> bySerial;
+    std::unordered_map<std::string, size_t> byUserName;
+    bool populated = false;
+
+    std::mutex watcherMutex;
+    std::condition_variable watcherCv;
+    std::thread watcher;
+    int watcherIntervalMs = 0;
+    bool watcherStop = false;
+};
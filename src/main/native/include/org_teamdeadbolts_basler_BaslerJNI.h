@@ -250,9 +250,33 @@ JNIEXPORT jlong JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_takeFrame
 /*
  * Class:     org_teamdeadbolts_basler_BaslerJNI
  * Method:    awaitNewFrame
- * Signature: (J)V
+ * Signature: (JI)I
+ */
+JNIEXPORT jint JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_awaitNewFrame
+  (JNIEnv *, jclass, jlong, jint);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    pollFrame
+ * Signature: (JJ)I
+ */
+JNIEXPORT jint JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_pollFrame
+  (JNIEnv *, jclass, jlong, jlong);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    getFrameSequence
+ * Signature: (J)J
+ */
+JNIEXPORT jlong JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_getFrameSequence
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    getLastGrabError
+ * Signature: (J)J
  */
-JNIEXPORT void JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_awaitNewFrame
+JNIEXPORT jlong JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_getLastGrabError
   (JNIEnv *, jclass, jlong);
 
 /*
@@ -271,6 +295,358 @@ JNIEXPORT jint JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_getPixelFormat
 JNIEXPORT void JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_cleanUp
   (JNIEnv *, jclass);
 
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    configureConversionPool
+ * Signature: (I[II)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_configureConversionPool
+  (JNIEnv *, jclass, jint, jintArray, jint);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    setThreadScheduling
+ * Signature: (J[IIII)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_setThreadScheduling
+  (JNIEnv *, jclass, jlong, jintArray, jint, jint, jint);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    getThreadSchedulingRaw
+ * Signature: (J)[I
+ */
+JNIEXPORT jintArray JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_getThreadSchedulingRaw
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    getDeviceInfosRaw
+ * Signature: ()[Ljava/lang/String;
+ */
+JNIEXPORT jobjectArray JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_getDeviceInfosRaw
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    refreshDevices
+ * Signature: ()I
+ */
+JNIEXPORT jint JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_refreshDevices
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    setDeviceWatcher
+ * Signature: (I)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_setDeviceWatcher
+  (JNIEnv *, jclass, jint);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    createCameras
+ * Signature: ([Ljava/lang/String;)[J
+ */
+JNIEXPORT jlongArray JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_createCameras
+  (JNIEnv *, jclass, jobjectArray);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    getCameraStats
+ * Signature: (J)[D
+ */
+JNIEXPORT jdoubleArray JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_getCameraStats
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    saveProfile
+ * Signature: (JLjava/lang/String;Z)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_saveProfile
+  (JNIEnv *, jclass, jlong, jstring, jboolean);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    loadProfile
+ * Signature: (JLjava/lang/String;)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_loadProfile
+  (JNIEnv *, jclass, jlong, jstring);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    saveUserSet
+ * Signature: (JIZ)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_saveUserSet
+  (JNIEnv *, jclass, jlong, jint, jboolean);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    loadUserSet
+ * Signature: (JI)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_loadUserSet
+  (JNIEnv *, jclass, jlong, jint);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    getConnectionState
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_getConnectionState
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    configureGigETransport
+ * Signature: (JIIZII)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_configureGigETransport
+  (JNIEnv *, jclass, jlong, jint, jint, jboolean, jint, jint);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    configureUsbTransport
+ * Signature: (JIIIIIJ)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_configureUsbTransport
+  (JNIEnv *, jclass, jlong, jint, jint, jint, jint, jint, jlong);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    getCameraState
+ * Signature: (J[D)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_getCameraState
+  (JNIEnv *, jclass, jlong, jdoubleArray);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    setFrameHistory
+ * Signature: (JIZ)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_setFrameHistory
+  (JNIEnv *, jclass, jlong, jint, jboolean);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    takeFrameAt
+ * Signature: (JJ)J
+ */
+JNIEXPORT jlong JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_takeFrameAt
+  (JNIEnv *, jclass, jlong, jlong);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    getFrameHistoryRange
+ * Signature: (J)[J
+ */
+JNIEXPORT jlongArray JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_getFrameHistoryRange
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    dumpRecentFrames
+ * Signature: (JLjava/lang/String;I)I
+ */
+JNIEXPORT jint JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_dumpRecentFrames
+  (JNIEnv *, jclass, jlong, jstring, jint);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    takeFrameRegions
+ * Signature: (J[ILjava/nio/ByteBuffer;[I)J
+ */
+JNIEXPORT jlong JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_takeFrameRegions
+  (JNIEnv *, jclass, jlong, jintArray, jobject, jintArray);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    configureAutoFunctions
+ * Signature: (J[I[DZIZ)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_configureAutoFunctions
+  (JNIEnv *, jclass, jlong, jintArray, jdoubleArray, jboolean, jint, jboolean);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    triggerAutoExposureOnce
+ * Signature: (J)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_triggerAutoExposureOnce
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    getAutoExposureState
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_getAutoExposureState
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    configureSoftwareAutoExposure
+ * Signature: (JI[I[DI)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_configureSoftwareAutoExposure
+  (JNIEnv *, jclass, jlong, jint, jintArray, jdoubleArray, jint);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    getLumaHistogram
+ * Signature: (J)[I
+ */
+JNIEXPORT jintArray JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_getLumaHistogram
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    setChunkMetadata
+ * Signature: (JZ)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_setChunkMetadata
+  (JNIEnv *, jclass, jlong, jboolean);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    takeFrameWithMetadata
+ * Signature: (J[J[D)J
+ */
+JNIEXPORT jlong JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_takeFrameWithMetadata
+  (JNIEnv *, jclass, jlong, jlongArray, jdoubleArray);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    getFrameMetadataRaw
+ * Signature: (JJ[J[D)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_getFrameMetadataRaw
+  (JNIEnv *, jclass, jlong, jlong, jlongArray, jdoubleArray);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    setUndistortion
+ * Signature: (J[D[DII)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_setUndistortion
+  (JNIEnv *, jclass, jlong, jdoubleArray, jdoubleArray, jint, jint);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    setThreshold
+ * Signature: (J[I)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_setThreshold
+  (JNIEnv *, jclass, jlong, jintArray);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    takeMask
+ * Signature: (J)J
+ */
+JNIEXPORT jlong JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_takeMask
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    takeMaskInto
+ * Signature: (JLjava/nio/ByteBuffer;)J
+ */
+JNIEXPORT jlong JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_takeMaskInto
+  (JNIEnv *, jclass, jlong, jobject);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    configureTagDetection
+ * Signature: (JIID)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_configureTagDetection
+  (JNIEnv *, jclass, jlong, jint, jint, jdouble);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    getTagDetectionsRaw
+ * Signature: (J[J[D)I
+ */
+JNIEXPORT jint JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_getTagDetectionsRaw
+  (JNIEnv *, jclass, jlong, jlongArray, jdoubleArray);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    configureChangeDetection
+ * Signature: (JIDI)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_configureChangeDetection
+  (JNIEnv *, jclass, jlong, jint, jdouble, jint);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    configureExposureBracketing
+ * Signature: (J[DZZI)I
+ */
+JNIEXPORT jint JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_configureExposureBracketing
+  (JNIEnv *, jclass, jlong, jdoubleArray, jboolean, jboolean, jint);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    takeFusedFrame
+ * Signature: (J)J
+ */
+JNIEXPORT jlong JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_takeFusedFrame
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    setLatencyTestMode
+ * Signature: (JZ)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_setLatencyTestMode
+  (JNIEnv *, jclass, jlong, jboolean);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    getLatencyTrace
+ * Signature: (JJ[J)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_getLatencyTrace
+  (JNIEnv *, jclass, jlong, jlong, jlongArray);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    negotiatePixelFormatRaw
+ * Signature: (JIZ[Ljava/lang/String;)I
+ */
+JNIEXPORT jint JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_negotiatePixelFormatRaw
+  (JNIEnv *, jclass, jlong, jint, jboolean, jobjectArray);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    configureNativeLog
+ * Signature: (II)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_configureNativeLog
+  (JNIEnv *, jclass, jint, jint);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    setNativeLogForwarding
+ * Signature: (Z)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_setNativeLogForwarding
+  (JNIEnv *, jclass, jboolean);
+
+/*
+ * Class:     org_teamdeadbolts_basler_BaslerJNI
+ * Method:    flushNativeLog
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_org_teamdeadbolts_basler_BaslerJNI_flushNativeLog
+  (JNIEnv *, jclass);
+
 /*
  * Class:     org_teamdeadbolts_basler_BaslerJNI
  * Method:    camDebugPrint
@@ -5,6 +5,9 @@ import static org.junit.jupiter.api.Assertions.*;
 import static org.junit.jupiter.api.Assumptions.*;
 
 import edu.wpi.first.util.PixelFormat;
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.List;
 import org.junit.jupiter.api.*;
 import org.junit.jupiter.api.condition.EnabledIf;
 import org.opencv.core.Core;
@@ -561,6 +564,830 @@ public class BaslerJNITest {
         }
     }
 
+    @Test
+    @DisplayName("Should convert frames with any conversion pool size")
+    void testConversionPool() {
+        assumeTrue(libraryLoaded, "Native library not available");
+
+        assertFalse(
+                BaslerJNI.configureConversionPool(-1, null, 64), "Should reject negative threads");
+        assertTrue(BaslerJNI.configureConversionPool(0, null, 64), "Should allow inline conversion");
+
+        assumeTrue(hasCameras, "No cameras connected");
+
+        String serial = connectedCameras[0];
+        long handle = BaslerJNI.createCamera(serial);
+        assumeTrue(handle != 0, "Failed to create camera");
+
+        try {
+            assertTrue(BaslerJNI.startCamera(handle), "Should start camera");
+
+            BaslerJNI.awaitNewFrame(handle);
+            Mat inline = new Mat(BaslerJNI.takeFrame(handle));
+
+            assertTrue(
+                    BaslerJNI.configureConversionPool(3, new int[] {}, 16),
+                    "Should resize conversion pool");
+            BaslerJNI.awaitNewFrame(handle);
+            Mat striped = new Mat(BaslerJNI.takeFrame(handle));
+
+            assertEquals(inline.size(), striped.size(), "Striped frame should match size");
+            assertEquals(inline.type(), striped.type(), "Striped frame should match type");
+
+            inline.release();
+            striped.release();
+        } finally {
+            BaslerJNI.destroyCamera(handle);
+        }
+    }
+
+    @Test
+    @DisplayName("Should apply and report thread scheduling")
+    void testThreadScheduling() throws InterruptedException {
+        assumeTrue(libraryLoaded, "Native library not available");
+        assumeTrue(hasCameras, "No cameras connected");
+
+        String serial = connectedCameras[0];
+        long handle = BaslerJNI.createCamera(serial);
+        assumeTrue(handle != 0, "Failed to create camera");
+
+        try {
+            assertFalse(
+                    BaslerJNI.setThreadScheduling(handle, null, 100, -1, -1),
+                    "Should reject an out-of-range SCHED_FIFO priority");
+            assertTrue(
+                    BaslerJNI.setThreadScheduling(handle, new int[] {0}, 0, -1, -1),
+                    "Should accept thread scheduling");
+
+            BaslerJNI.ThreadScheduling scheduling = BaslerJNI.getThreadScheduling(handle);
+            assertNotNull(scheduling, "Should report thread scheduling");
+            assertEquals(0, scheduling.fifoPriority(), "Should report the requested priority");
+            assertArrayEquals(new int[] {0}, scheduling.cpus(), "Should report the requested CPUs");
+            assertEquals(-1, scheduling.grabEnginePriority(), "Should keep Pylon's default");
+
+            // The reconnect thread exists without any other feature enabled.
+            BaslerJNI.EffectiveThreadSchedule reconnect =
+                    awaitThreadSchedule(handle, BaslerJNI.THREAD_RECONNECT);
+            assertNotNull(reconnect, "Reconnect thread should apply the schedule");
+            assertArrayEquals(new int[] {0}, reconnect.cpus(), "Should be pinned to CPU 0");
+
+            // Workers started later apply it on startup.
+            assertTrue(
+                    BaslerJNI.configureSoftwareAutoExposure(
+                            handle, BaslerJNI.SOFTWARE_AE_CONTROL, null, null, 4));
+            BaslerJNI.EffectiveThreadSchedule autoExposure =
+                    awaitThreadSchedule(handle, BaslerJNI.THREAD_AUTO_EXPOSURE);
+            assertNotNull(autoExposure, "Auto exposure thread should apply the schedule");
+            assertArrayEquals(new int[] {0}, autoExposure.cpus(), "Should be pinned to CPU 0");
+        } finally {
+            BaslerJNI.destroyCamera(handle);
+        }
+    }
+
+    private static BaslerJNI.EffectiveThreadSchedule awaitThreadSchedule(long handle, int thread)
+            throws InterruptedException {
+        for (int i = 0; i < 100; i++) {
+            for (BaslerJNI.EffectiveThreadSchedule effective :
+                    BaslerJNI.getThreadScheduling(handle).threads()) {
+                if (effective.thread() == thread) return effective;
+            }
+            Thread.sleep(10);
+        }
+        return null;
+    }
+
+    @Test
+    @DisplayName("Should serve device info from the native cache")
+    void testDeviceCache() {
+        assumeTrue(libraryLoaded, "Native library not available");
+
+        int count = BaslerJNI.refreshDevices();
+        assertTrue(count >= 0, "Refresh should succeed");
+
+        BaslerJNI.DeviceInfo[] devices = BaslerJNI.getDevices();
+        assertEquals(count, devices.length, "Bulk info should match the refreshed cache");
+
+        for (BaslerJNI.DeviceInfo device : devices) {
+            assertFalse(device.serial().isEmpty(), "Serial should not be empty");
+            assertEquals(
+                    device.model(),
+                    BaslerJNI.getCameraModelRaw(device.serial()),
+                    "Model lookup should match bulk info");
+        }
+
+        assertTrue(BaslerJNI.setDeviceWatcher(500), "Should start watcher");
+        assertNotNull(BaslerJNI.getConnectedCameras(), "Should list cameras while watching");
+        assertTrue(BaslerJNI.setDeviceWatcher(0), "Should stop watcher");
+    }
+
+    @Test
+    @DisplayName("Should open all cameras in parallel and record open time")
+    void testCreateCameras() {
+        assumeTrue(libraryLoaded, "Native library not available");
+        assumeTrue(hasCameras, "No cameras connected");
+
+        long[] handles = BaslerJNI.createCameras(connectedCameras);
+        assertNotNull(handles, "Handle array should not be null");
+        assertEquals(connectedCameras.length, handles.length, "Should return one handle per serial");
+
+        try {
+            for (long handle : handles) {
+                assertNotEquals(0, handle, "Camera handle should not be 0");
+
+                double[] stats = BaslerJNI.getCameraStats(handle);
+                assertNotNull(stats, "Stats should not be null");
+                System.out.println("Open time: " + stats[BaslerJNI.STAT_OPEN_TIME_MS] + " ms");
+                assertTrue(stats[BaslerJNI.STAT_OPEN_TIME_MS] > 0, "Open time should be recorded");
+            }
+        } finally {
+            for (long handle : handles) {
+                if (handle != 0) BaslerJNI.destroyCamera(handle);
+            }
+        }
+    }
+
+    @Test
+    @DisplayName("Should save and restore settings profiles")
+    void testProfiles() {
+        assumeTrue(libraryLoaded, "Native library not available");
+        assumeTrue(hasCameras, "No cameras connected");
+
+        String serial = connectedCameras[0];
+        long handle = BaslerJNI.createCamera(serial);
+        assumeTrue(handle != 0, "Failed to create camera");
+
+        try {
+            assertTrue(BaslerJNI.setExposure(handle, 5000), "Should set exposure");
+            assertTrue(
+                    BaslerJNI.saveProfile(handle, "/tmp/basler_profile.bin", false),
+                    "Should save compact profile");
+            assertTrue(
+                    BaslerJNI.saveProfile(handle, "/tmp/basler_profile.pfs", true),
+                    "Should save full profile");
+
+            assertTrue(BaslerJNI.setExposure(handle, 20000), "Should change exposure");
+            assertTrue(BaslerJNI.startCamera(handle), "Should start camera");
+
+            assertTrue(
+                    BaslerJNI.loadProfile(handle, "/tmp/basler_profile.bin"),
+                    "Should load compact profile");
+            assertEquals(5000, BaslerJNI.getExposure(handle), 100, "Exposure should be restored");
+
+            assertTrue(
+                    BaslerJNI.loadProfile(handle, "/tmp/basler_profile.pfs"),
+                    "Should load full profile");
+            assertEquals(5000, BaslerJNI.getExposure(handle), 100, "Exposure should be restored");
+        } finally {
+            BaslerJNI.destroyCamera(handle);
+        }
+    }
+
+    @Test
+    @DisplayName("Should report connection state")
+    void testConnectionState() {
+        assumeTrue(libraryLoaded, "Native library not available");
+        assertEquals(-1, BaslerJNI.getConnectionState(0), "Invalid handle should report -1");
+
+        assumeTrue(hasCameras, "No cameras connected");
+
+        String serial = connectedCameras[0];
+        long handle = BaslerJNI.createCamera(serial);
+        assumeTrue(handle != 0, "Failed to create camera");
+
+        try {
+            assertEquals(
+                    BaslerJNI.CONNECTION_CONNECTED,
+                    BaslerJNI.getConnectionState(handle),
+                    "Fresh camera should be connected");
+
+            double[] stats = BaslerJNI.getCameraStats(handle);
+            assertEquals(0, stats[BaslerJNI.STAT_DISCONNECTS], "Should not have disconnected");
+        } finally {
+            BaslerJNI.destroyCamera(handle);
+        }
+    }
+
+    @Test
+    @DisplayName("Should report frame wait status codes")
+    void testFrameStatus() {
+        assumeTrue(libraryLoaded, "Native library not available");
+        assertEquals(
+                BaslerJNI.FRAME_DISCONNECTED,
+                BaslerJNI.awaitNewFrame(0, 10),
+                "Invalid handle should report disconnected");
+
+        assumeTrue(hasCameras, "No cameras connected");
+
+        String serial = connectedCameras[0];
+        long handle = BaslerJNI.createCamera(serial);
+        assumeTrue(handle != 0, "Failed to create camera");
+
+        try {
+            assertEquals(
+                    BaslerJNI.FRAME_NOT_GRABBING,
+                    BaslerJNI.awaitNewFrame(handle, 10),
+                    "Should report not grabbing before start");
+
+            assertTrue(BaslerJNI.startCamera(handle), "Should start camera");
+            assertEquals(
+                    BaslerJNI.FRAME_NEW, BaslerJNI.awaitNewFrame(handle, 2000), "Should get frame");
+
+            long sequence = BaslerJNI.getFrameSequence(handle);
+            assertTrue(sequence > 0, "Sequence should advance");
+
+            int status = BaslerJNI.pollFrame(handle, sequence);
+            assertTrue(
+                    status == BaslerJNI.FRAME_NEW || status == BaslerJNI.FRAME_TIMEOUT,
+                    "Poll should not fail");
+            assertEquals(
+                    BaslerJNI.FRAME_NEW,
+                    BaslerJNI.pollFrame(handle, sequence - 1),
+                    "Older sequence should report a new frame");
+        } finally {
+            BaslerJNI.destroyCamera(handle);
+        }
+    }
+
+    @Test
+    @DisplayName("Should tune the GigE stream and share bandwidth")
+    void testGigETransport() {
+        assumeTrue(libraryLoaded, "Native library not available");
+        assumeTrue(hasCameras, "No cameras connected");
+
+        BaslerJNI.DeviceInfo gige = null;
+        for (BaslerJNI.DeviceInfo device : BaslerJNI.getDevices()) {
+            if (device.deviceClass().equals("BaslerGigE")) {
+                gige = device;
+                break;
+            }
+        }
+        assumeTrue(gige != null, "No GigE cameras connected");
+
+        long handle = BaslerJNI.createCamera(gige.serial());
+        assumeTrue(handle != 0, "Failed to create camera");
+
+        try {
+            assertTrue(
+                    BaslerJNI.configureGigETransport(handle, 0, -1, true, 100, 2048),
+                    "Should configure transport");
+            assertTrue(BaslerJNI.startCamera(handle), "Should start camera");
+            assertEquals(BaslerJNI.FRAME_NEW, BaslerJNI.awaitNewFrame(handle, 2000));
+
+            double[] stats = BaslerJNI.getCameraStats(handle);
+            assertTrue(stats.length > BaslerJNI.STAT_TOTAL_BUFFERS, "Should expose stream stats");
+            assertTrue(stats[BaslerJNI.STAT_TOTAL_BUFFERS] >= 1, "Should count buffers");
+        } finally {
+            BaslerJNI.destroyCamera(handle);
+        }
+    }
+
+    @Test
+    @DisplayName("Should tune the USB transport")
+    void testUsbTransport() {
+        assumeTrue(libraryLoaded, "Native library not available");
+        assumeTrue(hasCameras, "No cameras connected");
+
+        BaslerJNI.DeviceInfo usb = null;
+        for (BaslerJNI.DeviceInfo device : BaslerJNI.getDevices()) {
+            if (device.deviceClass().equals("BaslerUsb")) {
+                usb = device;
+                break;
+            }
+        }
+        assumeTrue(usb != null, "No USB cameras connected");
+
+        long handle = BaslerJNI.createCamera(usb.serial());
+        assumeTrue(handle != 0, "Failed to create camera");
+
+        try {
+            assertTrue(
+                    BaslerJNI.configureUsbTransport(handle, 262144, 64, -1, 16, 0, -1),
+                    "Should configure transport");
+            assertTrue(BaslerJNI.startCamera(handle), "Should start camera");
+            for (int i = 0; i < 10; i++) {
+                assertEquals(BaslerJNI.FRAME_NEW, BaslerJNI.awaitNewFrame(handle, 2000));
+            }
+
+            double[] stats = BaslerJNI.getCameraStats(handle);
+            assertTrue(stats.length > BaslerJNI.STAT_BLOCK_ID_GAPS, "Should expose drop stats");
+            assertTrue(stats[BaslerJNI.STAT_TOTAL_BUFFERS] >= 10, "Should count buffers");
+            assertTrue(stats[BaslerJNI.STAT_FRAMES_SKIPPED] >= 0);
+            assertTrue(stats[BaslerJNI.STAT_BLOCK_ID_GAPS] >= 0);
+        } finally {
+            BaslerJNI.destroyCamera(handle);
+        }
+    }
+
+    @Test
+    @DisplayName("Should read the camera state in one call")
+    void testCameraState() {
+        assumeTrue(libraryLoaded, "Native library not available");
+        assumeTrue(hasCameras, "No cameras connected");
+
+        String serial = connectedCameras[0];
+        long handle = BaslerJNI.createCamera(serial);
+        assumeTrue(handle != 0, "Failed to create camera");
+
+        try {
+            double[] state = new double[BaslerJNI.STATE_COUNT];
+            assertFalse(
+                    BaslerJNI.getCameraState(handle, new double[1]), "Should reject short array");
+            assertTrue(BaslerJNI.getCameraState(handle, state), "Should fill state");
+
+            assertEquals(BaslerJNI.getExposure(handle), state[BaslerJNI.STATE_EXPOSURE], 1.0);
+            assertEquals(BaslerJNI.getMinGain(handle), state[BaslerJNI.STATE_MIN_GAIN], 1e-6);
+            assertEquals(BaslerJNI.getMaxGain(handle), state[BaslerJNI.STATE_MAX_GAIN], 1e-6);
+            assertEquals(
+                    BaslerJNI.getMaxWhiteBalance(handle),
+                    state[BaslerJNI.STATE_MAX_WHITE_BALANCE],
+                    1e-6);
+            assertEquals(
+                    BaslerJNI.getPixelFormat(handle), (int) state[BaslerJNI.STATE_PIXEL_FORMAT]);
+            assertTrue(
+                    state[BaslerJNI.STATE_MIN_EXPOSURE] <= state[BaslerJNI.STATE_MAX_EXPOSURE]);
+        } finally {
+            BaslerJNI.destroyCamera(handle);
+        }
+    }
+
+    @Test
+    @DisplayName("Should keep and dump a ring of recent frames")
+    void testFrameHistory() throws java.io.IOException {
+        assumeTrue(libraryLoaded, "Native library not available");
+        assumeTrue(hasCameras, "No cameras connected");
+
+        String serial = connectedCameras[0];
+        long handle = BaslerJNI.createCamera(serial);
+        assumeTrue(handle != 0, "Failed to create camera");
+
+        java.nio.file.Path dir = java.nio.file.Files.createTempDirectory("basler-history");
+        try {
+            assertTrue(BaslerJNI.setFrameHistory(handle, 8, false), "Should allocate ring");
+            assertTrue(BaslerJNI.startCamera(handle), "Should start camera");
+            for (int i = 0; i < 12; i++) {
+                assertEquals(BaslerJNI.FRAME_NEW, BaslerJNI.awaitNewFrame(handle, 2000));
+            }
+
+            long[] range = BaslerJNI.getFrameHistoryRange(handle);
+            assertEquals(7, range[1] - range[0], "Ring should hold 8 frames");
+            assertEquals(0, BaslerJNI.takeFrameAt(handle, range[0] - 1), "Old frame is gone");
+
+            long matPtr = BaslerJNI.takeFrameAt(handle, range[0]);
+            assertNotEquals(0, matPtr, "Should read oldest frame");
+            Mat mat = new Mat(matPtr);
+            assertFalse(mat.empty(), "Frame should not be empty");
+            mat.release();
+
+            assertEquals(3, BaslerJNI.dumpRecentFrames(handle, dir.toString(), 3));
+        } finally {
+            BaslerJNI.destroyCamera(handle);
+        }
+    }
+
+    @Test
+    @DisplayName("Should copy only the requested frame regions")
+    void testFrameRegions() {
+        assumeTrue(libraryLoaded, "Native library not available");
+        assumeTrue(hasCameras, "No cameras connected");
+
+        String serial = connectedCameras[0];
+        long handle = BaslerJNI.createCamera(serial);
+        assumeTrue(handle != 0, "Failed to create camera");
+
+        try {
+            assertTrue(BaslerJNI.startCamera(handle), "Should start camera");
+            assertEquals(BaslerJNI.FRAME_NEW, BaslerJNI.awaitNewFrame(handle, 2000));
+
+            int[] rects = {0, 0, 32, 16, 10, 20, 8, 8, -4, -4, 8, 8};
+            int[] layout = new int[3 * BaslerJNI.REGION_LAYOUT_INTS];
+            java.nio.ByteBuffer small = java.nio.ByteBuffer.allocateDirect(16);
+            long needed = BaslerJNI.takeFrameRegions(handle, rects, small, layout);
+            assertTrue(needed < 0, "Should report required size for a small buffer");
+            assertNotEquals(BaslerJNI.REGION_ERROR, needed);
+            assertEquals(
+                    BaslerJNI.REGION_ERROR,
+                    BaslerJNI.takeFrameRegions(handle, new int[] {0, 0, 1}, small, layout));
+
+            java.nio.ByteBuffer buffer = java.nio.ByteBuffer.allocateDirect((int) -needed);
+            assertEquals(-needed, BaslerJNI.takeFrameRegions(handle, rects, buffer, layout));
+
+            int channels = layout[4];
+            assertEquals(32, layout[2]);
+            assertEquals(32 * channels, layout[1]);
+            assertEquals(32 * 16 * channels, layout[BaslerJNI.REGION_LAYOUT_INTS]);
+            // The third rectangle is clipped to the frame corner.
+            assertEquals(4, layout[2 * BaslerJNI.REGION_LAYOUT_INTS + 2]);
+            assertEquals(4, layout[2 * BaslerJNI.REGION_LAYOUT_INTS + 3]);
+        } finally {
+            BaslerJNI.destroyCamera(handle);
+        }
+    }
+
+    @Test
+    @DisplayName("Should configure auto functions and converge once")
+    void testAutoFunctions() throws InterruptedException {
+        assumeTrue(libraryLoaded, "Native library not available");
+        assumeTrue(hasCameras, "No cameras connected");
+
+        String serial = connectedCameras[0];
+        long handle = BaslerJNI.createCamera(serial);
+        assumeTrue(handle != 0, "Failed to create camera");
+
+        try {
+            assertTrue(BaslerJNI.setFrameRate(handle, 100), "Should set frame rate");
+            assertTrue(
+                    BaslerJNI.configureAutoFunctions(
+                            handle,
+                            null,
+                            new double[] {-1, -1, -1, -1, 0.3},
+                            true,
+                            BaslerJNI.AUTO_PROFILE_MINIMIZE_EXPOSURE,
+                            false),
+                    "Should configure auto functions");
+
+            assertTrue(BaslerJNI.startCamera(handle), "Should start camera");
+            assertTrue(BaslerJNI.triggerAutoExposureOnce(handle), "Should start convergence");
+
+            long deadline = System.currentTimeMillis() + 5000;
+            while (BaslerJNI.getAutoExposureState(handle) == BaslerJNI.AUTO_EXPOSURE_CONVERGING
+                    && System.currentTimeMillis() < deadline) {
+                BaslerJNI.awaitNewFrame(handle, 100);
+            }
+            assertEquals(
+                    BaslerJNI.AUTO_EXPOSURE_OFF,
+                    BaslerJNI.getAutoExposureState(handle),
+                    "Auto exposure should settle");
+            assertTrue(
+                    BaslerJNI.getExposure(handle) <= 1e6 / 100,
+                    "Exposure should not limit the frame rate");
+        } finally {
+            BaslerJNI.destroyCamera(handle);
+        }
+    }
+
+    @Test
+    @DisplayName("Should run host-side auto exposure")
+    void testSoftwareAutoExposure() {
+        assumeTrue(libraryLoaded, "Native library not available");
+        assumeTrue(hasCameras, "No cameras connected");
+
+        String serial = connectedCameras[0];
+        long handle = BaslerJNI.createCamera(serial);
+        assumeTrue(handle != 0, "Failed to create camera");
+
+        try {
+            assertTrue(
+                    BaslerJNI.configureSoftwareAutoExposure(
+                            handle, BaslerJNI.SOFTWARE_AE_CONTROL, null, null, 4),
+                    "Should enable software auto exposure");
+            assertTrue(BaslerJNI.startCamera(handle), "Should start camera");
+            for (int i = 0; i < 30; i++) {
+                assertEquals(BaslerJNI.FRAME_NEW, BaslerJNI.awaitNewFrame(handle, 2000));
+            }
+
+            int[] histogram = BaslerJNI.getLumaHistogram(handle);
+            assertEquals(256, histogram.length);
+            long samples = 0;
+            for (int count : histogram) {
+                samples += count;
+            }
+            assertTrue(samples > 0, "Histogram should have samples");
+            assertFalse(BaslerJNI.getAutoExposure(handle), "Camera auto exposure should be off");
+
+            assertTrue(
+                    BaslerJNI.configureSoftwareAutoExposure(
+                            handle, BaslerJNI.SOFTWARE_AE_OFF, null, null, 4),
+                    "Should disable software auto exposure");
+        } finally {
+            BaslerJNI.destroyCamera(handle);
+        }
+    }
+
+    @Test
+    @DisplayName("Should report per-frame chunk metadata")
+    void testChunkMetadata() {
+        assumeTrue(libraryLoaded, "Native library not available");
+        assumeTrue(hasCameras, "No cameras connected");
+
+        String serial = connectedCameras[0];
+        long handle = BaslerJNI.createCamera(serial);
+        assumeTrue(handle != 0, "Failed to create camera");
+
+        try {
+            assumeTrue(BaslerJNI.setChunkMetadata(handle, true), "Camera has no chunk mode");
+            assertTrue(BaslerJNI.setExposure(handle, 5000), "Should set exposure");
+            assertTrue(BaslerJNI.startCamera(handle), "Should start camera");
+            assertEquals(BaslerJNI.FRAME_NEW, BaslerJNI.awaitNewFrame(handle, 2000));
+            assertEquals(BaslerJNI.FRAME_NEW, BaslerJNI.awaitNewFrame(handle, 2000));
+
+            long[] ints = new long[BaslerJNI.FrameMetadata.RAW_INTS];
+            double[] floats = new double[BaslerJNI.FrameMetadata.RAW_FLOATS];
+            long matPtr = BaslerJNI.takeFrameWithMetadata(handle, ints, floats);
+            assertNotEquals(0, matPtr, "Should take frame");
+            new Mat(matPtr).release();
+
+            BaslerJNI.FrameMetadata metadata = BaslerJNI.FrameMetadata.fromRaw(ints, floats);
+            assertTrue(metadata.sequence() > 0);
+            assertTrue((metadata.fields() & BaslerJNI.META_EXPOSURE) != 0, "Should have exposure");
+            assertEquals(5000, metadata.exposureUs(), 50);
+
+            assertEquals(
+                    metadata,
+                    BaslerJNI.getFrameMetadata(handle, metadata.sequence()),
+                    "Lookup by sequence should match");
+        } finally {
+            BaslerJNI.destroyCamera(handle);
+        }
+    }
+
+    @Test
+    @DisplayName("Should undistort frames on the native side")
+    void testUndistortion() {
+        assumeTrue(libraryLoaded, "Native library not available");
+        assumeTrue(hasCameras, "No cameras connected");
+
+        String serial = connectedCameras[0];
+        long handle = BaslerJNI.createCamera(serial);
+        assumeTrue(handle != 0, "Failed to create camera");
+
+        try {
+            assertTrue(BaslerJNI.startCamera(handle), "Should start camera");
+            assertEquals(BaslerJNI.FRAME_NEW, BaslerJNI.awaitNewFrame(handle, 2000));
+            Mat plain = new Mat(BaslerJNI.takeFrame(handle));
+            int width = plain.cols();
+            int height = plain.rows();
+
+            double[] cameraMatrix = {width, 0, width / 2.0, 0, width, height / 2.0, 0, 0, 1};
+            double[] distCoeffs = {-0.2, 0.05, 0, 0, 0};
+            assertFalse(
+                    BaslerJNI.setUndistortion(handle, cameraMatrix, distCoeffs, width + 2, height),
+                    "Should reject a calibration for another resolution");
+            assertTrue(
+                    BaslerJNI.setUndistortion(handle, cameraMatrix, distCoeffs, width, height),
+                    "Should enable undistortion");
+
+            assertEquals(BaslerJNI.FRAME_NEW, BaslerJNI.awaitNewFrame(handle, 2000));
+            Mat undistorted = new Mat(BaslerJNI.takeFrame(handle));
+            assertEquals(plain.size(), undistorted.size());
+            assertEquals(plain.type(), undistorted.type());
+
+            assertTrue(BaslerJNI.setUndistortion(handle, null, null, 0, 0), "Should disable");
+            plain.release();
+            undistorted.release();
+        } finally {
+            BaslerJNI.destroyCamera(handle);
+        }
+    }
+
+    @Test
+    @DisplayName("Should produce a threshold mask with each frame")
+    void testThresholdMask() {
+        assumeTrue(libraryLoaded, "Native library not available");
+        assumeTrue(hasCameras, "No cameras connected");
+
+        String serial = connectedCameras[0];
+        long handle = BaslerJNI.createCamera(serial);
+        assumeTrue(handle != 0, "Failed to create camera");
+
+        try {
+            // Accept every pixel so the mask content is predictable.
+            int[] config = {0, 180, 0, 255, 0, 255, 2, BaslerJNI.MORPH_OPEN, 3};
+            assertTrue(BaslerJNI.setThreshold(handle, config), "Should enable threshold");
+            assertTrue(BaslerJNI.startCamera(handle), "Should start camera");
+            assertEquals(BaslerJNI.FRAME_NEW, BaslerJNI.awaitNewFrame(handle, 2000));
+
+            Mat frame = new Mat(BaslerJNI.takeFrame(handle));
+            Mat mask = new Mat(BaslerJNI.takeMask(handle));
+            assertEquals(frame.cols() / 2, mask.cols(), "Mask should be downsampled");
+            assertEquals(frame.rows() / 2, mask.rows(), "Mask should be downsampled");
+            assertEquals(mask.total(), Core.countNonZero(mask), "Full range should pass all");
+
+            java.nio.ByteBuffer buffer = java.nio.ByteBuffer.allocateDirect((int) mask.total());
+            assertEquals(mask.total(), BaslerJNI.takeMaskInto(handle, buffer));
+
+            frame.release();
+            mask.release();
+            assertTrue(BaslerJNI.setThreshold(handle, null), "Should disable threshold");
+        } finally {
+            BaslerJNI.destroyCamera(handle);
+        }
+    }
+
+    @Test
+    @DisplayName("Should detect AprilTags on a worker thread")
+    void testTagDetection() throws InterruptedException {
+        assumeTrue(libraryLoaded, "Native library not available");
+        assumeTrue(hasCameras, "No cameras connected");
+
+        String serial = connectedCameras[0];
+        long handle = BaslerJNI.createCamera(serial);
+        assumeTrue(handle != 0, "Failed to create camera");
+
+        try {
+            assertTrue(
+                    BaslerJNI.configureTagDetection(handle, BaslerJNI.TAG_FAMILY_36H11, 2, 0.0),
+                    "Should enable tag detection");
+            assertTrue(BaslerJNI.startCamera(handle), "Should start camera");
+
+            BaslerJNI.TagDetections result = null;
+            for (int i = 0; i < 20 && result == null; i++) {
+                assertEquals(BaslerJNI.FRAME_NEW, BaslerJNI.awaitNewFrame(handle, 2000));
+                Thread.sleep(20);
+                result = BaslerJNI.getTagDetections(handle);
+            }
+            assertNotNull(result, "Detector should publish a result");
+            assertTrue(result.sequence() > 0, "Result should carry the frame sequence");
+            assertTrue(result.latencyNs() >= 0, "Latency should be measured");
+            for (BaslerJNI.TagDetection tag : result.tags()) {
+                assertEquals(8, tag.corners().length);
+            }
+
+            assertTrue(BaslerJNI.configureTagDetection(handle, -1, 0, 0.0), "Should disable");
+            assertNull(BaslerJNI.getTagDetections(handle), "No result after disabling");
+        } finally {
+            BaslerJNI.destroyCamera(handle);
+        }
+    }
+
+    @Test
+    @DisplayName("Should score frame changes and suppress static frames")
+    void testChangeDetection() {
+        assumeTrue(libraryLoaded, "Native library not available");
+        assumeTrue(hasCameras, "No cameras connected");
+
+        String serial = connectedCameras[0];
+        long handle = BaslerJNI.createCamera(serial);
+        assumeTrue(handle != 0, "Failed to create camera");
+
+        try {
+            assertTrue(
+                    BaslerJNI.configureChangeDetection(handle, 8, -1.0, 0),
+                    "Should enable scoring");
+            assertTrue(BaslerJNI.startCamera(handle), "Should start camera");
+
+            BaslerJNI.FrameMetadata metadata = null;
+            for (int i = 0; i < 3; i++) {
+                assertEquals(BaslerJNI.FRAME_NEW, BaslerJNI.awaitNewFrame(handle, 2000));
+                metadata =
+                        BaslerJNI.getFrameMetadata(handle, BaslerJNI.getFrameSequence(handle));
+            }
+            assertNotNull(metadata);
+            assertNotEquals(0, metadata.fields() & BaslerJNI.META_CHANGE_SCORE);
+            assertTrue(metadata.changeScore() >= 0 && metadata.changeScore() <= 255);
+
+            // An impossible threshold drops everything but the heartbeat frames.
+            assertTrue(BaslerJNI.configureChangeDetection(handle, 8, 256.0, 5));
+            for (int i = 0; i < 3; i++) {
+                assertEquals(BaslerJNI.FRAME_NEW, BaslerJNI.awaitNewFrame(handle, 2000));
+            }
+            double[] stats = BaslerJNI.getCameraStats(handle);
+            assertTrue(stats[BaslerJNI.STAT_FRAMES_SUPPRESSED] >= 10, "Should count drops");
+
+            assertTrue(BaslerJNI.configureChangeDetection(handle, 0, -1.0, 0), "Should disable");
+        } finally {
+            BaslerJNI.destroyCamera(handle);
+        }
+    }
+
+    @Test
+    @DisplayName("Should bracket exposures and fuse pairs")
+    void testExposureBracketing() {
+        assumeTrue(libraryLoaded, "Native library not available");
+        assumeTrue(hasCameras, "No cameras connected");
+
+        String serial = connectedCameras[0];
+        long handle = BaslerJNI.createCamera(serial);
+        assumeTrue(handle != 0, "Failed to create camera");
+
+        try {
+            assertEquals(
+                    -1,
+                    BaslerJNI.configureExposureBracketing(
+                            handle, new double[] {8000, 1000, 4000}, true, true, 200),
+                    "Fusion should reject more than two exposures");
+            double exposureBefore = BaslerJNI.getExposure(handle);
+            int mode =
+                    BaslerJNI.configureExposureBracketing(
+                            handle, new double[] {8000, 1000}, true, true, 200);
+            assumeTrue(mode > 0, "Camera cannot bracket");
+            assertTrue(BaslerJNI.startCamera(handle), "Should start camera");
+
+            boolean[] seen = new boolean[2];
+            for (int i = 0; i < 20; i++) {
+                assertEquals(BaslerJNI.FRAME_NEW, BaslerJNI.awaitNewFrame(handle, 2000));
+                BaslerJNI.FrameMetadata metadata =
+                        BaslerJNI.getFrameMetadata(handle, BaslerJNI.getFrameSequence(handle));
+                if ((metadata.fields() & BaslerJNI.META_BRACKET_INDEX) != 0) {
+                    seen[metadata.bracketIndex()] = true;
+                }
+            }
+            assertTrue(seen[0] && seen[1], "Should see both exposures");
+
+            long fused = BaslerJNI.takeFusedFrame(handle);
+            assertNotEquals(0, fused, "Should fuse a pair");
+            new Mat(fused).release();
+
+            assertEquals(
+                    BaslerJNI.BRACKET_OFF,
+                    BaslerJNI.configureExposureBracketing(handle, null, false, false, 0));
+            assertEquals(
+                    exposureBefore,
+                    BaslerJNI.getExposure(handle),
+                    exposureBefore * 0.01,
+                    "Should restore the exposure");
+        } finally {
+            BaslerJNI.destroyCamera(handle);
+        }
+    }
+
+    @Test
+    @DisplayName("Should measure capture-to-Java latency")
+    void testLatencyHarness() {
+        assumeTrue(libraryLoaded, "Native library not available");
+        assumeTrue(hasCameras, "No cameras connected");
+
+        String serial = connectedCameras[0];
+        long handle = BaslerJNI.createCamera(serial);
+        assumeTrue(handle != 0, "Failed to create camera");
+
+        try {
+            int formatBefore = BaslerJNI.getPixelFormat(handle);
+            LatencyHarness.Report report = LatencyHarness.measure(handle, 30, 2000);
+            assertNotNull(report, "Should enter latency test mode");
+            System.out.print(report);
+            assertEquals(30, report.frames(), "Should receive every requested frame");
+            assertEquals(0, report.mismatched(), "Stamps should match their traces");
+            assertTrue(report.stages()[1].p50Us() >= 0, "Conversion latency should be measured");
+            assertEquals(
+                    formatBefore,
+                    BaslerJNI.getPixelFormat(handle),
+                    "Should restore the pixel format");
+        } finally {
+            BaslerJNI.destroyCamera(handle);
+        }
+    }
+
+    @Test
+    @DisplayName("Should negotiate a pixel format for the link")
+    void testNegotiatePixelFormat() {
+        assumeTrue(libraryLoaded, "Native library not available");
+        assumeTrue(hasCameras, "No cameras connected");
+
+        String serial = connectedCameras[0];
+        long handle = BaslerJNI.createCamera(serial);
+        assumeTrue(handle != 0, "Failed to create camera");
+
+        try {
+            BaslerJNI.PixelFormatChoice choice =
+                    BaslerJNI.negotiatePixelFormat(handle, BaslerJNI.OUTPUT_BGR, true);
+            System.out.println(choice.reasoning());
+            assertTrue(choice.format() >= 0, "Should find a deliverable format");
+            assertFalse(choice.reasoning().isEmpty(), "Should explain the choice");
+            assertEquals(choice.format(), BaslerJNI.getPixelFormat(handle), "Should apply it");
+
+            assertTrue(BaslerJNI.startCamera(handle), "Should start camera");
+            assertEquals(BaslerJNI.FRAME_NEW, BaslerJNI.awaitNewFrame(handle, 2000));
+            Mat frame = new Mat(BaslerJNI.takeFrame(handle));
+            if (choice.format() != PixelFormat.kGray.getValue()) {
+                assertEquals(3, frame.channels(), "Colour formats should arrive as BGR");
+            }
+            frame.release();
+        } finally {
+            BaslerJNI.destroyCamera(handle);
+        }
+    }
+
+    @Test
+    @DisplayName("Should forward rate-limited native logs to Java")
+    void testNativeLogForwarding() {
+        assumeTrue(libraryLoaded, "Native library not available");
+
+        assertFalse(BaslerJNI.configureNativeLog(BaslerJNI.LOG_OFF + 1, 5));
+        assertFalse(BaslerJNI.configureNativeLog(BaslerJNI.LOG_INFO, -1));
+        assertTrue(BaslerJNI.configureNativeLog(BaslerJNI.LOG_INFO, 2));
+
+        List<BaslerJNI.NativeLogRecord> records = Collections.synchronizedList(new ArrayList<>());
+        assertTrue(BaslerJNI.setNativeLogListener(records::add), "Should enable forwarding");
+        try {
+            // Rejected configs log a warning without touching the pool.
+            for (int i = 0; i < 10; i++) {
+                assertFalse(BaslerJNI.configureConversionPool(-1, null, 1));
+            }
+            BaslerJNI.flushNativeLog();
+
+            // Two per second, or four if the loop straddles a window.
+            assertFalse(records.isEmpty(), "Should forward the warning");
+            assertTrue(records.size() <= 4, "Rate limit should drop most of them");
+            BaslerJNI.NativeLogRecord record = records.get(0);
+            assertEquals(BaslerJNI.LOG_WARN, record.level());
+            assertEquals("BaslerJNI::configureConversionPool", record.site());
+            assertTrue(record.message().contains("threads=-1"), record.message());
+        } finally {
+            BaslerJNI.setNativeLogForwarding(false);
+            BaslerJNI.configureNativeLog(BaslerJNI.LOG_INFO, 5);
+        }
+    }
+
     @EnabledIf("runExposureTest")
     @Test
     @DisplayName("Should capture frames at different exposures and save images")
@@ -0,0 +1,154 @@
+#include "conversion_pool.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Counts how often each row was visited and checks stripe alignment.
+struct Coverage {
+  explicit Coverage(int rows, int align = 1) : visits(rows), align(align) {
+    for (auto &visit : visits) {
+      visit = 0;
+    }
+  }
+
+  static void visit(void *ctx, int rowBegin, int rowEnd) {
+    auto *coverage = static_cast<Coverage *>(ctx);
+    if (rowBegin % coverage->align != 0 || rowBegin >= rowEnd) {
+      coverage->misaligned++;
+    }
+    for (int row = rowBegin; row < rowEnd; row++) {
+      coverage->visits[row]++;
+    }
+    coverage->stripes++;
+    std::lock_guard<std::mutex> lock(coverage->mutex);
+    coverage->threads.push_back(std::this_thread::get_id());
+  }
+
+  bool everyRowOnce() const {
+    for (const auto &visit : visits) {
+      if (visit != 1) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  std::vector<std::atomic<int>> visits;
+  int align;
+  std::atomic<int> misaligned{0};
+  std::atomic<int> stripes{0};
+  std::mutex mutex;
+  std::vector<std::thread::id> threads;
+};
+
+void runCoverage(Coverage &coverage, int rowAlign = 2) {
+  StripeJob job;
+  job.fn = Coverage::visit;
+  job.ctx = &coverage;
+  job.rows = static_cast<int>(coverage.visits.size());
+  job.rowAlign = rowAlign;
+  ConversionPool::instance().run(job);
+}
+
+class ConversionPoolTest : public ::testing::Test {
+protected:
+  void TearDown() override {
+    ConversionPool::instance().configure(2, {}, 64);
+  }
+};
+
+TEST_F(ConversionPoolTest, CoversEveryRowOnce) {
+  ConversionPool::instance().configure(3, {}, 1);
+  for (int rows : {1, 2, 3, 7, 64, 479, 1080}) {
+    Coverage coverage(rows);
+    runCoverage(coverage);
+    EXPECT_TRUE(coverage.everyRowOnce()) << rows << " rows";
+  }
+}
+
+TEST_F(ConversionPoolTest, StripesStartOnRowAlignment) {
+  ConversionPool::instance().configure(3, {}, 1);
+  for (int align : {1, 2, 4, 8}) {
+    Coverage coverage(203, align);
+    runCoverage(coverage, align);
+    EXPECT_TRUE(coverage.everyRowOnce()) << "align " << align;
+    EXPECT_EQ(coverage.misaligned.load(), 0) << "align " << align;
+  }
+}
+
+TEST_F(ConversionPoolTest, ZeroWorkersRunsOnCaller) {
+  ConversionPool::instance().configure(0, {}, 1);
+  EXPECT_EQ(ConversionPool::instance().threadCount(), 0);
+
+  Coverage coverage(480);
+  runCoverage(coverage);
+  EXPECT_TRUE(coverage.everyRowOnce());
+  EXPECT_EQ(coverage.stripes.load(), 1);
+  EXPECT_EQ(coverage.threads.front(), std::this_thread::get_id());
+}
+
+TEST_F(ConversionPoolTest, SmallJobsStayWhole) {
+  ConversionPool::instance().configure(3, {}, 64);
+  Coverage coverage(100);
+  runCoverage(coverage);
+  EXPECT_TRUE(coverage.everyRowOnce());
+  // Stripes never go below minStripeRows.
+  EXPECT_LE(coverage.stripes.load(), 2);
+}
+
+TEST_F(ConversionPoolTest, ConcurrentSubmitters) {
+  ConversionPool::instance().configure(3, {}, 1);
+  constexpr int kSubmitters = 6;
+  constexpr int kJobs = 200;
+  std::atomic<int> failures{0};
+
+  std::vector<std::thread> submitters;
+  for (int s = 0; s < kSubmitters; s++) {
+    submitters.emplace_back([s, &failures] {
+      for (int i = 0; i < kJobs; i++) {
+        Coverage coverage(16 + (s * 37 + i) % 300);
+        runCoverage(coverage);
+        if (!coverage.everyRowOnce()) {
+          failures++;
+        }
+      }
+    });
+  }
+  for (auto &submitter : submitters) {
+    submitter.join();
+  }
+  EXPECT_EQ(failures.load(), 0);
+}
+
+TEST_F(ConversionPoolTest, ResizeWhileJobsRun) {
+  std::atomic<bool> done{false};
+  std::atomic<int> failures{0};
+  std::thread submitter([&] {
+    while (!done.load()) {
+      Coverage coverage(257);
+      runCoverage(coverage);
+      if (!coverage.everyRowOnce()) {
+        failures++;
+      }
+    }
+  });
+
+  for (int i = 0; i < 50; i++) {
+    ConversionPool::instance().configure(i % 4, {}, 1 + i % 8);
+  }
+  ConversionPool::instance().shutdown();
+  // The next run restarts the pool with the last configuration.
+  Coverage coverage(64);
+  runCoverage(coverage);
+  EXPECT_TRUE(coverage.everyRowOnce());
+
+  done = true;
+  submitter.join();
+  EXPECT_EQ(failures.load(), 0);
+}
+
+} // namespace
@@ -0,0 +1,267 @@
+#include "camera_stats.hpp"
+#include "change_detector.hpp"
+#include "exposure_fusion.hpp"
+#include "format_negotiation.hpp"
+#include "handle_registry.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+TEST(CameraStats, SnapshotReportsCountersAndUnknownTransport) {
+  CameraStats stats;
+  stats.openTimeMs = 12.5;
+  stats.framesGrabbed = 100;
+  stats.framesSkipped = 3;
+  stats.framesSuppressed = 7;
+
+  auto values = stats.snapshot();
+  EXPECT_EQ(values[kStatOpenTimeMs], 12.5);
+  EXPECT_EQ(values[kStatFramesGrabbed], 100.0);
+  EXPECT_EQ(values[kStatFramesSkipped], 3.0);
+  EXPECT_EQ(values[kStatFramesSuppressed], 7.0);
+  for (int i = kStatResendRequests; i <= kStatResyncs; i++) {
+    EXPECT_EQ(values[i], -1.0) << "stat " << i;
+  }
+}
+
+TEST(HandleRegistry, FindsUntilRemoved) {
+  HandleRegistry<int> registry;
+  auto object = std::make_shared<int>(42);
+  int64_t handle = registry.add(object);
+  EXPECT_EQ(handle, reinterpret_cast<int64_t>(object.get()));
+  EXPECT_EQ(registry.find(handle), object);
+  EXPECT_FALSE(registry.find(handle + 1));
+
+  // Callers that already looked the object up keep it alive.
+  auto held = registry.find(handle);
+  registry.remove(handle);
+  object.reset();
+  EXPECT_FALSE(registry.find(handle));
+  EXPECT_EQ(*held, 42);
+
+  registry.add(std::make_shared<int>(1));
+  registry.clear();
+  EXPECT_FALSE(registry.find(handle));
+}
+
+// Looks up another handle on destruction, which deadlocks if the registry
+// destroys objects while holding its lock.
+struct LookupOnDestroy {
+  LookupOnDestroy(HandleRegistry<LookupOnDestroy> *registry, int64_t other,
+                  bool *found)
+      : registry(registry), other(other), found(found) {}
+  ~LookupOnDestroy() {
+    if (registry) {
+      *found = registry->find(other) != nullptr;
+    }
+  }
+
+  HandleRegistry<LookupOnDestroy> *registry;
+  int64_t other;
+  bool *found;
+};
+
+TEST(HandleRegistry, ReleasesOutsideTheLock) {
+  HandleRegistry<LookupOnDestroy> registry;
+  bool found = false;
+  int64_t kept = registry.add(
+      std::make_shared<LookupOnDestroy>(nullptr, 0, nullptr));
+  int64_t handle = registry.add(
+      std::make_shared<LookupOnDestroy>(&registry, kept, &found));
+
+  registry.remove(handle);
+  EXPECT_TRUE(found);
+  EXPECT_FALSE(registry.find(handle));
+}
+
+TEST(SumAbsDiff, MatchesScalarForEveryTailLength) {
+  std::mt19937 rng(1);
+  std::vector<uint8_t> a(300), b(300);
+  for (size_t i = 0; i < a.size(); i++) {
+    a[i] = static_cast<uint8_t>(rng());
+    b[i] = static_cast<uint8_t>(rng());
+  }
+  // Lengths around the 16-byte vector width exercise the scalar tail.
+  for (size_t n = 0; n <= a.size(); n += 7) {
+    uint64_t expected = 0;
+    for (size_t i = 0; i < n; i++) {
+      expected += std::abs(a[i] - b[i]);
+    }
+    EXPECT_EQ(sumAbsDiff(a.data(), b.data(), n), expected) << n << " bytes";
+  }
+}
+
+TEST(ChangeDetector, ScoresAgainstLastAcceptedFrame) {
+  ChangeDetectorConfig config;
+  config.gridStep = 4;
+  ChangeDetector detector(config);
+  std::vector<uint8_t> frame(64 * 48, 100);
+
+  EXPECT_EQ(detector.measure(frame.data(), 64, 48, 64, 1, 0), -1.0);
+  detector.accept();
+  EXPECT_EQ(detector.measure(frame.data(), 64, 48, 64, 1, 0), 0.0);
+
+  // A slow drift keeps adding up while frames are not accepted.
+  std::fill(frame.begin(), frame.end(), 102);
+  EXPECT_DOUBLE_EQ(detector.measure(frame.data(), 64, 48, 64, 1, 0), 2.0);
+  std::fill(frame.begin(), frame.end(), 104);
+  EXPECT_DOUBLE_EQ(detector.measure(frame.data(), 64, 48, 64, 1, 0), 4.0);
+
+  // A different frame size has nothing to compare against.
+  EXPECT_EQ(detector.measure(frame.data(), 32, 48, 64, 1, 0), -1.0);
+}
+
+TEST(ChangeDetector, ReadsTheLumaByteOfPackedPixels) {
+  ChangeDetectorConfig config;
+  config.gridStep = 2;
+  ChangeDetector detector(config);
+  // UYVY: luma is the odd byte.
+  std::vector<uint8_t> frame(16 * 8 * 2, 50);
+  detector.measure(frame.data(), 16, 8, 32, 2, 1);
+  detector.accept();
+
+  for (size_t i = 0; i < frame.size(); i += 2) {
+    frame[i] = 200; // chroma only
+  }
+  EXPECT_EQ(detector.measure(frame.data(), 16, 8, 32, 2, 1), 0.0);
+}
+
+TEST(ChangeDetector, SuppressesUpToHeartbeat) {
+  ChangeDetectorConfig config;
+  config.suppressBelow = 1.0;
+  config.maxSuppressed = 3;
+  ChangeDetector detector(config);
+
+  EXPECT_FALSE(detector.shouldSuppress(-1.0));
+  EXPECT_FALSE(detector.shouldSuppress(1.0));
+  for (int i = 0; i < 3; i++) {
+    EXPECT_TRUE(detector.shouldSuppress(0.5));
+  }
+  EXPECT_FALSE(detector.shouldSuppress(0.5));
+}
+
+TEST(ExposureFusion, KeepsLongBelowKneeAndShortAtSaturation) {
+  ExposureFusion fusion(1.0, 200);
+  std::vector<uint8_t> shortPixels(40, 60), longPixels(40), out(40);
+  for (size_t i = 0; i < longPixels.size(); i++) {
+    longPixels[i] = i < 20 ? static_cast<uint8_t>(150 + i) : 255;
+  }
+  // 40 bytes cover both the vector body and the scalar tail.
+  fusion.fuseSpan(shortPixels.data(), longPixels.data(), out.data(),
+                  out.size());
+  for (size_t i = 0; i < 20; i++) {
+    EXPECT_EQ(out[i], longPixels[i]) << i;
+  }
+  for (size_t i = 20; i < out.size(); i++) {
+    EXPECT_EQ(out[i], 60) << i;
+  }
+}
+
+TEST(ExposureFusion, BlendIsMonotonicInLongExposure) {
+  ExposureFusion fusion(1.0, 200);
+  std::vector<uint8_t> shortPixels(256, 0), longPixels(256), out(256);
+  for (int i = 0; i < 256; i++) {
+    longPixels[i] = static_cast<uint8_t>(i);
+  }
+  fusion.fuseSpan(shortPixels.data(), longPixels.data(), out.data(), 256);
+  for (int i = 201; i < 256; i++) {
+    EXPECT_LE(out[i], longPixels[i]) << i;
+  }
+  EXPECT_EQ(out[255], 0);
+}
+
+TEST(ExposureFusion, OutputIsMonotonicInRadiance) {
+  // A 4:1 pair of a ramp from black to four times the long exposure's
+  // saturation level.
+  constexpr double kRatio = 4.0;
+  ExposureFusion fusion(kRatio, 200);
+  std::vector<uint8_t> shortPixels(1021), longPixels(1021), out(1021);
+  for (int radiance = 0; radiance <= 1020; radiance++) {
+    longPixels[radiance] = static_cast<uint8_t>(std::min(radiance, 255));
+    shortPixels[radiance] =
+        static_cast<uint8_t>(std::lround(radiance / kRatio));
+  }
+  fusion.fuseSpan(shortPixels.data(), longPixels.data(), out.data(),
+                  out.size());
+  for (int radiance = 0; radiance <= 200; radiance++) {
+    EXPECT_EQ(out[radiance], radiance) << radiance;
+  }
+  for (int radiance = 1; radiance <= 1020; radiance++) {
+    EXPECT_GE(out[radiance], out[radiance - 1]) << radiance;
+  }
+  // Highlights past the long exposure's saturation stay brighter than it.
+  EXPECT_GT(out[600], out[255]);
+  EXPECT_EQ(out[1020], 255);
+}
+
+FormatCandidate candidate(const char *name, int format, double bytesPerPixel,
+                          bool color, double convertNs) {
+  FormatCandidate c;
+  c.name = name;
+  c.libraryFormat = format;
+  c.bytesPerPixel = bytesPerPixel;
+  c.color = color;
+  c.convertNs = convertNs;
+  return c;
+}
+
+NegotiationInput gigeInput(int intent) {
+  NegotiationInput input;
+  input.width = 1920;
+  input.height = 1200;
+  input.linkBytesPerSecond = 110e6;
+  input.sensorMaxFps = 160;
+  input.intent = intent;
+  input.candidates = {
+      candidate("Mono8", 5, 1, false, 0.3e6),
+      candidate("RGB8", 4, 3, true, 1.0e6),
+      candidate("YCbCr422_8", 7, 2, true, 2.0e6),
+      candidate("BayerRG8", 100, 1, true, 3.0e6),
+  };
+  return input;
+}
+
+TEST(FormatNegotiation, LinkBoundColourPicksBayer) {
+  NegotiationResult result = negotiateFormat(gigeInput(kOutputBgr));
+  ASSERT_EQ(result.chosen, 3);
+  EXPECT_NEAR(result.estimatedFps, 110e6 / (1920.0 * 1200), 1e-6);
+  EXPECT_NE(result.reasoning.find("Chose BayerRG8"), std::string::npos);
+  EXPECT_NE(result.reasoning.find("Mono8: skipped"), std::string::npos);
+}
+
+TEST(FormatNegotiation, GrayPrefersMono) {
+  NegotiationResult result = negotiateFormat(gigeInput(kOutputGray));
+  EXPECT_EQ(result.chosen, 0);
+}
+
+TEST(FormatNegotiation, TiesGoToFewerBytesThenCheaperConversion) {
+  NegotiationInput input = gigeInput(kOutputPreview);
+  // A fast link leaves every format sensor-bound.
+  input.linkBytesPerSecond = 0;
+  input.candidates[0].convertNs = 0.5e6;
+  NegotiationResult result = negotiateFormat(input);
+  EXPECT_EQ(result.chosen, 0);
+  EXPECT_DOUBLE_EQ(result.estimatedFps, 160.0);
+
+  input.candidates[0].convertNs = 4e6;
+  result = negotiateFormat(input);
+  EXPECT_EQ(result.chosen, 3);
+}
+
+TEST(FormatNegotiation, FallsBackWhenNothingFitsIntent) {
+  NegotiationInput input = gigeInput(kOutputBgr);
+  input.candidates = {candidate("Mono8", 5, 1, false, 0.3e6)};
+  NegotiationResult result = negotiateFormat(input);
+  EXPECT_EQ(result.chosen, 0);
+  EXPECT_NE(result.reasoning.find("No colour format"), std::string::npos);
+
+  input.candidates.clear();
+  EXPECT_EQ(negotiateFormat(input).chosen, -1);
+}
+
+} // namespace
@@ -0,0 +1,220 @@
+#include "frame_history.hpp"
+#include "frame_mailbox.hpp"
+#include <gtest/gtest.h>
+#include <opencv2/imgproc.hpp>
+#include <atomic>
+#include <thread>
+
+namespace {
+
+FrameMetadata metadataFor(uint64_t sequence) {
+  FrameMetadata metadata;
+  metadata.sequence = sequence;
+  metadata.hostTimestampNs = static_cast<int64_t>(sequence) * 1000;
+  return metadata;
+}
+
+// Every pixel holds the low byte of the sequence, so a torn read shows up.
+cv::Mat frameFor(uint64_t sequence, int rows = 24, int cols = 32,
+                 int type = CV_8UC1) {
+  return cv::Mat(rows, cols, type, cv::Scalar::all(sequence & 0xff));
+}
+
+bool uniform(const cv::Mat &frame, int value) {
+  cv::Mat flat = frame.reshape(1);
+  double low, high;
+  cv::minMaxLoc(flat, &low, &high);
+  return low == value && high == value;
+}
+
+TEST(FrameHistory, ReadsBackPushedFrames) {
+  FrameHistory history(4, 32 * 24);
+  EXPECT_EQ(history.newest(), 0u);
+  EXPECT_EQ(history.oldest(), 0u);
+
+  for (uint64_t sequence = 1; sequence <= 3; sequence++) {
+    ASSERT_TRUE(history.push(metadataFor(sequence), frameFor(sequence), -1));
+  }
+  EXPECT_EQ(history.newest(), 3u);
+  EXPECT_EQ(history.oldest(), 1u);
+
+  cv::Mat out;
+  FrameMetadata metadata;
+  ASSERT_TRUE(history.read(2, out, &metadata));
+  EXPECT_EQ(metadata.sequence, 2u);
+  EXPECT_EQ(metadata.hostTimestampNs, 2000);
+  EXPECT_TRUE(uniform(out, 2));
+  EXPECT_FALSE(history.read(0, out));
+  EXPECT_FALSE(history.read(4, out));
+}
+
+TEST(FrameHistory, OverwritesOldestWhenFull) {
+  FrameHistory history(3, 32 * 24);
+  for (uint64_t sequence = 1; sequence <= 7; sequence++) {
+    ASSERT_TRUE(history.push(metadataFor(sequence), frameFor(sequence), -1));
+  }
+  EXPECT_EQ(history.oldest(), 5u);
+  EXPECT_EQ(history.newest(), 7u);
+
+  cv::Mat out;
+  FrameMetadata metadata;
+  EXPECT_FALSE(history.read(4, out));
+  EXPECT_FALSE(history.readMetadata(1, metadata));
+  ASSERT_TRUE(history.readMetadata(5, metadata));
+  EXPECT_EQ(metadata.sequence, 5u);
+}
+
+TEST(FrameHistory, RejectsFramesLargerThanASlot) {
+  FrameHistory history(2, 32 * 24);
+  EXPECT_FALSE(history.push(metadataFor(1), frameFor(1, 24, 32, CV_8UC3), -1));
+  EXPECT_EQ(history.newest(), 0u);
+  EXPECT_TRUE(history.push(metadataFor(2), frameFor(2, 24, 32), -1));
+}
+
+TEST(FrameHistory, AppliesStoredConversionOnRead) {
+  FrameHistory history(2, 32 * 24 * 3);
+  cv::Mat rgb(24, 32, CV_8UC3, cv::Scalar(10, 20, 30));
+  ASSERT_TRUE(history.push(metadataFor(1), rgb, cv::COLOR_RGB2BGR));
+
+  cv::Mat out;
+  ASSERT_TRUE(history.read(1, out));
+  EXPECT_EQ(out.at<cv::Vec3b>(5, 5), cv::Vec3b(30, 20, 10));
+}
+
+TEST(FrameHistory, StoresNonContinuousFrames) {
+  FrameHistory history(2, 32 * 24);
+  cv::Mat parent = frameFor(9, 40, 64);
+  cv::Mat roi = parent(cv::Rect(8, 8, 32, 24));
+  ASSERT_TRUE(history.push(metadataFor(1), roi, -1));
+
+  cv::Mat out;
+  ASSERT_TRUE(history.read(1, out));
+  EXPECT_EQ(out.size(), roi.size());
+  EXPECT_TRUE(uniform(out, 9));
+}
+
+// The single writer laps a small ring while readers chase it; every read
+// either fails or returns exactly the frame that was asked for.
+TEST(FrameHistory, ConcurrentReadersNeverSeeTornFrames) {
+  FrameHistory history(4, 64 * 48);
+  constexpr uint64_t kFrames = 20000;
+  std::atomic<bool> done{false};
+  std::atomic<int> torn{0};
+  std::atomic<int> hits{0};
+
+  std::vector<std::thread> readers;
+  for (int r = 0; r < 3; r++) {
+    readers.emplace_back([&] {
+      cv::Mat out;
+      FrameMetadata metadata;
+      while (!done.load(std::memory_order_relaxed)) {
+        uint64_t sequence = history.oldest();
+        if (sequence == 0 || !history.read(sequence, out, &metadata)) {
+          continue;
+        }
+        hits++;
+        if (metadata.sequence != sequence ||
+            !uniform(out, static_cast<int>(sequence & 0xff))) {
+          torn++;
+        }
+      }
+    });
+  }
+
+  for (uint64_t sequence = 1; sequence <= kFrames; sequence++) {
+    history.push(metadataFor(sequence), frameFor(sequence, 48, 64), -1);
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(torn.load(), 0);
+  EXPECT_GT(hits.load(), 0);
+}
+
+TEST(FrameMailbox, EmptyBeforeFirstPublish) {
+  FrameMailbox mailbox;
+  FrameMetadata metadata;
+  EXPECT_EQ(mailbox.sequence(), 0u);
+  EXPECT_FALSE(mailbox.frame());
+  EXPECT_FALSE(mailbox.mask());
+  EXPECT_FALSE(mailbox.latest().frame);
+  EXPECT_FALSE(mailbox.metadataFor(0, metadata));
+}
+
+TEST(FrameMailbox, PublishesFrameMaskAndMetadataTogether) {
+  FrameMailbox mailbox;
+  auto frame = std::make_shared<cv::Mat>(frameFor(1));
+  auto mask = std::make_shared<cv::Mat>(frameFor(1, 12, 16));
+  mailbox.publish({frame, mask, metadataFor(1)});
+
+  EXPECT_EQ(mailbox.sequence(), 1u);
+  EXPECT_EQ(mailbox.frame(), frame);
+  EXPECT_EQ(mailbox.mask(), mask);
+
+  FrameMetadata metadata;
+  EXPECT_TRUE(mailbox.metadataFor(1, metadata));
+  EXPECT_EQ(metadata.hostTimestampNs, 1000);
+  EXPECT_FALSE(mailbox.metadataFor(2, metadata));
+
+  // Frames without a mask clear the previous one.
+  mailbox.publish({std::make_shared<cv::Mat>(frameFor(2)), nullptr,
+                   metadataFor(2)});
+  EXPECT_FALSE(mailbox.mask());
+  EXPECT_FALSE(mailbox.metadataFor(1, metadata));
+}
+
+TEST(FrameMailbox, ReadersKeepFramesAlive) {
+  FrameMailbox mailbox;
+  mailbox.publish({std::make_shared<cv::Mat>(frameFor(1)), nullptr,
+                   metadataFor(1)});
+  auto held = mailbox.frame();
+  mailbox.publish({std::make_shared<cv::Mat>(frameFor(2)), nullptr,
+                   metadataFor(2)});
+
+  EXPECT_EQ(held.use_count(), 1);
+  EXPECT_TRUE(uniform(*held, 1));
+}
+
+// Readers must never see a sequence ahead of the frame behind it, or a
+// frame whose metadata belongs to another frame.
+TEST(FrameMailbox, ConcurrentReadersSeeConsistentFrames) {
+  FrameMailbox mailbox;
+  constexpr uint64_t kFrames = 20000;
+  std::atomic<bool> done{false};
+  std::atomic<int> inconsistent{0};
+
+  std::vector<std::thread> readers;
+  for (int r = 0; r < 3; r++) {
+    readers.emplace_back([&] {
+      uint64_t lastSequence = 0;
+      while (!done.load(std::memory_order_relaxed)) {
+        uint64_t announced = mailbox.sequence();
+        PublishedFrame published = mailbox.latest();
+        if (announced == 0) {
+          continue;
+        }
+        uint64_t sequence = published.metadata.sequence;
+        if (!published.frame || sequence < announced ||
+            sequence < lastSequence ||
+            !uniform(*published.frame, static_cast<int>(sequence & 0xff))) {
+          inconsistent++;
+        }
+        lastSequence = sequence;
+      }
+    });
+  }
+
+  for (uint64_t sequence = 1; sequence <= kFrames; sequence++) {
+    mailbox.publish({std::make_shared<cv::Mat>(frameFor(sequence, 8, 8)),
+                     nullptr, metadataFor(sequence)});
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(inconsistent.load(), 0);
+  EXPECT_EQ(mailbox.sequence(), kFrames);
+}
+
+} // namespace
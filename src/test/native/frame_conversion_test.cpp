@@ -0,0 +1,181 @@
+#include "conversion_pool.hpp"
+#include "frame_conversion.hpp"
+#include <gtest/gtest.h>
+#include <opencv2/imgproc.hpp>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct PixelFormatCase {
+  const char *name;
+  int cvType;
+  int colorCvt;
+};
+
+// Every raw layout CameraInstance can hand to convertFrame.
+const PixelFormatCase kPixelFormats[] = {
+    {"Mono8", CV_8UC1, -1},
+    {"BGR8", CV_8UC3, -1},
+    {"RGB8", CV_8UC3, cv::COLOR_RGB2BGR},
+    {"YUV422_YUYV", CV_8UC2, cv::COLOR_YUV2BGR_YUYV},
+    {"YCbCr422_UYVY", CV_8UC2, cv::COLOR_YUV2BGR_UYVY},
+    {"BayerRG8", CV_8UC1, cv::COLOR_BayerBG2BGR},
+    {"BayerBG8", CV_8UC1, cv::COLOR_BayerRG2BGR},
+    {"BayerGR8", CV_8UC1, cv::COLOR_BayerGB2BGR},
+    {"BayerGB8", CV_8UC1, cv::COLOR_BayerGR2BGR},
+};
+
+cv::Mat randomFrame(int rows, int cols, int type, uint64_t seed) {
+  cv::Mat frame(rows, cols, type);
+  cv::RNG rng(seed);
+  rng.fill(frame, cv::RNG::UNIFORM, 0, 256);
+  return frame;
+}
+
+cv::Mat reference(const cv::Mat &raw, int colorCvt) {
+  cv::Mat out;
+  if (colorCvt == -1) {
+    out = raw.clone();
+  } else {
+    cv::cvtColor(raw, out, colorCvt);
+  }
+  return out;
+}
+
+bool identical(const cv::Mat &a, const cv::Mat &b) {
+  return a.size() == b.size() && a.type() == b.type() &&
+         cv::norm(a, b, cv::NORM_INF) == 0;
+}
+
+class FrameConversionTest
+    : public ::testing::TestWithParam<PixelFormatCase> {
+protected:
+  void TearDown() override {
+    ConversionPool::instance().configure(2, {}, 64);
+  }
+};
+
+// Small stripes force many stripe boundaries, which is where demosaicing
+// and 4:2:2 alignment break first.
+TEST_P(FrameConversionTest, StripedMatchesWholeFrame) {
+  const PixelFormatCase &format = GetParam();
+  for (int threads : {0, 1, 3}) {
+    ConversionPool::instance().configure(threads, {}, 2);
+    // Odd row counts leave a short final stripe.
+    for (cv::Size size : {cv::Size(64, 48), cv::Size(96, 38),
+                          cv::Size(640, 482)}) {
+      cv::Mat raw = randomFrame(size.height, size.width, format.cvType,
+                                size.area() + threads);
+      cv::Mat dst(raw.size(), convertedType(format.cvType, format.colorCvt));
+      cv::Mat scratch;
+      convertFrame(raw, format.colorCvt, dst, nullptr, ConversionStages(),
+                   scratch);
+
+      EXPECT_TRUE(identical(dst, reference(raw, format.colorCvt)))
+          << format.name << " " << size << " threads=" << threads;
+    }
+  }
+}
+
+TEST_P(FrameConversionTest, ConvertsFromNonContinuousSource) {
+  const PixelFormatCase &format = GetParam();
+  ConversionPool::instance().configure(2, {}, 4);
+  cv::Mat parent = randomFrame(100, 160, format.cvType, 7);
+  // An even-aligned ROI keeps the Bayer phase and the 4:2:2 pairs intact.
+  cv::Mat raw = parent(cv::Rect(16, 10, 128, 80));
+  ASSERT_FALSE(raw.isContinuous());
+
+  cv::Mat dst(raw.size(), convertedType(format.cvType, format.colorCvt));
+  cv::Mat scratch;
+  convertFrame(raw, format.colorCvt, dst, nullptr, ConversionStages(),
+               scratch);
+  EXPECT_TRUE(identical(dst, reference(raw, format.colorCvt))) << format.name;
+}
+
+TEST_P(FrameConversionTest, ThresholdMaskIndependentOfStriping) {
+  const PixelFormatCase &format = GetParam();
+  ThresholdConfig config;
+  config.hueLow = 20;
+  config.hueHigh = 90;
+  config.satLow = 40;
+  config.valLow = 40;
+  config.downsample = 2;
+  ThresholdStage threshold(config);
+  ConversionStages stages;
+  stages.threshold = &threshold;
+
+  cv::Mat raw = randomFrame(120, 160, format.cvType, 11);
+  std::vector<cv::Mat> masks;
+  for (int threads : {0, 3}) {
+    ConversionPool::instance().configure(threads, {}, 2);
+    cv::Mat dst(raw.size(), convertedType(format.cvType, format.colorCvt));
+    cv::Mat mask(threshold.maskSize(raw.size()), CV_8UC1);
+    cv::Mat scratch;
+    convertFrame(raw, format.colorCvt, dst, &mask, stages, scratch);
+    masks.push_back(mask);
+  }
+  EXPECT_TRUE(identical(masks[0], masks[1])) << format.name;
+}
+
+TEST_P(FrameConversionTest, UndistortWithZeroDistortionIsConversion) {
+  const PixelFormatCase &format = GetParam();
+  ConversionPool::instance().configure(2, {}, 8);
+  FrameGeometry geometry;
+  geometry.width = 160;
+  geometry.height = 120;
+  cv::Mat cameraMatrix =
+      (cv::Mat_<double>(3, 3) << 150, 0, 80, 0, 150, 60, 0, 0, 1);
+  UndistortStage undistort(cameraMatrix, cv::Mat::zeros(1, 5, CV_64F),
+                           geometry);
+  ConversionStages stages;
+  stages.undistort = &undistort;
+  stages.geometry = geometry;
+
+  cv::Mat raw = randomFrame(120, 160, format.cvType, 13);
+  cv::Mat dst(raw.size(), convertedType(format.cvType, format.colorCvt));
+  cv::Mat scratch;
+  convertFrame(raw, format.colorCvt, dst, nullptr, stages, scratch);
+
+  // Identity remap tables may still round by one level.
+  cv::Mat expected = reference(raw, format.colorCvt);
+  EXPECT_LE(cv::norm(dst, expected, cv::NORM_INF), 1.0) << format.name;
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    AllPixelFormats, FrameConversionTest, ::testing::ValuesIn(kPixelFormats),
+    [](const ::testing::TestParamInfo<PixelFormatCase> &info) {
+      return std::string(info.param.name);
+    });
+
+TEST(FrameConversion, ConvertedTypes) {
+  EXPECT_EQ(convertedType(CV_8UC1, -1), CV_8UC1);
+  EXPECT_EQ(convertedType(CV_8UC3, -1), CV_8UC3);
+  EXPECT_EQ(convertedType(CV_8UC2, cv::COLOR_YUV2BGR_YUYV), CV_8UC3);
+  EXPECT_EQ(convertedType(CV_8UC1, cv::COLOR_BayerRG2BGR), CV_8UC3);
+  EXPECT_TRUE(isBayerConversion(cv::COLOR_BayerGR2BGR));
+  EXPECT_FALSE(isBayerConversion(cv::COLOR_RGB2BGR));
+  EXPECT_FALSE(isBayerConversion(-1));
+}
+
+TEST(FrameConversion, FuseFramesMatchesRowKernel) {
+  ConversionPool::instance().configure(3, {}, 2);
+  ExposureFusion fusion(3.0, 180);
+  cv::Mat shortFrame = randomFrame(90, 130, CV_8UC3, 17);
+  cv::Mat longFrame = randomFrame(90, 130, CV_8UC3, 19);
+
+  cv::Mat striped(shortFrame.size(), shortFrame.type());
+  fuseFrames(fusion, shortFrame, longFrame, striped);
+  cv::Mat whole(shortFrame.size(), shortFrame.type());
+  fusion.fuseRows(shortFrame, longFrame, whole, 0, whole.rows);
+
+  EXPECT_TRUE(identical(striped, whole));
+}
+
+TEST(FrameConversion, MeasuresConversionTime) {
+  EXPECT_GT(measureConversionNs(CV_8UC1, cv::COLOR_BayerRG2BGR, 320, 240),
+            0.0);
+  EXPECT_GT(measureConversionNs(CV_8UC1, -1, 320, 240), 0.0);
+}
+
+} // namespace
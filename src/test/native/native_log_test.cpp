@@ -0,0 +1,209 @@
+#include "native_log.hpp"
+#include <gtest/gtest.h>
+#include <iomanip>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Collects everything the log thread delivers.
+class CapturingSink {
+public:
+  CapturingSink() {
+    NativeLog::instance().setSink(
+        [this](const LogRecord *records, size_t count) {
+          std::lock_guard<std::mutex> lock(mutex);
+          captured.insert(captured.end(), records, records + count);
+          batches++;
+        });
+  }
+
+  ~CapturingSink() { NativeLog::instance().setSink(nullptr); }
+
+  std::vector<LogRecord> records() {
+    NativeLog::instance().flush();
+    std::lock_guard<std::mutex> lock(mutex);
+    return captured;
+  }
+
+  int batchCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return batches;
+  }
+
+private:
+  std::mutex mutex;
+  std::vector<LogRecord> captured;
+  int batches = 0;
+};
+
+class NativeLogTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    NativeLog::instance().flush();
+    NativeLog::instance().setLevel(kLogTrace);
+    NativeLog::instance().setRateLimit(0);
+  }
+
+  void TearDown() override {
+    NativeLog::instance().setLevel(kLogInfo);
+    NativeLog::instance().setRateLimit(5);
+  }
+};
+
+TEST_F(NativeLogTest, DeliversFormattedRecords) {
+  CapturingSink sink;
+  BJNI_LOG_WARN("Test::site", "value " << 42 << " of " << 1.5);
+  BJNI_LOG_INFO("Test::other", std::hex << 255);
+  BJNI_LOG_INFO("Test::other", 255);
+
+  auto records = sink.records();
+  ASSERT_EQ(records.size(), 3u);
+  EXPECT_STREQ(records[0].site, "Test::site");
+  EXPECT_STREQ(records[0].message, "value 42 of 1.5");
+  EXPECT_EQ(records[0].level, kLogWarn);
+  EXPECT_GT(records[0].timeNs, 0);
+  EXPECT_STREQ(records[1].message, "ff");
+  // Stream flags do not leak into the next message.
+  EXPECT_STREQ(records[2].message, "255");
+}
+
+TEST_F(NativeLogTest, FiltersByLevel) {
+  CapturingSink sink;
+  NativeLog::instance().setLevel(kLogWarn);
+  int formatted = 0;
+  auto count = [&formatted] { return ++formatted; };
+  BJNI_LOG_DEBUG("Test::level", "hidden " << count());
+  BJNI_LOG_ERROR("Test::level", "shown " << count());
+
+  auto records = sink.records();
+  ASSERT_EQ(records.size(), 1u);
+  EXPECT_STREQ(records[0].message, "shown 1");
+  // Disabled messages are never formatted.
+  EXPECT_EQ(formatted, 1);
+}
+
+TEST_F(NativeLogTest, TruncatesLongMessages) {
+  CapturingSink sink;
+  std::string longText(1000, 'x');
+  BJNI_LOG_INFO(std::string(200, 's').c_str(), longText << " tail");
+
+  auto records = sink.records();
+  ASSERT_EQ(records.size(), 1u);
+  EXPECT_EQ(std::string(records[0].message),
+            longText.substr(0, LogRecord::kMessageBytes - 1));
+  EXPECT_EQ(std::string(records[0].site).size(), LogRecord::kSiteBytes - 1);
+}
+
+TEST_F(NativeLogTest, RateLimitsEachCallSite) {
+  CapturingSink sink;
+  NativeLog::instance().setRateLimit(3);
+  for (int i = 0; i < 10; i++) {
+    BJNI_LOG_WARN("Test::noisy", "frame " << i);
+    BJNI_LOG_WARN("Test::quiet", "frame " << i);
+  }
+
+  auto records = sink.records();
+  int noisy = 0, quiet = 0;
+  for (const auto &record : records) {
+    std::string site = record.site;
+    noisy += site == "Test::noisy";
+    quiet += site == "Test::quiet";
+  }
+  // Separate statements are separate sites, even with the same text.
+  EXPECT_EQ(noisy, 3);
+  EXPECT_EQ(quiet, 3);
+}
+
+TEST_F(NativeLogTest, ReportsSuppressedCountOnNextRecord) {
+  CapturingSink sink;
+  NativeLog::instance().setRateLimit(1);
+  auto logOnce = [] { BJNI_LOG_WARN("Test::window", "tick"); };
+  for (int i = 0; i < 5; i++) {
+    logOnce();
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+  logOnce();
+
+  auto records = sink.records();
+  ASSERT_EQ(records.size(), 2u);
+  EXPECT_EQ(records[0].suppressed, 0u);
+  EXPECT_EQ(records[1].suppressed, 4u);
+}
+
+TEST_F(NativeLogTest, ReportsDropsWhenRingIsFull) {
+  CapturingSink sink;
+  uint64_t droppedBefore = NativeLog::instance().dropped();
+  // Far more than the ring holds, faster than the log thread drains.
+  int accepted = 0;
+  for (int i = 0; i < 20000; i++) {
+    accepted += NativeLog::instance().push(kLogInfo, "Test::flood", "x");
+  }
+
+  auto records = sink.records();
+  uint64_t dropped = NativeLog::instance().dropped() - droppedBefore;
+  ASSERT_GT(dropped, 0u);
+  EXPECT_EQ(accepted + dropped, 20000u);
+
+  uint64_t flood = 0, reported = 0;
+  for (const auto &record : records) {
+    std::string site = record.site;
+    std::string message = record.message;
+    if (site == "Test::flood") {
+      flood++;
+    } else if (site == "NativeLog") {
+      reported += std::stoull(message.substr(message.rfind(' ') + 1));
+    }
+  }
+  EXPECT_EQ(flood, static_cast<uint64_t>(accepted));
+  EXPECT_EQ(reported, dropped);
+}
+
+TEST_F(NativeLogTest, ConcurrentProducersLoseNothingBelowCapacity) {
+  CapturingSink sink;
+  constexpr int kThreads = 4;
+  constexpr int kPerThread = 200;
+  std::vector<std::thread> producers;
+  for (int t = 0; t < kThreads; t++) {
+    producers.emplace_back([t] {
+      for (int i = 0; i < kPerThread; i++) {
+        std::string message = std::to_string(t) + ":" + std::to_string(i);
+        NativeLog::instance().push(kLogInfo, "Test::concurrent",
+                                   message.c_str());
+      }
+    });
+  }
+  for (auto &producer : producers) {
+    producer.join();
+  }
+
+  // Per producer, records arrive complete and in order.
+  std::vector<int> next(kThreads, 0);
+  for (const auto &record : sink.records()) {
+    std::string message = record.message;
+    size_t colon = message.find(':');
+    int t = std::stoi(message.substr(0, colon));
+    EXPECT_EQ(std::stoi(message.substr(colon + 1)), next[t]++);
+  }
+  for (int t = 0; t < kThreads; t++) {
+    EXPECT_EQ(next[t], kPerThread);
+  }
+}
+
+TEST_F(NativeLogTest, ShutdownFlushesAndRestartsOnNextPush) {
+  CapturingSink sink;
+  BJNI_LOG_INFO("Test::shutdown", "before");
+  NativeLog::instance().shutdown();
+  EXPECT_EQ(sink.records().size(), 1u);
+
+  BJNI_LOG_INFO("Test::shutdown", "after");
+  // Left to the restarted log thread rather than flushed here.
+  for (int i = 0; i < 100 && sink.batchCount() < 2; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(sink.batchCount(), 2);
+}
+
+} // namespace